@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# Tests the inspect action end-to-end using a veth pair (requires root and the firewall built with ENABLE_FILTER_INSPECT).
+# A client inside of a network namespace sends a UDP packet containing an inspect pattern to the firewall's end of the veth pair.
+# The packet is redirected to the loader's AF_XDP socket, the pattern callback blocks the client's IP, and the client's pings are then dropped by the XDP program.
+
+XDPFW=${XDPFW:-/usr/bin/xdpfw}
+
+NS=xdpfw-test
+IF_FW=xdpfw-fw
+IF_CLIENT=xdpfw-client
+IP_FW=10.254.254.1
+IP_CLIENT=10.254.254.2
+
+CFG=$(mktemp)
+LOG=$(mktemp)
+
+XDPFW_PID=
+
+cleanup()
+{
+    if [ -n "$XDPFW_PID" ]; then
+        kill -INT $XDPFW_PID 2> /dev/null
+        wait $XDPFW_PID 2> /dev/null
+    fi
+
+    ip link del $IF_FW 2> /dev/null
+    ip netns del $NS 2> /dev/null
+
+    rm -f $CFG $LOG
+}
+
+fail()
+{
+    echo "FAIL: $1"
+
+    cat $LOG
+
+    exit 1
+}
+
+trap cleanup EXIT
+
+ip netns add $NS || exit 1
+ip link add $IF_FW type veth peer name $IF_CLIENT || exit 1
+ip link set $IF_CLIENT netns $NS
+
+ip addr add $IP_FW/24 dev $IF_FW
+ip link set $IF_FW up
+
+ip netns exec $NS ip addr add $IP_CLIENT/24 dev $IF_CLIENT
+ip netns exec $NS ip link set $IF_CLIENT up
+ip netns exec $NS ip link set lo up
+
+cat > $CFG << EOF
+interface = "$IF_FW";
+log_file = "";
+no_stats = true;
+
+inspect_patterns = ( "xdpfw-inspect-test" );
+inspect_block_time = 60;
+
+filters = (
+    {
+        enabled = true,
+        action = 3,
+        udp_enabled = true,
+        udp_dport = 9999
+    }
+);
+EOF
+
+# Veth pairs support native XDP, so the firewall is attached using DRV mode.
+$XDPFW -c $CFG -v 3 > $LOG 2>&1 &
+XDPFW_PID=$!
+
+sleep 3
+
+if ! kill -0 $XDPFW_PID 2> /dev/null; then
+    fail "The firewall exited on startup."
+fi
+
+if ! ip netns exec $NS ping -c 1 -W 1 $IP_FW > /dev/null; then
+    fail "The client can't reach the firewall before sending the inspect pattern."
+fi
+
+ip netns exec $NS bash -c "echo -n 'payload xdpfw-inspect-test payload' > /dev/udp/$IP_FW/9999"
+
+sleep 1
+
+if ip netns exec $NS ping -c 3 -W 1 $IP_FW > /dev/null; then
+    fail "The client wasn't blocked after sending the inspect pattern."
+fi
+
+echo "PASS: The inspected packet's source was blocked."
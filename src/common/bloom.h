@@ -0,0 +1,36 @@
+#pragma once
+
+#include <common/int_types.h>
+#include <common/constants.h>
+#include <common/hash.h>
+
+// The block bloom filter hashes are shared by the XDP program and the loader so both set the same bits (ENABLE_BLOCK_BLOOM).
+
+/**
+ * Retrieves the two base hashes of a block map key.
+ * 
+ * The bit of hash function i is (h1 + (i * h2)) % BLOCK_BLOOM_BITS.
+ * 
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * @param h1 A pointer to store the first hash in.
+ * @param h2 A pointer to store the second hash in.
+ * 
+ * @return void
+ */
+static __always_inline void get_block_bloom_hashes(const u32* key, int ipv6, u32* h1, u32* h2)
+{
+    u32 h = hash_mix32((ipv6 ? BLOCK_BLOOM_SEED6 : BLOCK_BLOOM_SEED) ^ key[0]);
+
+    if (ipv6)
+    {
+        h = hash_mix32(h ^ key[1]);
+        h = hash_mix32(h ^ key[2]);
+        h = hash_mix32(h ^ key[3]);
+    }
+
+    *h1 = h;
+
+    // The second hash must be odd so every hash function sets a different bit.
+    *h2 = hash_mix32(h ^ BLOCK_BLOOM_SEED6) | 1;
+}
\ No newline at end of file
@@ -15,11 +15,78 @@
 // Decrease this value if you receive errors related to the BPF program being too large.
 #define MAX_FILTERS 1000
 
+// Enables the bit-vector filter classifier.
+// Instead of calling process_rule() for every filter rule, the loader precomputes per-field match bitmaps and the XDP program ANDs them together to find the first matching rule in a fixed amount of map lookups.
+// This is recommended when using a large amount of filter rules, but uses more memory (roughly 2 MB with the default MAX_FILTERS value).
+// #define ENABLE_FILTERS_BV
+
+// Enables protocol/destination port indexed filter rule buckets.
+// The loader groups filter rules by protocol and destination port so the XDP program only processes rules that can match the packet's protocol and destination port (in the same order).
+// This is ignored when ENABLE_FILTERS_BV is enabled.
+// #define ENABLE_FILTERS_BUCKETS
+
+// Enables the tuple space search table for exact match filter rules.
+// Filter rules that only match on a single source/destination IP (no CIDR), protocol, source port, and/or destination port are stored inside of a hash map instead of the filters map.
+// The XDP program performs one hash map lookup per distinct combination of fields used by these rules before processing the other filter rules.
+// #define ENABLE_FILTERS_TSS
+
+// The maximum amount of exact match filter rules (ENABLE_FILTERS_TSS).
+// These don't count towards MAX_FILTERS.
+#define MAX_FILTERS_TSS 50000
+
+// Caches the verdict of TCP and UDP flows inside of an LRU map so packets from established flows skip filter rule processing (their rate limit stats are still updated).
+// The loader bumps the cache generation whenever the filter rules are updated which invalidates every cached verdict.
+// Verdicts that depend on rate limits, packet length, TTL, TOS, TCP flags, or a rule with logging enabled aren't cached.
+// #define ENABLE_FILTERS_CACHE
+
+// The maximum amount of flows inside of the verdict cache (ENABLE_FILTERS_CACHE).
+#define MAX_FILTERS_CACHE 100000
+
+// Stores the ports and verdict of the first fragment of fragmented datagrams inside of an LRU map.
+// Later fragments of the same datagram (which don't contain the layer-4 header) then receive the first fragment's verdict instead of being processed by the filter rules and count towards the first fragment's flow.
+// Later fragments whose first fragment wasn't seen (e.g. fragment floods) are still processed by the filter rules and can be dropped with the `fragment` option.
+// #define ENABLE_FRAG_CACHE
+
+// The maximum amount of fragmented datagrams inside of the fragment cache (ENABLE_FRAG_CACHE).
+#define MAX_FRAG_CACHE 65536
+
+// Answers TCP SYNs to the protected destination ports (`syn_proxy_ports` config option) with SYN cookies (a SYN-ACK sent back through XDP_TX).
+// Sources that return a valid cookie are allowed for `syn_proxy_allow_time` seconds and their handshake is reset, so the network stack only receives SYNs from sources that completed a handshake.
+// Requires ENABLE_FILTERS.
+// #define ENABLE_SYN_PROXY
+
+// Uses the kernel's SYN cookies (bpf_tcp_raw_gen_syncookie_ipv4/ipv6() and bpf_tcp_raw_check_syncookie_ipv4/ipv6(), kernel 6.0+) instead of the built-in cookie hash.
+// #define USE_RAW_SYNCOOKIE
+
+// The maximum amount of sources allowed by the SYN proxy (ENABLE_SYN_PROXY).
+#define MAX_SYN_PROXY_ALLOW 100000
+
+// Splits the XDP program into stages (block map, IP range drop map, rate limiting, and filters) that are chained with BPF tail calls.
+// Each stage is verified as its own program which allows larger filter rule sets (MAX_FILTERS) and the loader skips stages that are disabled.
+// This requires a kernel that supports tail calls from XDP programs attached through the XDP dispatcher (freplace).
+// #define ENABLE_TAIL_CALLS
+
 // Feel free to comment this out if you don't want the `blocked` entry on the stats map to be incremented every single time a packet is dropped from the source IP being on the blocked map.
 // Commenting this line out should increase performance when blocking malicious traffic.
+// When defined, this can also be turned off at runtime with the `stats_on_block_map` config option.
 // #define DO_STATS_ON_BLOCK_MAP
 
-// Similar to DO_STATS_ON_BLOCK_MAP, but for IPv4 range drop map.
+// Removes expired block map entries from the loader (every `block_sweep_time` seconds) instead of the XDP program deleting them when the next packet from the source arrives.
+// The XDP program then only compares the expiry time for blocked sources. This requires BPF map batch operations (kernel 5.6+).
+// #define ENABLE_BLOCK_SWEEP
+
+// Keeps a bloom filter in front of the block maps so packets from sources that were never blocked skip the block map lookups.
+// The loader rebuilds the bloom filter every `block_bloom_rebuild_time` seconds to drop the bits of expired and removed blocks.
+// This requires atomic OR support for BPF programs (kernel 5.12+).
+// #define ENABLE_BLOCK_BLOOM
+
+// The amount of bits inside of the block bloom filter (must be a power of 2).
+#define BLOCK_BLOOM_BITS (1 << 21)
+
+// The amount of bits set per blocked source IP inside of the block bloom filter.
+#define BLOCK_BLOOM_HASHES 3
+
+// Similar to DO_STATS_ON_BLOCK_MAP, but for IPv4 range drop map (`stats_on_ip_range_drop_map` config option).
 // #define DO_STATS_ON_IP_RANGE_DROP_MAP
 
 // When this is defined, a check will occur inside the IPv4 and IPv6 filters.
@@ -28,20 +95,71 @@
 #define ALLOW_SINGLE_IP_V4_V6
 
 // Enables filter logging through XDP.
-// If performance is a concern, it is best to disable this feature by commenting out the below line with //.
+// If performance is a concern, it is best to disable this feature by commenting out the below line with // (or setting `enable_filter_logging` to false in the config).
 #define ENABLE_FILTER_LOGGING
 
+// Maximum entries in the map counting filter matches per rule and source IP that weren't logged due to the rule's `sample_rate` or `sample_pps` (or a full ring buffer).
+#define MAX_FILTER_LOG_SUPPRESSED 65536
+
+// Enables the police filter action (action 2).
+// Matching packets are passed through a token bucket per source IP (or per source flow with `police_flow`) and only the packets exceeding the rule's `police_rate` (bytes per second) and `police_burst` (bytes) are dropped.
+// #define ENABLE_FILTER_POLICE
+
+// Maximum entries in the police token bucket map.
+#define MAX_POLICE 100000
+
+// Enables the inspect filter action (action 3).
+// Matching packets are redirected to AF_XDP sockets created by the loader (one per RX queue) and passed to the registered inspection callbacks, which may block the packet's source IP (e.g. the built-in `inspect_patterns` callback).
+// Inspected packets are consumed by the loader and aren't passed to the network stack.
+// #define ENABLE_FILTER_INSPECT
+
+// Enables per-CPU hit/byte counters and last hit timestamps for each filter rule.
+// The counters are shown when listing the config (-l) with pinned maps and are required for reordering filter rules by hits (reorder_time).
+// When defined, this can also be turned off at runtime with the `enable_filter_stats` config option.
+// #define ENABLE_FILTER_STATS
+
+// Uses bpf_ktime_get_coarse_ns() instead of bpf_ktime_get_ns() for timestamps (requires kernel 5.11+).
+// The coarse clock only has tick precision (1 - 10 ms), but is cheaper to read and is precise enough for block times and the one second rate limit windows.
+// #define USE_COARSE_TIME
+
 // Maximum interfaces the firewall can attach to.
 #define MAX_INTERFACES 6
 
-// NOTE - If you're receiving a high volume of spoofed packets, it is recommended you disable rate limiting below.
+// NOTE - If you're receiving a high volume of spoofed packets, it is recommended you disable rate limiting below or enable ENABLE_RL_SKETCH.
 // This is because the PPS/BPS counters are updated for every packet and with a spoofed attack, the LRU map will recycle a lot of entries resulting in additional load on the CPU.
-// Enable source IP rate limiting.
+// Enable source IP rate limiting (can also be turned off at runtime with the `enable_rl_ip` config option).
 #define ENABLE_RL_IP
 
-// Enable source flow rate limiting.
+// Enable source flow rate limiting (can also be turned off at runtime with the `enable_rl_flow` config option).
 // #define ENABLE_RL_FLOW
 
+// Estimates the source IP and/or source flow rates using a sliding window instead of resetting the counters every second.
+// The previous second's counters are weighted by how much of the previous second still overlaps the last second, so bursts can't be timed around the resets.
+// This stores two additional counters per rate limit map entry.
+// #define RL_IP_SLIDING_WINDOW
+// #define RL_FLOW_SLIDING_WINDOW
+
+// Stores the rate limit counters inside of per-CPU LRU maps instead of shared LRU maps.
+// This removes the atomic operations on a shared cache line when a single source is spread across multiple RX queues.
+// Since each CPU only sees its own share of a source's packets, the IP rates are multiplied by the `rl_percpu_scale` config option (active RX queue count by default).
+// Flow rates aren't scaled because RSS sends all packets of a flow to the same RX queue.
+// #define ENABLE_RL_PERCPU
+
+// Estimates source IP rates using a fixed-size per-CPU count-min sketch and only inserts sources into the source IP rate limit map once their estimated rates cross the promotion thresholds below.
+// This keeps the per-packet cost constant and stops spoofed floods from recycling the source IP rate limit map.
+// Sources that aren't promoted use their estimated rates (which are never lower than the real rates), so the promotion thresholds should be lower than the lowest `ip_pps`/`ip_bps` used by filter rules.
+// Each CPU's estimated rates are multiplied by the `rl_percpu_scale` config option (active RX queue count by default).
+// Requires ENABLE_RL_IP.
+// #define ENABLE_RL_SKETCH
+
+// The amount of rows (hash functions) and counters per row (must be a power of 2) inside of the count-min sketch.
+#define RL_SKETCH_ROWS 4
+#define RL_SKETCH_COLS 2048
+
+// The estimated source IP rates required to insert a source into the source IP rate limit map.
+#define RL_SKETCH_PROMOTE_PPS 1000
+#define RL_SKETCH_PROMOTE_BPS 1000000
+
 // Maximum entries in source IP rate limit map.
 #define MAX_RL_IP 100000
 
@@ -53,8 +171,16 @@
 
 // Enables IPv6.
 // If you're not using IPv6, this will speed up performance of the XDP program.
+// When defined, IPv6 processing can also be turned off at runtime with the `enable_ipv6` config option.
 #define ENABLE_IPV6
 
+// Parses up to two 802.1Q/802.1ad VLAN tags (QinQ) before the IP header so tagged packets are filtered instead of passed.
+// Filter rules can also match on the outer VLAN ID with the `vlan_id` option.
+#define ENABLE_VLAN
+
+// Counts packets, bytes, and drops per VLAN ID inside of the `map_vlan_stats` BPF map (requires ENABLE_VLAN).
+// #define ENABLE_VLAN_STATS
+
 // If enabled, uses a newer bpf_loop() function when choosing a source port for a new connection.
 // This allows for a much higher source port range. However, it requires a more recent kernel.
 #define USE_NEW_LOOP
@@ -2,4 +2,143 @@
 
 #define MAX_PCKT_LENGTH 65535
 #define MAX_CPUS 256
-#define NANO_TO_SEC 1000000000
\ No newline at end of file
+#define NANO_TO_SEC 1000000000
+
+// Filter rule actions.
+#define FILTER_ACTION_DROP 0
+#define FILTER_ACTION_ALLOW 1
+#define FILTER_ACTION_POLICE 2
+#define FILTER_ACTION_INSPECT 3
+
+// IPv6 extension headers skipped before the layer-4 header.
+// Packets with more or longer extension headers are dropped since they can't be filtered.
+#define IPV6_MAX_EXT_HDRS 6
+#define IPV6_MAX_EXT_LEN 512
+
+// Fragment types (the `fragment` filter option also accepts IP_FRAG_ANY).
+#define IP_FRAG_NONE 0
+#define IP_FRAG_FIRST 1
+#define IP_FRAG_LATER 2
+#define IP_FRAG_ANY 3
+
+// Fragment offset and more fragments flag masks (host byte order).
+#define IPV4_FRAG_OFFSET 0x1FFF
+#define IPV4_FRAG_MF 0x2000
+#define IPV6_FRAG_OFFSET 0xFFF8
+#define IPV6_FRAG_MF 0x0001
+#define IPV4_FRAG_DF 0x4000
+
+// Seconds a first fragment's verdict is applied to later fragments (ENABLE_FRAG_CACHE).
+// This matches the Linux kernel's default reassembly timeout (ipfrag_time).
+#define FRAG_CACHE_TIMEOUT 30
+
+// VLAN parsing (ENABLE_VLAN).
+#define VLAN_MAX_TAGS 2
+#define VLAN_VID_MASK 0x0FFF
+#define MAX_VLANS 4096
+
+// TCP flags inside of the 14th byte of the TCP header.
+#define TCP_FLAGS_FIN 0x01
+#define TCP_FLAGS_SYN 0x02
+#define TCP_FLAGS_RST 0x04
+#define TCP_FLAGS_ACK 0x10
+
+// SYN proxy (ENABLE_SYN_PROXY).
+// Built-in SYN cookies are valid for the current and previous time slot (in seconds).
+#define SYN_COOKIE_SLOT_TIME 60
+#define SYN_PROXY_TTL 64
+#define MAX_SYN_PROXY_PORTS 64
+
+// Payload patterns blocking the source of inspected packets (ENABLE_FILTER_INSPECT).
+#define MAX_INSPECT_PATTERNS 64
+#define MAX_INSPECT_PATTERN_LEN 256
+
+// The amount of block map entries read at once by the loader's expired block sweeper (ENABLE_BLOCK_SWEEP).
+#define BLOCK_SWEEP_BATCH_SIZE 1024
+
+// Block bloom filter layout (ENABLE_BLOCK_BLOOM).
+// The bloom filter map stores two copies of the bitset so the loader can rebuild one while the XDP program uses the other and the last word holds the active copy's index.
+#define BLOCK_BLOOM_WORDS (BLOCK_BLOOM_BITS / 64)
+#define BLOCK_BLOOM_ACTIVE_IDX (BLOCK_BLOOM_WORDS * 2)
+#define BLOCK_BLOOM_MAX_ENTRIES (BLOCK_BLOOM_ACTIVE_IDX + 1)
+
+#define BLOCK_BLOOM_SEED 0x85EBCA6B
+#define BLOCK_BLOOM_SEED6 0xC2B2AE35
+
+// Added to the source IP hash for every count-min sketch row so each row uses a different hash function (ENABLE_RL_SKETCH).
+#define RL_SKETCH_HASH_SEED 0x9E3779B9
+
+// Bit-vector filter classifier layout (ENABLE_FILTERS_BV).
+// Each filter rule is represented by a single bit and all bitmaps are stored in one BPF array map split up into the segments below.
+#define FILTERS_BV_WORDS ((MAX_FILTERS + 63) / 64)
+
+#define FILTERS_BV_MAX_INTERVALS ((MAX_FILTERS * 2) + 1)
+#define FILTERS_BV_MAX_PREFIXES (MAX_FILTERS + 1)
+
+#define FILTERS_BV_PROTO_TCP 0
+#define FILTERS_BV_PROTO_UDP 1
+#define FILTERS_BV_PROTO_ICMP 2
+#define FILTERS_BV_PROTO_TCP6 3
+#define FILTERS_BV_PROTO_UDP6 4
+#define FILTERS_BV_PROTO_ICMP6 5
+#define FILTERS_BV_PROTO_MAX 6
+
+#define FILTERS_BV_OFF_PROTO 0
+#define FILTERS_BV_OFF_TTL (FILTERS_BV_OFF_PROTO + FILTERS_BV_PROTO_MAX)
+#define FILTERS_BV_OFF_TOS (FILTERS_BV_OFF_TTL + 256)
+#define FILTERS_BV_OFF_TCP_FLAGS (FILTERS_BV_OFF_TOS + 256)
+#define FILTERS_BV_OFF_ICMP_TYPE (FILTERS_BV_OFF_TCP_FLAGS + 256)
+#define FILTERS_BV_OFF_ICMP_CODE (FILTERS_BV_OFF_ICMP_TYPE + 256)
+#define FILTERS_BV_OFF_SPORT (FILTERS_BV_OFF_ICMP_CODE + 256)
+#define FILTERS_BV_OFF_DPORT (FILTERS_BV_OFF_SPORT + FILTERS_BV_MAX_INTERVALS)
+#define FILTERS_BV_OFF_LEN (FILTERS_BV_OFF_DPORT + FILTERS_BV_MAX_INTERVALS)
+#define FILTERS_BV_OFF_SRC_IP (FILTERS_BV_OFF_LEN + FILTERS_BV_MAX_INTERVALS)
+#define FILTERS_BV_OFF_DST_IP (FILTERS_BV_OFF_SRC_IP + FILTERS_BV_MAX_PREFIXES)
+#define FILTERS_BV_OFF_SRC_IP6 (FILTERS_BV_OFF_DST_IP + FILTERS_BV_MAX_PREFIXES)
+#define FILTERS_BV_OFF_DST_IP6 (FILTERS_BV_OFF_SRC_IP6 + FILTERS_BV_MAX_PREFIXES)
+#define FILTERS_BV_MAX_ENTRIES (FILTERS_BV_OFF_DST_IP6 + FILTERS_BV_MAX_PREFIXES)
+
+// Ports and packet lengths are mapped to their interval index through a second array map (source port, destination port, and length).
+#define FILTERS_BV_IDX_SPORT 0
+#define FILTERS_BV_IDX_DPORT 65536
+#define FILTERS_BV_IDX_LEN (65536 * 2)
+#define FILTERS_BV_IDX_MAX_ENTRIES (65536 * 3)
+
+// Fields used inside of the bit-vector LPM trie key.
+#define FILTERS_BV_LPM_SRC_IP 0
+#define FILTERS_BV_LPM_DST_IP 1
+#define FILTERS_BV_LPM_SRC_IP6 2
+#define FILTERS_BV_LPM_DST_IP6 3
+#define FILTERS_BV_LPM_MAX 4
+
+// Protocol/destination port filter rule buckets (ENABLE_FILTERS_BUCKETS).
+// One bucket per destination port used by filter rules plus the TCP, UDP, and ICMP wildcard buckets.
+#define FILTERS_BUCKETS_MAX_ENTRIES (MAX_FILTERS + 3)
+
+// Tuple space search exact match filter rules (ENABLE_FILTERS_TSS).
+// Each bit indicates a field used by the rule and every distinct combination of fields (mask) is probed once by the XDP program.
+#define FILTERS_TSS_SRC_IP (1 << 0)
+#define FILTERS_TSS_DST_IP (1 << 1)
+#define FILTERS_TSS_SRC_IP6 (1 << 2)
+#define FILTERS_TSS_DST_IP6 (1 << 3)
+#define FILTERS_TSS_PROTO (1 << 4)
+#define FILTERS_TSS_SPORT (1 << 5)
+#define FILTERS_TSS_DPORT (1 << 6)
+
+// 7 IP combinations (none, IPv4, and IPv6 source/destination) * 5 protocol combinations (none, protocol, source port, destination port, both ports) - 1 (no fields).
+#define FILTERS_TSS_MAX_MASKS 34
+
+// The maximum amount of filter rules inside of the config.
+#ifdef ENABLE_FILTERS_TSS
+#define MAX_CFG_FILTERS (MAX_FILTERS + MAX_FILTERS_TSS)
+#else
+#define MAX_CFG_FILTERS MAX_FILTERS
+#endif
+
+// XDP program stages (ENABLE_TAIL_CALLS).
+// The stages are indexes inside of the program array map and run in this order.
+#define PIPELINE_STAGE_BLOCK 0
+#define PIPELINE_STAGE_RANGE_DROP 1
+#define PIPELINE_STAGE_RL 2
+#define PIPELINE_STAGE_FILTERS 3
+#define PIPELINE_STAGE_MAX 4
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <common/int_types.h>
+
+#ifndef __always_inline
+#define __always_inline inline __attribute__((always_inline))
+#endif
+
+/**
+ * Mixes the bits of a 32-bit value (MurmurHash3 finalizer).
+ * 
+ * @note This is shared by the XDP program and the loader (e.g. the block bloom filter requires both to set the same bits).
+ * 
+ * @param h The value to mix.
+ * 
+ * @return The mixed value.
+ */
+static __always_inline u32 hash_mix32(u32 h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    return h;
+}
\ No newline at end of file
@@ -12,7 +12,10 @@ struct filter_ip
 
 #ifdef ENABLE_IPV6
     u32 src_ip6[4];
+    u8 src_cidr6;
+
     u32 dst_ip6[4];
+    u8 dst_cidr6;
 #endif
 
     unsigned int do_min_ttl : 1;
@@ -29,6 +32,10 @@ struct filter_ip
 
     unsigned int do_tos : 1;
     u8 tos;
+
+    // The fragment type to match (IP_FRAG_*).
+    unsigned int do_frag : 1;
+    unsigned int frag : 2;
 } typedef filter_ip_t;
 
 struct filter_tcp
@@ -110,6 +117,12 @@ struct filter
     u8 action;
     u16 block_time;
 
+#ifdef ENABLE_FILTER_LOGGING
+    // Only every Nth match is logged and at most `sample_pps` matches per second on each CPU (0 disables either).
+    u32 sample_rate;
+    u32 sample_pps;
+#endif
+
 #ifdef ENABLE_RL_IP
     unsigned int do_ip_pps : 1;
     u64 ip_pps;
@@ -125,28 +138,168 @@ struct filter
     unsigned int do_flow_bps : 1;
     u64 flow_bps;
 #endif
+
+#ifdef ENABLE_FILTER_POLICE
+    unsigned int police_flow : 1;
+    u64 police_rate;
+    u64 police_burst;
+#endif
+
+#ifdef ENABLE_VLAN
+    // The outer VLAN ID (0 matches untagged packets).
+    unsigned int do_vlan_id : 1;
+    u16 vlan_id;
+#endif
     
     filter_ip_t ip;
 
     filter_tcp_t tcp;
     filter_udp_t udp;
     filter_icmp_t icmp;
+
+    // The rule's config index which stays the same when rules are reordered (filter log events and filter stats map key).
+    u32 id;
 } __attribute__((__aligned__(8))) typedef filter_t;
 
+struct filter_stats
+{
+    u64 hits;
+    u64 bytes;
+    u64 last_hit;
+} typedef filter_stats_t;
+
 struct stats
 {
     u64 allowed;
     u64 dropped;
     u64 passed;
+
+#ifdef ENABLE_BLOCK_BLOOM
+    u64 bloom_hits;
+    u64 bloom_false_hits;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    u64 inspected;
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    // SYN-ACK and RST replies sent by the SYN proxy.
+    u64 syn_proxy;
+#endif
 } typedef stats_t;
 
+struct vlan_stats
+{
+    u64 packets;
+    u64 bytes;
+    u64 dropped;
+} typedef vlan_stats_t;
+
+// State passed between the XDP program stages (ENABLE_TAIL_CALLS).
+struct pipeline_ctx
+{
+    u64 now;
+
+    u64 ip_pps;
+    u64 ip_bps;
+
+    u64 flow_pps;
+    u64 flow_bps;
+
+    u32 src_ip;
+    u128 src_ip6;
+
+    // Header offsets from the start of the packet.
+    u16 l3_off;
+    u16 l4_off;
+
+    u16 pkt_len;
+
+    u16 src_port;
+    u16 dst_port;
+
+    u8 protocol;
+    u8 ipv6;
+
+    // The fragment type (IP_FRAG_*). Non-first fragments don't contain a layer-4 header.
+    u8 frag;
+
+#ifdef ENABLE_FRAG_CACHE
+    u32 frag_id;
+
+    // Set when a non-first fragment's first fragment was seen along with the first fragment's XDP action and whether it came from a filter rule.
+    u8 frag_seen;
+    u8 frag_action;
+    u8 frag_matched;
+#endif
+
+#ifdef ENABLE_VLAN
+    u16 vlan_id;
+
+#ifdef ENABLE_VLAN_STATS
+    // Whether the packet is VLAN tagged (the stages count their drops towards the VLAN).
+    u8 vlan_tagged;
+#endif
+#endif
+} typedef pipeline_ctx_t;
+
+// Runtime switches for features that are compiled in (stored inside of the XDP program's .rodata section and set by the loader before the program is loaded).
+struct features
+{
+    u8 ipv6;
+    u8 rl_ip;
+    u8 rl_flow;
+    u8 filter_logging;
+    u8 filter_stats;
+    u8 stats_on_block_map;
+    u8 stats_on_ip_range_drop_map;
+    u16 rl_percpu_scale;
+
+#ifdef ENABLE_SYN_PROXY
+    u32 syn_proxy_allow_time;
+
+    // Generated by the loader on startup (built-in SYN cookies).
+    u32 syn_cookie_secret[2];
+#endif
+} typedef features_t;
+
 struct cl_stats
 {
     u64 pps;
     u64 bps;
     u64 next_update;
+
+#if defined(RL_IP_SLIDING_WINDOW) || defined(RL_FLOW_SLIDING_WINDOW)
+    // The counters of the previous one second window (sliding window rate limiting).
+    u64 prev_pps;
+    u64 prev_bps;
+#endif
 } typedef cl_stats_t;
 
+// Token buckets of the police filter action are stored per rule and source IP (the source port and protocol are only set with `police_flow`).
+struct police_key
+{
+    u128 ip;
+    u32 rule;
+    u16 port;
+    u8 protocol;
+} typedef police_key_t;
+
+struct police_bucket
+{
+    u64 tokens;
+    u64 last_update;
+} typedef police_bucket_t;
+
+// A single row of the source IP count-min sketch (ENABLE_RL_SKETCH).
+struct rl_sketch_row
+{
+    u64 next_update;
+    u32 pps[RL_SKETCH_COLS];
+    u32 bps[RL_SKETCH_COLS];
+} typedef rl_sketch_row_t;
+
 struct flow
 {
     u32 ip;
@@ -187,8 +340,171 @@ struct filter_log_event
     u64 flow_bps;
 } typedef filter_log_event_t;
 
+// The per-CPU sampling state of a filter rule's log events.
+struct filter_log_sample
+{
+    u64 window;
+    u32 matches;
+    u32 logged;
+} typedef filter_log_sample_t;
+
+struct filter_log_suppressed_key
+{
+    u32 filter_id;
+
+    u32 src_ip;
+    u32 src_ip6[4];
+} typedef filter_log_suppressed_key_t;
+
+struct filter_log_suppressed
+{
+    u64 packets;
+    u64 bytes;
+} typedef filter_log_suppressed_t;
+
 struct lpm_trie_key
 {
     u32 prefix_len;
     u32 data;
-} typedef lpm_trie_key_t;
\ No newline at end of file
+} typedef lpm_trie_key_t;
+
+struct lpm_trie_key6
+{
+    u32 prefix_len;
+    u32 data[4];
+} typedef lpm_trie_key6_t;
+
+struct filter_bv
+{
+    u64 words[FILTERS_BV_WORDS];
+} typedef filter_bv_t;
+
+struct filter_bv_lpm_key
+{
+    u32 prefix_len;
+    u32 field;
+    u32 ip[4];
+} typedef filter_bv_lpm_key_t;
+
+struct filter_bucket_key
+{
+    u8 protocol;
+    u8 any_dport;
+    u16 dport;
+} typedef filter_bucket_key_t;
+
+struct filter_bucket
+{
+    u16 cnt;
+    u16 rules[MAX_FILTERS];
+} typedef filter_bucket_t;
+
+struct filter_tss_key
+{
+    u32 mask;
+
+    u32 src_ip[4];
+    u32 dst_ip[4];
+
+    u16 sport;
+    u16 dport;
+
+    u8 protocol;
+    u8 pad[3];
+} typedef filter_tss_key_t;
+
+struct filter_tss_val
+{
+    u32 gen;
+
+    // The rule's position among all enabled rules (lower is higher priority).
+    u32 priority;
+
+    // The amount of rules inside of the filters map that come before this rule.
+    u32 filters_before;
+
+    // The rule's config index.
+    u32 id;
+
+    unsigned int log : 1;
+    u8 action;
+    u16 block_time;
+
+#ifdef ENABLE_FILTER_LOGGING
+    u32 sample_rate;
+    u32 sample_pps;
+#endif
+} typedef filter_tss_val_t;
+
+struct filter_tss_masks
+{
+    u32 gen;
+    u32 cnt;
+    u32 masks[FILTERS_TSS_MAX_MASKS];
+} typedef filter_tss_masks_t;
+
+struct filter_cache_key
+{
+    u32 src_ip[4];
+    u32 dst_ip[4];
+
+    u16 src_port;
+    u16 dst_port;
+
+    u8 protocol;
+    u8 ipv6;
+    u16 vlan_id;
+} typedef filter_cache_key_t;
+
+struct filter_cache_val
+{
+    // The filter rules generation the verdict was cached with.
+    u32 gen;
+
+#ifdef ENABLE_FILTER_STATS
+    u32 id;
+#endif
+
+    unsigned int matched : 1;
+    u8 action;
+    u16 block_time;
+
+#ifdef ENABLE_FILTER_POLICE
+    u32 police_idx;
+    unsigned int police_flow : 1;
+    u64 police_rate;
+    u64 police_burst;
+#endif
+} typedef filter_cache_val_t;
+
+struct filter_cache_meta
+{
+    u32 gen;
+
+    // The amount of rules at the start of the filters map that can be cached (the index of the first rule that can't be cached).
+    u32 cacheable;
+} typedef filter_cache_meta_t;
+
+// Identifies a fragmented datagram inside of the fragment cache (ENABLE_FRAG_CACHE).
+struct frag_key
+{
+    u32 src_ip[4];
+    u32 dst_ip[4];
+    u32 id;
+    u8 protocol;
+    u8 ipv6;
+    u8 pad[2];
+} typedef frag_key_t;
+
+struct frag_val
+{
+    u64 expires;
+
+    // The first fragment's ports (network byte order).
+    u16 src_port;
+    u16 dst_port;
+
+    // The first fragment's XDP action and whether it came from a filter rule.
+    u8 action;
+    u8 matched;
+} typedef frag_val_t;
\ No newline at end of file
@@ -8,14 +8,24 @@
 #include <sys/resource.h>
 #include <sys/sysinfo.h>
 #include <sys/stat.h>
+#include <sys/random.h>
 
 #include <net/if.h>
 
 #include <loader/utils/cli.h>
 #include <loader/utils/config.h>
 #include <loader/utils/xdp.h>
+#include <loader/utils/bv.h>
+#include <loader/utils/bucket.h>
+#include <loader/utils/tss.h>
+#include <loader/utils/bloom.h>
+#include <loader/utils/reorder.h>
+#include <loader/utils/codegen.h>
+#include <loader/utils/pipeline.h>
 #include <loader/utils/logging.h>
 #include <loader/utils/stats.h>
+#include <loader/utils/inspect.h>
+#include <loader/utils/events.h>
 #include <loader/utils/helpers.h>
 
 int cont = 1;
@@ -60,6 +70,17 @@ static void unpin_needed_maps(config__t* cfg, struct bpf_object* obj, int ignore
     }
 #endif
 
+#ifdef ENABLE_BLOCK_BLOOM
+    // Unpin block bloom filter map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_block_bloom")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_block_bloom' from file system (%d).", ret);
+        }
+    }
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
     // Unpin IPv4 range drop map.
     if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_range_drop")) != 0)
@@ -69,6 +90,17 @@ static void unpin_needed_maps(config__t* cfg, struct bpf_object* obj, int ignore
             log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_range_drop' from file system (%d).", ret);
         }
     }
+
+#ifdef ENABLE_IPV6
+    // Unpin IPv6 range drop map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_range_drop6")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_range_drop6' from file system (%d).", ret);
+        }
+    }
+#endif
 #endif
 
 #ifdef ENABLE_FILTERS
@@ -81,6 +113,85 @@ static void unpin_needed_maps(config__t* cfg, struct bpf_object* obj, int ignore
         }
     }
 
+#ifdef ENABLE_FILTERS_BV
+    // Unpin bit-vector classifier maps.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_bv' from file system (%d).", ret);
+        }
+    }
+
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv_idx")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_bv_idx' from file system (%d).", ret);
+        }
+    }
+
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv_lpm")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_bv_lpm' from file system (%d).", ret);
+        }
+    }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+    // Unpin filter buckets map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_buckets")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filter_buckets' from file system (%d).", ret);
+        }
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+    // Unpin exact match maps.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_tss")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_tss' from file system (%d).", ret);
+        }
+    }
+
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_tss_masks")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_tss_masks' from file system (%d).", ret);
+        }
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+    // Unpin verdict cache meta map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_cache_meta")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filters_cache_meta' from file system (%d).", ret);
+        }
+    }
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+    // Unpin filter stats map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_stats")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_filter_stats' from file system (%d).", ret);
+        }
+    }
+#endif
+
 #ifdef ENABLE_FILTER_LOGGING
     // Unpin filters log map.
     if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_log")) != 0)
@@ -92,6 +203,35 @@ static void unpin_needed_maps(config__t* cfg, struct bpf_object* obj, int ignore
     }
 #endif
 #endif
+
+#ifdef ENABLE_VLAN_STATS
+    // Unpin VLAN stats map.
+    if ((ret = unpin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_vlan_stats")) != 0)
+    {
+        if (!ignore_errors)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to un-pin BPF map 'map_vlan_stats' from file system (%d).", ret);
+        }
+    }
+#endif
+}
+
+/**
+ * Retrieves the interval of the main loop's timer.
+ * 
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return The interval in milliseconds.
+ */
+static int get_tick_time(config__t* cfg)
+{
+    // The periodic tasks only need a resolution of one second when stats aren't displayed.
+    if (cfg->no_stats || cfg->stdout_update_time <= 0)
+    {
+        return 1000;
+    }
+
+    return cfg->stdout_update_time;
 }
 
 int main(int argc, char *argv[])
@@ -107,6 +247,8 @@ int main(int argc, char *argv[])
     cli.no_stats = -1;
     cli.stats_per_second = -1;
     cli.stdout_update_time = -1;
+    cli.reorder_time = -1;
+    cli.codegen = -1;
 
     parse_cli(&cli, argc, argv);
 
@@ -119,7 +261,8 @@ int main(int argc, char *argv[])
     }
 
     // Initialize config.
-    config__t cfg = {0};
+    // The config structure is static since it may be too large for the stack (see MAX_CFG_FILTERS).
+    static config__t cfg = {0};
 
     // Create overrides for config and set arguments from CLI.
     config_overrides_t cfg_overrides = {0};
@@ -131,6 +274,8 @@ int main(int argc, char *argv[])
     cfg_overrides.no_stats = cli.no_stats;
     cfg_overrides.stats_per_second = cli.stats_per_second;
     cfg_overrides.stdout_update_time = cli.stdout_update_time;
+    cfg_overrides.reorder_time = cli.reorder_time;
+    cfg_overrides.codegen = cli.codegen;
 
     // Load config.
     if ((ret = load_cfg(&cfg, cli.cfg_file, 1, &cfg_overrides)) != 0)
@@ -145,6 +290,16 @@ int main(int argc, char *argv[])
     {
         print_cfg(&cfg);
 
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_STATS)
+        // Print filter rule counters if the firewall is running with pinned maps.
+        int map_filter_stats = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filter_stats");
+
+        if (map_filter_stats > -1)
+        {
+            print_filter_stats(map_filter_stats, get_nprocs_conf(), &cfg);
+        }
+#endif
+
         return EXIT_SUCCESS;
     }
 
@@ -196,6 +351,59 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+#if defined(ENABLE_RL_PERCPU) || defined(ENABLE_RL_SKETCH)
+    // Each CPU only counts its own share of a source's packets, so the XDP program scales the IP rates by the amount of active RX queues by default.
+    int rx_queues = 1;
+
+    for (int i = 0; i < cfg.interfaces_cnt; i++)
+    {
+        int queues = get_rx_queue_cnt(cfg.interfaces[i]);
+
+        if (queues > rx_queues)
+        {
+            rx_queues = queues;
+        }
+    }
+
+    // Queues without a CPU to process them can't receive packets.
+    if (rx_queues > get_nprocs())
+    {
+        rx_queues = get_nprocs();
+    }
+
+    cfg.features.rl_percpu_scale = (cfg.rl_percpu_scale > 0) ? cfg.rl_percpu_scale : rx_queues;
+
+    log_msg(&cfg, 2, 0, "Using a per-CPU rate limit scale of %d...", cfg.features.rl_percpu_scale);
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    cfg.features.syn_proxy_allow_time = cfg.syn_proxy_allow_time;
+
+    // The built-in SYN cookies are keyed with a random secret that stays the same until the firewall is restarted.
+    if (getrandom(cfg.features.syn_cookie_secret, sizeof(cfg.features.syn_cookie_secret), 0) != sizeof(cfg.features.syn_cookie_secret))
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to generate SYN cookie secret (%d).\n", errno);
+
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // Set runtime features before the XDP program is loaded on attach.
+    if ((ret = set_rodata_var(prog, "features", &cfg.features, sizeof(cfg.features))) != 0)
+    {
+#ifdef ENABLE_SYN_PROXY
+        // The defaults contain an all-zero SYN cookie secret which would make the SYN cookies predictable.
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to set XDP program features including the SYN cookie secret (%d).\n", ret);
+
+        return EXIT_FAILURE;
+#else
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to set XDP program features (%d). Using defaults (all compiled features enabled)...", ret);
+#endif
+    }
+
+    // The generated XDP program replaces the base XDP program when code generation is enabled.
+    struct xdp_program* prog_active = prog;
+
     int if_idx[MAX_INTERFACES] = {0};
     int attach_success = 0;
 
@@ -232,6 +440,9 @@ int main(int argc, char *argv[])
         {
             log_msg(&cfg, 0, 1, "[WARNING] Failed to attach XDP program to interface '%s' using available modes (%d).\n", interface, ret);
 
+            // Make sure we don't swap XDP programs on this interface later on.
+            if_idx[i] = 0;
+
             continue;
         }
     
@@ -253,6 +464,27 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+#ifdef ENABLE_TAIL_CALLS
+    // Packets aren't processed by any stage until the program array map is populated.
+    int map_pipeline = get_map_fd(prog, "map_pipeline");
+
+    if (map_pipeline < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find 'map_pipeline' BPF map.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_pipeline FD => %d.", map_pipeline);
+
+    if ((ret = update_pipeline(map_pipeline, prog, &cfg)) != 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to set XDP program stages (%d).\n", ret);
+
+        return EXIT_FAILURE;
+    }
+#endif
+
     log_msg(&cfg, 2, 0, "Retrieving BPF map FDs...");
 
     // Retrieve BPF maps.
@@ -278,6 +510,82 @@ int main(int argc, char *argv[])
 
     log_msg(&cfg, 3, 0, "map_filters FD => %d.", map_filters);
 
+#ifdef ENABLE_FILTERS_BV
+    int map_filters_bv = get_map_fd(prog, "map_filters_bv");
+    int map_filters_bv_idx = get_map_fd(prog, "map_filters_bv_idx");
+    int map_filters_bv_lpm = get_map_fd(prog, "map_filters_bv_lpm");
+
+    if (map_filters_bv < 0 || map_filters_bv_idx < 0 || map_filters_bv_lpm < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find bit-vector classifier BPF maps.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_filters_bv FD => %d.", map_filters_bv);
+    log_msg(&cfg, 3, 0, "map_filters_bv_idx FD => %d.", map_filters_bv_idx);
+    log_msg(&cfg, 3, 0, "map_filters_bv_lpm FD => %d.", map_filters_bv_lpm);
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+    int map_filter_buckets = get_map_fd(prog, "map_filter_buckets");
+
+    if (map_filter_buckets < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find 'map_filter_buckets' BPF map.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_filter_buckets FD => %d.", map_filter_buckets);
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+    int map_filters_tss = get_map_fd(prog, "map_filters_tss");
+    int map_filters_tss_masks = get_map_fd(prog, "map_filters_tss_masks");
+
+    if (map_filters_tss < 0 || map_filters_tss_masks < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find exact match BPF maps.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_filters_tss FD => %d.", map_filters_tss);
+    log_msg(&cfg, 3, 0, "map_filters_tss_masks FD => %d.", map_filters_tss_masks);
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+    int map_filters_cache_meta = get_map_fd(prog, "map_filters_cache_meta");
+
+    if (map_filters_cache_meta < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find verdict cache meta BPF map.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_filters_cache_meta FD => %d.", map_filters_cache_meta);
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+    int map_filter_stats = get_map_fd(prog, "map_filter_stats");
+
+    if (map_filter_stats < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to find 'map_filter_stats' BPF map.\n");
+
+        return EXIT_FAILURE;
+    }
+
+    log_msg(&cfg, 3, 0, "map_filter_stats FD => %d.", map_filter_stats);
+#else
+    if (cfg.reorder_time > 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Filter rules can't be reordered since ENABLE_FILTER_STATS isn't defined...");
+    }
+#endif
+
 #ifdef ENABLE_FILTER_LOGGING
     int map_filter_log = get_map_fd(prog, "map_filter_log");
 
@@ -293,9 +601,67 @@ int main(int argc, char *argv[])
 
         rb = ring_buffer__new(map_filter_log, hdl_filters_rb_event, &cfg, NULL);
     }
+
+    int map_filter_log_suppressed = get_map_fd(prog, "map_filter_log_suppressed");
+
+    if (map_filter_log_suppressed < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_filter_log_suppressed' BPF map. Suppressed filter matches won't be logged...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_filter_log_suppressed FD => %d.", map_filter_log_suppressed);
+    }
+#endif
+#endif
+
+#if defined(ENABLE_BLOCK_SWEEP) || defined(ENABLE_BLOCK_BLOOM) || defined(ENABLE_FILTER_INSPECT)
+    int map_block = get_map_fd(prog, "map_block");
+
+    if (map_block < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_block' BPF map...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_block FD => %d.", map_block);
+    }
+
+    int map_block6 = -1;
+
+#ifdef ENABLE_IPV6
+    map_block6 = get_map_fd(prog, "map_block6");
+
+    if (map_block6 < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_block6' BPF map...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_block6 FD => %d.", map_block6);
+    }
 #endif
 #endif
 
+#ifdef ENABLE_BLOCK_BLOOM
+    u64* block_bloom = NULL;
+
+    int map_block_bloom = get_map_fd(prog, "map_block_bloom");
+
+    if (map_block_bloom < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_block_bloom' BPF map. The block bloom filter won't be rebuilt...");
+    }
+    else if ((block_bloom = mmap_block_bloom(map_block_bloom)) == NULL)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to map 'map_block_bloom' BPF map into memory (%d). The block bloom filter won't be rebuilt...", errno);
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_block_bloom FD => %d.", map_block_bloom);
+    }
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
     int map_range_drop = get_map_fd(prog, "map_range_drop");
 
@@ -307,6 +673,47 @@ int main(int argc, char *argv[])
     {
         log_msg(&cfg, 3, 0, "map_range_drop FD => %d.", map_range_drop);
     }
+
+#ifdef ENABLE_IPV6
+    int map_range_drop6 = get_map_fd(prog, "map_range_drop6");
+
+    if (map_range_drop6 < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_range_drop6' BPF map. IPv6 range drops will be disabled...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_range_drop6 FD => %d.", map_range_drop6);
+    }
+#endif
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    int map_syn_proxy_ports = get_map_fd(prog, "map_syn_proxy_ports");
+
+    if (map_syn_proxy_ports < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_syn_proxy_ports' BPF map. The SYN proxy will be disabled...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_syn_proxy_ports FD => %d.", map_syn_proxy_ports);
+    }
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    int map_xsks = get_map_fd(prog, "map_xsks");
+    int map_xsks_ifaces = get_map_fd(prog, "map_xsks_ifaces");
+
+    if (map_xsks < 0 || map_xsks_ifaces < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to find 'map_xsks' or 'map_xsks_ifaces' BPF map. Packets matching inspect rules will be passed...");
+    }
+    else
+    {
+        log_msg(&cfg, 3, 0, "map_xsks FD => %d.", map_xsks);
+        log_msg(&cfg, 3, 0, "map_xsks_ifaces FD => %d.", map_xsks_ifaces);
+    }
 #endif
 
     log_msg(&cfg, 3, 0, "map_stats FD => %d.", map_stats);
@@ -352,6 +759,18 @@ int main(int argc, char *argv[])
         }
 #endif
 
+#ifdef ENABLE_BLOCK_BLOOM
+        // Pin the block bloom filter map so xdpfw-add can set the bits of new blocks.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_block_bloom")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_block_bloom' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_block_bloom' pinned to '%s/map_block_bloom'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
         // Pin the IPv4 range drop map.
         if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_range_drop")) != 0)
@@ -362,6 +781,18 @@ int main(int argc, char *argv[])
         {
             log_msg(&cfg, 3, 0, "BPF map 'map_range_drop' pinned to '%s/map_range_drop'.", XDP_MAP_PIN_DIR);
         }
+
+#ifdef ENABLE_IPV6
+        // Pin the IPv6 range drop map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_range_drop6")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_range_drop6' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_range_drop6' pinned to '%s/map_range_drop6'.", XDP_MAP_PIN_DIR);
+        }
+#endif
 #endif
 
 #ifdef ENABLE_FILTERS
@@ -375,17 +806,116 @@ int main(int argc, char *argv[])
             log_msg(&cfg, 3, 0, "BPF map 'map_filters' pinned to '%s/map_filters'.", XDP_MAP_PIN_DIR);
         }
 
-#ifdef ENABLE_FILTER_LOGGING
-        // Pin the filters log map.
-        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_log")) != 0)
+#ifdef ENABLE_FILTERS_BV
+        // Pin the bit-vector classifier maps.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv")) != 0)
         {
-            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filter_log' to file system (%d)...", ret);
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_bv' to file system (%d)...", ret);
         }
         else
         {
-            log_msg(&cfg, 3, 0, "BPF map 'map_filter_log' pinned to '%s/map_filter_log'.", XDP_MAP_PIN_DIR);
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_bv' pinned to '%s/map_filters_bv'.", XDP_MAP_PIN_DIR);
+        }
+
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv_idx")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_bv_idx' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_bv_idx' pinned to '%s/map_filters_bv_idx'.", XDP_MAP_PIN_DIR);
+        }
+
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_bv_lpm")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_bv_lpm' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_bv_lpm' pinned to '%s/map_filters_bv_lpm'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+        // Pin the filter buckets map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_buckets")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filter_buckets' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filter_buckets' pinned to '%s/map_filter_buckets'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+        // Pin the exact match maps.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_tss")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_tss' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_tss' pinned to '%s/map_filters_tss'.", XDP_MAP_PIN_DIR);
+        }
+
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_tss_masks")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_tss_masks' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_tss_masks' pinned to '%s/map_filters_tss_masks'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+        // Pin the verdict cache meta map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filters_cache_meta")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filters_cache_meta' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filters_cache_meta' pinned to '%s/map_filters_cache_meta'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+        // Pin the filter stats map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_stats")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filter_stats' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filter_stats' pinned to '%s/map_filter_stats'.", XDP_MAP_PIN_DIR);
+        }
+#endif
+
+#ifdef ENABLE_FILTER_LOGGING
+        // Pin the filters log map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_filter_log")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_filter_log' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_filter_log' pinned to '%s/map_filter_log'.", XDP_MAP_PIN_DIR);
         }
 #endif
+#endif
+
+#ifdef ENABLE_VLAN_STATS
+        // Pin the VLAN stats map.
+        if ((ret = pin_bpf_map(obj, XDP_MAP_PIN_DIR, "map_vlan_stats")) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to pin 'map_vlan_stats' to file system (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "BPF map 'map_vlan_stats' pinned to '%s/map_vlan_stats'.", XDP_MAP_PIN_DIR);
+        }
 #endif
     }
 
@@ -394,6 +924,51 @@ int main(int argc, char *argv[])
 
     // Update filters.
     update_filters(map_filters, &cfg);
+
+#ifdef ENABLE_FILTERS_BV
+    if ((ret = update_filters_bv(map_filters_bv, map_filters_bv_idx, map_filters_bv_lpm, &cfg)) != 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to update bit-vector classifier maps (%d)...", ret);
+    }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+    if ((ret = update_filter_buckets(map_filter_buckets, &cfg)) != 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to update filter buckets (%d)...", ret);
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+    if ((ret = update_filters_tss(map_filters_tss, map_filters_tss_masks, &cfg)) != 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to update exact match filters (%d)...", ret);
+    }
+#endif
+
+    if (cfg.codegen)
+    {
+        log_msg(&cfg, 2, 0, "Generating XDP program from filter rules...");
+
+        if ((ret = swap_codegen_prog(prog, &prog_active, &cfg, if_idx, cli.skb, cli.offload)) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to generate XDP program from filter rules (%d). Using the base XDP program...", ret);
+        }
+
+#ifdef ENABLE_TAIL_CALLS
+        if ((ret = update_pipeline(map_pipeline, prog_active, &cfg)) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to update XDP program stages (%d)...", ret);
+        }
+#endif
+    }
+
+#ifdef ENABLE_FILTERS_CACHE
+    if ((ret = update_filters_cache(map_filters_cache_meta, &cfg)) != 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to update verdict cache generation (%d)...", ret);
+    }
+#endif
 #endif
 
 #ifdef ENABLE_IP_RANGE_DROP
@@ -404,11 +979,92 @@ int main(int argc, char *argv[])
         // Update IP range drops.
         update_range_drops(map_range_drop, &cfg);
     }
+
+#ifdef ENABLE_IPV6
+    if (map_range_drop6 > -1)
+    {
+        log_msg(&cfg, 2, 0, "Updating IPv6 drop ranges...");
+
+        update_range_drops6(map_range_drop6, &cfg);
+    }
+#endif
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    if (map_syn_proxy_ports > -1)
+    {
+        log_msg(&cfg, 2, 0, "Updating SYN proxy ports...");
+
+        if ((ret = update_syn_proxy_ports(map_syn_proxy_ports, &cfg)) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to update SYN proxy ports (%d)...", ret);
+        }
+    }
+#endif
+
+    // Signals are received through a signal FD inside of the main loop, which requires blocking them before any threads are created.
+    int sig_fd = create_signal_fd();
+
+    if (sig_fd < 0)
+    {
+        log_msg(&cfg, 1, 0, "[WARNING] Failed to create signal FD (%d). Falling back to signal handlers...", sig_fd);
+
+        signal(SIGINT, hdl_signal);
+        signal(SIGTERM, hdl_signal);
+    }
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+    if (rb)
+    {
+        if ((ret = start_filters_rb(rb, cfg.log_thread_cpu, cfg.log_busy_poll)) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to start filter log thread (%d). Filter logging will be disabled...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "Started filter log thread (CPU => %d, busy poll => %d).", cfg.log_thread_cpu, cfg.log_busy_poll);
+        }
+    }
 #endif
 
-    // Signal.
-    signal(SIGINT, hdl_signal);
-    signal(SIGTERM, hdl_signal);
+#ifdef ENABLE_FILTER_INSPECT
+    if (map_xsks > -1 && map_xsks_ifaces > -1)
+    {
+        log_msg(&cfg, 2, 0, "Starting inspection threads...");
+
+        if (cfg.verbose >= 5)
+        {
+            register_inspect_cb(inspect_log_cb, NULL, 0);
+        }
+
+        // The patterns are only read on startup since the callbacks can't be changed while the inspection threads are running.
+        static inspect_patterns_t inspect_patterns;
+
+        if (init_inspect_patterns(&inspect_patterns, &cfg) > 0)
+        {
+            register_inspect_cb(inspect_pattern_cb, &inspect_patterns, 1);
+        }
+
+        u64* inspect_bloom = NULL;
+
+#ifdef ENABLE_BLOCK_BLOOM
+        inspect_bloom = block_bloom;
+#endif
+
+        if ((ret = start_inspect(&cfg, if_idx, map_xsks, map_xsks_ifaces, map_block, map_block6, inspect_bloom)) == -ENOENT)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] No inspection callback that sets a verdict is registered ('inspect_patterns' is empty). Packets matching inspect rules will be passed...");
+        }
+        else if (ret < 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to start inspection threads (%d)...", ret);
+        }
+        else
+        {
+            log_msg(&cfg, 3, 0, "Started %d inspection thread(s).", ret);
+        }
+    }
+#endif
 
     // Receive CPU count for stats map parsing.
     int cpus = get_nprocs_conf();
@@ -421,7 +1077,21 @@ int main(int argc, char *argv[])
     time_t last_update_check = time(NULL);
     time_t last_config_check = time(NULL);
 
-    unsigned int sleep_time = cfg.stdout_update_time * 1000;
+#ifdef ENABLE_FILTER_STATS
+    time_t last_reorder = time(NULL);
+#endif
+
+#ifdef ENABLE_BLOCK_SWEEP
+    time_t last_block_sweep = time(NULL);
+#endif
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+    time_t last_log_flush = time(NULL);
+#endif
+
+#ifdef ENABLE_BLOCK_BLOOM
+    time_t last_block_bloom_rebuild = time(NULL);
+#endif
 
     struct stat conf_stat;
 
@@ -431,8 +1101,92 @@ int main(int argc, char *argv[])
         doing_stats = 1;
     }
 
+    // Stats and the periodic tasks run on a timer while config changes and signals wake up the main loop right away.
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int timer_fd = create_timer_fd(get_tick_time(&cfg));
+    int cfg_watch_fd = create_cfg_watch(cli.cfg_file);
+
+    if (epoll_fd < 0 || timer_fd < 0)
+    {
+        log_msg(&cfg, 0, 1, "[ERROR] Failed to create main loop event FDs (%d, %d).", epoll_fd, timer_fd);
+
+        cont = 0;
+    }
+    else
+    {
+        add_epoll_fd(epoll_fd, timer_fd);
+
+        if (sig_fd > -1)
+        {
+            add_epoll_fd(epoll_fd, sig_fd);
+        }
+
+        if (cfg_watch_fd < 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to watch config file for changes (%d). Checking the config file every 'update_time' seconds instead...", cfg_watch_fd);
+        }
+        else if ((ret = add_epoll_fd(epoll_fd, cfg_watch_fd)) != 0)
+        {
+            log_msg(&cfg, 1, 0, "[WARNING] Failed to add config watch FD to main loop (%d). Checking the config file every 'update_time' seconds instead...", ret);
+
+            close(cfg_watch_fd);
+            cfg_watch_fd = -1;
+        }
+    }
+
     while (cont)
     {
+        struct epoll_event events[MAX_LOADER_EVENTS];
+
+        int cnt = epoll_wait(epoll_fd, events, MAX_LOADER_EVENTS, -1);
+
+        int tick = 0;
+        int reload = 0;
+
+        for (int i = 0; i < cnt; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == sig_fd)
+            {
+                struct signalfd_siginfo info;
+
+                while (read(sig_fd, &info, sizeof(info)) == sizeof(info))
+                {
+                    // SIGHUP reloads the config regardless of the update time.
+                    if (info.ssi_signo == SIGHUP)
+                    {
+                        reload = 1;
+                    }
+                    else
+                    {
+                        cont = 0;
+                    }
+                }
+            }
+            else if (fd == timer_fd)
+            {
+                u64 expirations;
+
+                if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+                {
+                    tick = 1;
+                }
+            }
+            else if (fd == cfg_watch_fd)
+            {
+                if (read_cfg_watch(cfg_watch_fd, cli.cfg_file) && cfg.update_time > 0)
+                {
+                    reload = 1;
+                }
+            }
+        }
+
+        if (!cont)
+        {
+            break;
+        }
+
         // Get current time.
         time_t cur_time = time(NULL);
 
@@ -442,47 +1196,265 @@ int main(int argc, char *argv[])
             break;
         }
 
-        // Check for auto-update.
-        if (cfg.update_time > 0 && (cur_time - last_update_check) > cfg.update_time)
+        // Check the config file's modification time when inotify isn't available.
+        if (tick && cfg_watch_fd < 0 && cfg.update_time > 0 && (cur_time - last_update_check) > cfg.update_time)
         {
             log_msg(&cfg, 6, 0, "Checking for config updates...");
 
             // Check if config file have been modified
-            if (stat(cli.cfg_file, &conf_stat) == 0 && conf_stat.st_mtime > last_config_check) {
-                log_msg(&cfg, 3, 0, "Config file change detected during update. Attempting to reload config...");
-                
-                // Reload config.
-                if ((ret = load_cfg(&cfg, cli.cfg_file, 1, &cfg_overrides)) != 0)
+            if (stat(cli.cfg_file, &conf_stat) == 0 && conf_stat.st_mtime > last_config_check)
+            {
+                reload = 1;
+            }
+
+            // Update last updated variable.
+            last_update_check = time(NULL);
+        }
+
+        if (reload)
+        {
+            log_msg(&cfg, 3, 0, "Config file change detected. Attempting to reload config...");
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+            // The suppressed matches are keyed by config index which may point to a different rule after the reload.
+            if (map_filter_log_suppressed > -1 && (ret = flush_filter_log_suppressed(&cfg, map_filter_log_suppressed, cpus)) < 0)
+            {
+                log_msg(&cfg, 1, 0, "[WARNING] Failed to flush suppressed filter matches (%d)...", ret);
+            }
+
+            last_log_flush = time(NULL);
+
+            // The filter log thread reads the config while handling events.
+            lock_filters_rb();
+#endif
+
+            ret = load_cfg(&cfg, cli.cfg_file, 1, &cfg_overrides);
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+            unlock_filters_rb();
+#endif
+
+            // Reload config.
+            if (ret != 0)
+            {
+                log_msg(&cfg, 1, 0, "[WARNING] Failed to load config after update check (%d)...\n", ret);
+            }
+            else
+            {
+                log_msg(&cfg, 4, 0, "Config reloaded successfully...");
+
+#if defined(ENABLE_RL_PERCPU) || defined(ENABLE_RL_SKETCH)
+                // The RX queues are only detected on startup.
+                cfg.features.rl_percpu_scale = (cfg.rl_percpu_scale > 0) ? cfg.rl_percpu_scale : rx_queues;
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+                // The allow time is applied to the generated XDP program (the SYN cookie secret isn't reset by reloads).
+                cfg.features.syn_proxy_allow_time = cfg.syn_proxy_allow_time;
+
+                if (map_syn_proxy_ports > -1 && (ret = update_syn_proxy_ports(map_syn_proxy_ports, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update SYN proxy ports (%d)...", ret);
+                }
+#endif
+
+                // Make sure we set doing_stats properly.
+                if (!cfg.no_stats && !doing_stats)
+                {
+                    doing_stats = 1;
+                }
+                else if (cfg.no_stats && doing_stats)
+                {
+                    doing_stats = 0;
+                }
+
+#ifdef ENABLE_FILTERS
+                // Update filters.
+                update_filters(map_filters, &cfg);
+
+#ifdef ENABLE_FILTERS_BV
+                if ((ret = update_filters_bv(map_filters_bv, map_filters_bv_idx, map_filters_bv_lpm, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update bit-vector classifier maps (%d)...", ret);
+                }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+                if ((ret = update_filter_buckets(map_filter_buckets, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update filter buckets (%d)...", ret);
+                }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+                if ((ret = update_filters_tss(map_filters_tss, map_filters_tss_masks, &cfg)) != 0)
                 {
-                    log_msg(&cfg, 1, 0, "[WARNING] Failed to load config after update check (%d)...\n", ret);
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update exact match filters (%d)...", ret);
                 }
-                else
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+                // The counters are keyed by config index which may point to a different rule now.
+                if ((ret = reset_filter_stats(map_filter_stats)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to reset filter stats (%d)...", ret);
+                }
+#endif
+
+                // This also attaches the base XDP program again if code generation was disabled.
+                if ((ret = swap_codegen_prog(prog, &prog_active, &cfg, if_idx, cli.skb, cli.offload)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to generate XDP program from filter rules (%d). Keeping current XDP program...", ret);
+                }
+
+#ifdef ENABLE_TAIL_CALLS
+                if ((ret = update_pipeline(map_pipeline, prog_active, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update XDP program stages (%d)...", ret);
+                }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+                // Cached verdicts are only invalidated after the new filter rules are in place.
+                if ((ret = update_filters_cache(map_filters_cache_meta, &cfg)) != 0)
                 {
-                    log_msg(&cfg, 4, 0, "Config reloaded successfully...");
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update verdict cache generation (%d)...", ret);
+                }
+#endif
+#endif
+
+                // The stats update time may have changed.
+                if ((ret = set_timer_fd(timer_fd, get_tick_time(&cfg))) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update main loop timer (%d)...", ret);
+                }
+            }
+
+            // Update last check timer
+            last_config_check = time(NULL);
+        }
 
-                    // Make sure we set doing_stats properly.
-                    if (!cfg.no_stats && !doing_stats)
+        // Everything below only runs on timer ticks.
+        if (!tick)
+        {
+            continue;
+        }
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_STATS)
+        // Check for filter rule reordering.
+        if (cfg.reorder_time > 0 && (cur_time - last_reorder) > cfg.reorder_time)
+        {
+            log_msg(&cfg, 6, 0, "Reordering filter rules by hits...");
+
+#ifdef ENABLE_FILTER_LOGGING
+            lock_filters_rb();
+#endif
+
+            ret = reorder_filters(map_filter_stats, cpus, &cfg);
+
+#ifdef ENABLE_FILTER_LOGGING
+            unlock_filters_rb();
+#endif
+
+            if (ret < 0)
+            {
+                log_msg(&cfg, 1, 0, "[WARNING] Failed to reorder filter rules (%d)...", ret);
+            }
+            else if (ret > 0)
+            {
+                log_msg(&cfg, 3, 0, "Reordered filter rules by hits (%d swaps). Updating filters...", ret);
+
+                update_filters(map_filters, &cfg);
+
+#ifdef ENABLE_FILTERS_BV
+                if ((ret = update_filters_bv(map_filters_bv, map_filters_bv_idx, map_filters_bv_lpm, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update bit-vector classifier maps (%d)...", ret);
+                }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+                if ((ret = update_filter_buckets(map_filter_buckets, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update filter buckets (%d)...", ret);
+                }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+                if ((ret = update_filters_tss(map_filters_tss, map_filters_tss_masks, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update exact match filters (%d)...", ret);
+                }
+#endif
+
+                if (cfg.codegen)
+                {
+                    if ((ret = swap_codegen_prog(prog, &prog_active, &cfg, if_idx, cli.skb, cli.offload)) != 0)
                     {
-                        doing_stats = 1;
+                        log_msg(&cfg, 1, 0, "[WARNING] Failed to generate XDP program from filter rules (%d). Keeping current XDP program...", ret);
                     }
-                    else if (cfg.no_stats && doing_stats)
+
+#ifdef ENABLE_TAIL_CALLS
+                    if ((ret = update_pipeline(map_pipeline, prog_active, &cfg)) != 0)
                     {
-                        doing_stats = 0;
+                        log_msg(&cfg, 1, 0, "[WARNING] Failed to update XDP program stages (%d)...", ret);
                     }
-
-#ifdef ENABLE_FILTERS
-                    // Update filters.
-                    update_filters(map_filters, &cfg);
 #endif
                 }
 
-                // Update last check timer
-                last_config_check = time(NULL);
+#ifdef ENABLE_FILTERS_CACHE
+                if ((ret = update_filters_cache(map_filters_cache_meta, &cfg)) != 0)
+                {
+                    log_msg(&cfg, 1, 0, "[WARNING] Failed to update verdict cache generation (%d)...", ret);
+                }
+#endif
             }
 
-            // Update last updated variable.
-            last_update_check = time(NULL);
+            last_reorder = time(NULL);
         }
+#endif
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+        // Log the filter matches the XDP program didn't send to the ringbuffer.
+        if (map_filter_log_suppressed > -1 && cfg.log_flush_time > 0 && (cur_time - last_log_flush) >= cfg.log_flush_time)
+        {
+            if ((ret = flush_filter_log_suppressed(&cfg, map_filter_log_suppressed, cpus)) < 0)
+            {
+                log_msg(&cfg, 1, 0, "[WARNING] Failed to flush suppressed filter matches (%d)...", ret);
+            }
+
+            last_log_flush = time(NULL);
+        }
+#endif
+
+#ifdef ENABLE_BLOCK_SWEEP
+        // Remove expired blocks outside of the XDP program.
+        if (map_block > -1 && cfg.block_sweep_time > 0 && (cur_time - last_block_sweep) >= cfg.block_sweep_time)
+        {
+            if ((ret = sweep_blocks(map_block, map_block6)) < 0)
+            {
+                log_msg(&cfg, 1, 0, "[WARNING] Failed to remove expired blocks (%d)...", ret);
+            }
+            else if (ret > 0)
+            {
+                log_msg(&cfg, 5, 0, "Removed %d expired blocks...", ret);
+            }
+
+            last_block_sweep = time(NULL);
+        }
+#endif
+
+#ifdef ENABLE_BLOCK_BLOOM
+        // Rebuild the block bloom filter to drop the bits of expired and deleted blocks.
+        if (block_bloom && map_block > -1 && cfg.block_bloom_rebuild_time > 0 && (cur_time - last_block_bloom_rebuild) >= cfg.block_bloom_rebuild_time)
+        {
+            log_msg(&cfg, 6, 0, "Rebuilding block bloom filter...");
+
+            rebuild_block_bloom(block_bloom, map_block, map_block6);
+
+            last_block_bloom_rebuild = time(NULL);
+        }
+#endif
 
         // Calculate and display stats if enabled.
         if (!cfg.no_stats)
@@ -492,25 +1464,52 @@ int main(int argc, char *argv[])
                 log_msg(&cfg, 1, 0, "[WARNING] Failed to calculate packet stats. Stats map FD => %d...\n", map_stats);
             }
         }
-
-#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
-        poll_filters_rb(rb);
-#endif
-
-        usleep(sleep_time);
     }
 
     fprintf(stdout, "\n");
 
     log_msg(&cfg, 2, 0, "Cleaning up...");
 
+    // Close main loop event FDs.
+    if (cfg_watch_fd > -1)
+    {
+        close(cfg_watch_fd);
+    }
+
+    if (timer_fd > -1)
+    {
+        close(timer_fd);
+    }
+
+    if (epoll_fd > -1)
+    {
+        close(epoll_fd);
+    }
+
+    if (sig_fd > -1)
+    {
+        close(sig_fd);
+    }
+
 #if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
     if (rb)
     {
+        // This consumes the remaining filter log events before the ringbuffer is freed.
+        stop_filters_rb();
+
         ring_buffer__free(rb);
     }
 #endif
 
+#ifdef ENABLE_FILTER_INSPECT
+    // The inspection threads may still be adding blocks to the block bloom filter.
+    stop_inspect();
+#endif
+
+#ifdef ENABLE_BLOCK_BLOOM
+    munmap_block_bloom(block_bloom);
+#endif
+
     // Detach XDP program from interfaces.
     for (int i = 0; i < MAX_INTERFACES; i++)
     {
@@ -523,7 +1522,7 @@ int main(int argc, char *argv[])
 
         char* mode_used = NULL;
 
-        if (attach_xdp(prog, &mode_used, if_idx[i], 1, cli.skb, cli.offload))
+        if (attach_xdp(prog_active, &mode_used, if_idx[i], 1, cli.skb, cli.offload))
         {
             log_msg(&cfg, 0, 0, "[WARNING] Failed to detach XDP program from interface '%s'.\n", interface);
         }
@@ -539,7 +1538,12 @@ int main(int argc, char *argv[])
         unpin_needed_maps(&cfg, obj, 0);
     }
 
-    // Lastly, close the XDP program.
+    // Lastly, close the XDP program(s).
+    if (prog_active != prog)
+    {
+        xdp_program__close(prog_active);
+    }
+
     xdp_program__close(prog);
 
     log_msg(&cfg, 1, 0, "Exiting.\n");
@@ -0,0 +1,169 @@
+#include <loader/utils/bloom.h>
+
+#ifdef ENABLE_BLOCK_BLOOM
+/**
+ * Maps the block bloom filter BPF map into memory so bits can be set atomically alongside the XDP program.
+ * 
+ * @param map_block_bloom The block bloom filter map's FD.
+ * 
+ * @return A pointer to the bloom filter words or NULL on error.
+ */
+u64* mmap_block_bloom(int map_block_bloom)
+{
+    void* bloom = mmap(NULL, BLOCK_BLOOM_MAX_ENTRIES * sizeof(u64), PROT_READ | PROT_WRITE, MAP_SHARED, map_block_bloom, 0);
+
+    if (bloom == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    return bloom;
+}
+
+/**
+ * Unmaps the block bloom filter.
+ * 
+ * @param bloom A pointer to the bloom filter words.
+ * 
+ * @return void
+ */
+void munmap_block_bloom(u64* bloom)
+{
+    if (!bloom)
+    {
+        return;
+    }
+
+    munmap(bloom, BLOCK_BLOOM_MAX_ENTRIES * sizeof(u64));
+}
+
+/**
+ * Sets a block map key's bits inside of a single bloom filter copy.
+ * 
+ * @param words A pointer to the bloom filter copy.
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * 
+ * @return void
+ */
+static void set_block_bloom_bits(u64* words, const u32* key, int ipv6)
+{
+    u32 h1, h2;
+    get_block_bloom_hashes(key, ipv6, &h1, &h2);
+
+    for (int i = 0; i < BLOCK_BLOOM_HASHES; i++)
+    {
+        u32 bit = (h1 + (i * h2)) & (BLOCK_BLOOM_BITS - 1);
+
+        __atomic_fetch_or(&words[bit >> 6], 1ULL << (bit & 63), __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Adds a block map key to both bloom filter copies (the same as the XDP program does when blocking a source).
+ * 
+ * @param bloom A pointer to the bloom filter words.
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * 
+ * @return void
+ */
+void add_block_bloom(u64* bloom, const u32* key, int ipv6)
+{
+    set_block_bloom_bits(bloom, key, ipv6);
+    set_block_bloom_bits(bloom + BLOCK_BLOOM_WORDS, key, ipv6);
+}
+
+/**
+ * Adds a block map key to the pinned block bloom filter map (used by xdpfw-add).
+ * 
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * 
+ * @return 0 on success or a negative error value.
+ */
+int add_block_bloom_pin(const u32* key, int ipv6)
+{
+    int map_block_bloom = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_block_bloom");
+
+    if (map_block_bloom < 0)
+    {
+        return map_block_bloom;
+    }
+
+    u64* bloom = mmap_block_bloom(map_block_bloom);
+
+    if (!bloom)
+    {
+        return -errno;
+    }
+
+    add_block_bloom(bloom, key, ipv6);
+
+    munmap_block_bloom(bloom);
+
+    return 0;
+}
+
+/**
+ * Adds the block map entries that haven't expired to a bloom filter copy.
+ * 
+ * @param words A pointer to the bloom filter copy.
+ * @param map_block The block map's FD.
+ * @param ipv6 Whether the block map is the IPv6 block map.
+ * @param now The current time (nanoseconds).
+ * 
+ * @return void
+ */
+static void fill_block_bloom(u64* words, int map_block, int ipv6, u64 now)
+{
+    u128 key = 0;
+    u128 prev_key = 0;
+
+    void* prev = NULL;
+
+    u64 expires;
+
+    while (bpf_map_get_next_key(map_block, prev, &key) == 0)
+    {
+        if (bpf_map_lookup_elem(map_block, &key, &expires) == 0 && (expires == 0 || expires > now))
+        {
+            set_block_bloom_bits(words, (u32*)&key, ipv6);
+        }
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+}
+
+/**
+ * Rebuilds the inactive bloom filter copy from the block maps and makes it the active copy.
+ * 
+ * This drops the bits of expired and deleted blocks. Blocks added by the XDP program while rebuilding are either found when iterating the block maps or set in both copies afterwards.
+ * 
+ * @param bloom A pointer to the bloom filter words.
+ * @param map_block The IPv4 block map's FD.
+ * @param map_block6 The IPv6 block map's FD (ignored if below 0).
+ * 
+ * @return void
+ */
+void rebuild_block_bloom(u64* bloom, int map_block, int map_block6)
+{
+    u64 active = __atomic_load_n(&bloom[BLOCK_BLOOM_ACTIVE_IDX], __ATOMIC_ACQUIRE) & 1;
+
+    u64* words = bloom + ((active ^ 1) * BLOCK_BLOOM_WORDS);
+
+    memset(words, 0, BLOCK_BLOOM_WORDS * sizeof(u64));
+
+    u64 now = get_mono_nano_time();
+
+    fill_block_bloom(words, map_block, 0, now);
+
+    if (map_block6 > -1)
+    {
+        fill_block_bloom(words, map_block6, 1, now);
+    }
+
+    __atomic_store_n(&bloom[BLOCK_BLOOM_ACTIVE_IDX], active ^ 1, __ATOMIC_RELEASE);
+}
+#endif
\ No newline at end of file
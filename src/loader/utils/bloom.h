@@ -0,0 +1,20 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+#include <common/bloom.h>
+
+#include <errno.h>
+#include <sys/mman.h>
+
+#include <loader/utils/helpers.h>
+#include <loader/utils/xdp.h>
+
+#ifdef ENABLE_BLOCK_BLOOM
+u64* mmap_block_bloom(int map_block_bloom);
+void munmap_block_bloom(u64* bloom);
+void add_block_bloom(u64* bloom, const u32* key, int ipv6);
+int add_block_bloom_pin(const u32* key, int ipv6);
+void rebuild_block_bloom(u64* bloom, int map_block, int map_block6);
+#endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include <loader/utils/bucket.h>
+
+/**
+ * Retrieves a filter rule's destination port range.
+ *
+ * @param filter A pointer to the filter rule.
+ * @param min A pointer to store the minimum port in.
+ * @param max A pointer to store the maximum port in.
+ *
+ * @return void
+ */
+static void get_bucket_dport_range(filter_t* filter, u32* min, u32* max)
+{
+    *min = 0;
+    *max = 65535;
+
+    if (filter->tcp.enabled)
+    {
+        *min = filter->tcp.do_dport_min ? filter->tcp.dport_min : *min;
+        *max = filter->tcp.do_dport_max ? filter->tcp.dport_max : *max;
+    }
+    else if (filter->udp.enabled)
+    {
+        *min = filter->udp.do_dport_min ? filter->udp.dport_min : *min;
+        *max = filter->udp.do_dport_max ? filter->udp.dport_max : *max;
+    }
+}
+
+/**
+ * Fills out a bucket with every filter rule that may match its key (in rule order).
+ *
+ * @param bucket A pointer to the bucket.
+ * @param key A pointer to the bucket key.
+ * @param filters A pointer to the filter rules.
+ * @param cnt The amount of filter rules.
+ *
+ * @return void
+ */
+static void build_bucket(filter_bucket_t* bucket, filter_bucket_key_t* key, filter_t* filters, int cnt)
+{
+    bucket->cnt = 0;
+
+    for (int i = 0; i < cnt; i++)
+    {
+        filter_t* filter = &filters[i];
+
+        int proto = get_filter_protocol(filter);
+
+        // Rules without a protocol are inside of every bucket.
+        if (proto && proto != key->protocol)
+        {
+            continue;
+        }
+
+        u32 min, max;
+        get_bucket_dport_range(filter, &min, &max);
+
+        if (key->any_dport)
+        {
+            // Single port rules always have their own bucket which is used instead of the wildcard bucket.
+            if (min == max)
+            {
+                continue;
+            }
+        }
+        else if (key->dport < min || key->dport > max)
+        {
+            continue;
+        }
+
+        bucket->rules[bucket->cnt++] = i;
+    }
+}
+
+/**
+ * Deletes buckets that aren't used by the current filter rules anymore.
+ *
+ * @param map_filter_buckets The filter buckets BPF map FD.
+ * @param keys The bucket keys in use.
+ * @param keys_cnt The amount of bucket keys in use.
+ *
+ * @return void
+ */
+static void delete_stale_buckets(int map_filter_buckets, filter_bucket_key_t* keys, int keys_cnt)
+{
+    filter_bucket_key_t stale[FILTERS_BUCKETS_MAX_ENTRIES];
+    int stale_cnt = 0;
+
+    filter_bucket_key_t key;
+    filter_bucket_key_t prev_key;
+
+    void* prev = NULL;
+
+    // We can't delete while iterating since that would restart the iteration.
+    while (stale_cnt < FILTERS_BUCKETS_MAX_ENTRIES && bpf_map_get_next_key(map_filter_buckets, prev, &key) == 0)
+    {
+        int found = 0;
+
+        for (int i = 0; i < keys_cnt; i++)
+        {
+            if (memcmp(&keys[i], &key, sizeof(key)) == 0)
+            {
+                found = 1;
+
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            stale[stale_cnt++] = key;
+        }
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+
+    for (int i = 0; i < stale_cnt; i++)
+    {
+        bpf_map_delete_elem(map_filter_buckets, &stale[i]);
+    }
+}
+
+/**
+ * Rebuilds the protocol/destination port filter rule buckets from the current filter rules.
+ *
+ * @param map_filter_buckets The filter buckets BPF map FD.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return 0 on success, -ENOSPC if a single port rule doesn't fit into the filter buckets map, or error value of bpf_map_update_elem().
+ */
+int update_filter_buckets(int map_filter_buckets, config__t* cfg)
+{
+    int ret = 0;
+
+    filter_t* filters = calloc(MAX_FILTERS, sizeof(filter_t));
+    filter_bucket_t* bucket = calloc(1, sizeof(filter_bucket_t));
+
+    if (!filters || !bucket)
+    {
+        ret = -ENOMEM;
+
+        goto out;
+    }
+
+    int cnt = build_filters(cfg, filters);
+
+    // The wildcard buckets are always inserted, followed by a bucket for each single destination port used by TCP and UDP rules.
+    filter_bucket_key_t keys[FILTERS_BUCKETS_MAX_ENTRIES];
+    memset(keys, 0, sizeof(keys));
+
+    int keys_cnt = 0;
+
+    keys[keys_cnt].protocol = IPPROTO_TCP;
+    keys[keys_cnt++].any_dport = 1;
+
+    keys[keys_cnt].protocol = IPPROTO_UDP;
+    keys[keys_cnt++].any_dport = 1;
+
+    keys[keys_cnt].protocol = IPPROTO_ICMP;
+    keys[keys_cnt++].any_dport = 1;
+
+    for (int i = 0; i < cnt; i++)
+    {
+        int proto = get_filter_protocol(&filters[i]);
+
+        if (proto != IPPROTO_TCP && proto != IPPROTO_UDP)
+        {
+            continue;
+        }
+
+        u32 min, max;
+        get_bucket_dport_range(&filters[i], &min, &max);
+
+        if (min != max)
+        {
+            continue;
+        }
+
+        int dup = 0;
+
+        for (int j = 0; j < keys_cnt; j++)
+        {
+            if (keys[j].protocol == proto && !keys[j].any_dport && keys[j].dport == min)
+            {
+                dup = 1;
+
+                break;
+            }
+        }
+
+        if (dup)
+        {
+            continue;
+        }
+
+        // Leaving the rule out of its bucket would make the XDP program skip it for this port, so fail instead.
+        if (keys_cnt >= FILTERS_BUCKETS_MAX_ENTRIES)
+        {
+            fprintf(stderr, "[WARNING] Failed to add a bucket for filter rule #%u (port %u) since the filter buckets map is full (%d)...\n", filters[i].id + 1, min, FILTERS_BUCKETS_MAX_ENTRIES);
+
+            ret = -ENOSPC;
+
+            goto out;
+        }
+
+        keys[keys_cnt].protocol = proto;
+        keys[keys_cnt++].dport = min;
+    }
+
+    for (int i = 0; i < keys_cnt; i++)
+    {
+        build_bucket(bucket, &keys[i], filters, cnt);
+
+        if ((ret = bpf_map_update_elem(map_filter_buckets, &keys[i], bucket, BPF_ANY)) != 0)
+        {
+            goto out;
+        }
+    }
+
+    delete_stale_buckets(map_filter_buckets, keys, keys_cnt);
+
+    out:
+        free(filters);
+        free(bucket);
+
+        return ret;
+}
\ No newline at end of file
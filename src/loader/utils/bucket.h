@@ -0,0 +1,12 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+
+int update_filter_buckets(int map_filter_buckets, config__t* cfg);
\ No newline at end of file
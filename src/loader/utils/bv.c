@@ -0,0 +1,659 @@
+#include <loader/utils/bv.h>
+
+/**
+ * Sets a filter rule's bit inside of a bitmap.
+ *
+ * @param bv A pointer to the bitmap.
+ * @param idx The filter rule index.
+ *
+ * @return void
+ */
+static void set_bv_bit(filter_bv_t* bv, int idx)
+{
+    bv->words[idx / 64] |= (1ULL << (idx % 64));
+}
+
+/**
+ * Checks whether a TCP flags byte matches a filter rule's TCP flag settings.
+ *
+ * @param tcp A pointer to the filter rule's TCP settings.
+ * @param flags The TCP flags byte (CWR, ECE, URG, ACK, PSH, RST, SYN, FIN).
+ *
+ * @return 1 on match or 0 otherwise.
+ */
+static int match_bv_tcp_flags(filter_tcp_t* tcp, u8 flags)
+{
+    if (tcp->do_fin && tcp->fin != ((flags >> 0) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_syn && tcp->syn != ((flags >> 1) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_rst && tcp->rst != ((flags >> 2) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_psh && tcp->psh != ((flags >> 3) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_ack && tcp->ack != ((flags >> 4) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_urg && tcp->urg != ((flags >> 5) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_ece && tcp->ece != ((flags >> 6) & 1))
+    {
+        return 0;
+    }
+
+    if (tcp->do_cwr && tcp->cwr != ((flags >> 7) & 1))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Builds the protocol bitmaps.
+ *
+ * @param bvs A pointer to the bitmaps.
+ * @param filters A pointer to the filter rules.
+ * @param cnt The amount of filter rules.
+ *
+ * @return void
+ */
+static void build_bv_protos(filter_bv_t* bvs, filter_t* filters, int cnt)
+{
+    static const int protos[] = { IPPROTO_TCP, IPPROTO_UDP, IPPROTO_ICMP };
+
+    for (int i = 0; i < cnt; i++)
+    {
+        filter_t* filter = &filters[i];
+
+        int proto = get_filter_protocol(filter);
+
+        int v4 = 1;
+        int v6 = 1;
+
+#if defined(ENABLE_IPV6) && defined(ALLOW_SINGLE_IP_V4_V6)
+        // Rules with IPv6 addresses are ignored for IPv4 packets and vice versa.
+        if (filter->ip.src_cidr6 || filter->ip.dst_cidr6)
+        {
+            v4 = 0;
+        }
+
+        if (filter->ip.src_ip != 0 || filter->ip.dst_ip != 0)
+        {
+            v6 = 0;
+        }
+#endif
+
+        for (int j = 0; j < FILTERS_BV_PROTO_MAX; j++)
+        {
+            int is_v6 = j >= FILTERS_BV_PROTO_TCP6;
+
+            if ((is_v6 && !v6) || (!is_v6 && !v4))
+            {
+                continue;
+            }
+
+            if (proto && proto != protos[j % FILTERS_BV_PROTO_TCP6])
+            {
+                continue;
+            }
+
+            set_bv_bit(&bvs[FILTERS_BV_OFF_PROTO + j], i);
+        }
+    }
+}
+
+/**
+ * Builds the bitmaps of single byte fields (TTL, TOS, TCP flags, ICMP type, and ICMP code).
+ *
+ * @param bvs A pointer to the bitmaps.
+ * @param filters A pointer to the filter rules.
+ * @param cnt The amount of filter rules.
+ *
+ * @return void
+ */
+static void build_bv_bytes(filter_bv_t* bvs, filter_t* filters, int cnt)
+{
+    for (int v = 0; v < 256; v++)
+    {
+        for (int i = 0; i < cnt; i++)
+        {
+            filter_t* filter = &filters[i];
+
+            int proto = get_filter_protocol(filter);
+
+            // TTL (hop limit for IPv6).
+            if ((!filter->ip.do_min_ttl || filter->ip.min_ttl <= v) && (!filter->ip.do_max_ttl || filter->ip.max_ttl >= v))
+            {
+                set_bv_bit(&bvs[FILTERS_BV_OFF_TTL + v], i);
+            }
+
+            // TOS (IPv4 only).
+            if (!filter->ip.do_tos || filter->ip.tos == v)
+            {
+                set_bv_bit(&bvs[FILTERS_BV_OFF_TOS + v], i);
+            }
+
+            // TCP flags.
+            if (proto != IPPROTO_TCP || match_bv_tcp_flags(&filter->tcp, v))
+            {
+                set_bv_bit(&bvs[FILTERS_BV_OFF_TCP_FLAGS + v], i);
+            }
+
+            // ICMP type.
+            if (proto != IPPROTO_ICMP || !filter->icmp.do_type || filter->icmp.type == v)
+            {
+                set_bv_bit(&bvs[FILTERS_BV_OFF_ICMP_TYPE + v], i);
+            }
+
+            // ICMP code.
+            if (proto != IPPROTO_ICMP || !filter->icmp.do_code || filter->icmp.code == v)
+            {
+                set_bv_bit(&bvs[FILTERS_BV_OFF_ICMP_CODE + v], i);
+            }
+        }
+    }
+}
+
+/**
+ * Retrieves a filter rule's source or destination port range.
+ *
+ * @param filter A pointer to the filter rule.
+ * @param dst Whether to retrieve the destination port range.
+ * @param min A pointer to store the minimum port in.
+ * @param max A pointer to store the maximum port in.
+ *
+ * @return void
+ */
+static void get_bv_port_range(filter_t* filter, int dst, u32* min, u32* max)
+{
+    *min = 0;
+    *max = 65535;
+
+    if (filter->tcp.enabled)
+    {
+        if (dst)
+        {
+            *min = filter->tcp.do_dport_min ? filter->tcp.dport_min : *min;
+            *max = filter->tcp.do_dport_max ? filter->tcp.dport_max : *max;
+        }
+        else
+        {
+            *min = filter->tcp.do_sport_min ? filter->tcp.sport_min : *min;
+            *max = filter->tcp.do_sport_max ? filter->tcp.sport_max : *max;
+        }
+    }
+    else if (filter->udp.enabled)
+    {
+        if (dst)
+        {
+            *min = filter->udp.do_dport_min ? filter->udp.dport_min : *min;
+            *max = filter->udp.do_dport_max ? filter->udp.dport_max : *max;
+        }
+        else
+        {
+            *min = filter->udp.do_sport_min ? filter->udp.sport_min : *min;
+            *max = filter->udp.do_sport_max ? filter->udp.sport_max : *max;
+        }
+    }
+}
+
+/**
+ * Splits a 16-bit field into elementary intervals and builds a bitmap for each interval along with the value to interval index mapping.
+ *
+ * @param bvs A pointer to the first bitmap of the field's segment.
+ * @param idxs A pointer to the first entry of the field's index segment.
+ * @param mins The minimum value of each filter rule.
+ * @param maxs The maximum value of each filter rule.
+ * @param cnt The amount of filter rules.
+ *
+ * @return void
+ */
+static void build_bv_intervals(filter_bv_t* bvs, u16* idxs, u32* mins, u32* maxs, int cnt)
+{
+    u8 starts[65536] = {0};
+    starts[0] = 1;
+
+    for (int i = 0; i < cnt; i++)
+    {
+        starts[mins[i]] = 1;
+
+        if (maxs[i] < 65535)
+        {
+            starts[maxs[i] + 1] = 1;
+        }
+    }
+
+    int cur = -1;
+
+    for (u32 v = 0; v < 65536; v++)
+    {
+        // Every value inside of an interval matches the same rules, so only compute the bitmap once.
+        if (starts[v])
+        {
+            cur++;
+
+            for (int i = 0; i < cnt; i++)
+            {
+                if (mins[i] <= v && v <= maxs[i])
+                {
+                    set_bv_bit(&bvs[cur], i);
+                }
+            }
+        }
+
+        idxs[v] = cur;
+    }
+}
+
+/**
+ * Masks an IP address (network byte order) to a CIDR.
+ *
+ * @param ip The IP address (one word for IPv4 and four words for IPv6).
+ * @param cidr The CIDR.
+ * @param out Where to store the masked IP address (four words).
+ *
+ * @return void
+ */
+static void mask_bv_ip(u32* ip, int cidr, u32* out)
+{
+    for (int w = 0; w < 4; w++)
+    {
+        int bits = cidr - (w * 32);
+
+        if (bits <= 0)
+        {
+            out[w] = 0;
+        }
+        else if (bits >= 32)
+        {
+            out[w] = ip[w];
+        }
+        else
+        {
+            out[w] = ip[w] & htonl(0xFFFFFFFFu << (32 - bits));
+        }
+    }
+}
+
+/**
+ * Retrieves a filter rule's prefix for an IP field.
+ *
+ * @param filter A pointer to the filter rule.
+ * @param field The LPM field (FILTERS_BV_LPM_*).
+ * @param prefix A pointer to store the prefix in (a CIDR of 0 means the rule doesn't check the field).
+ *
+ * @return void
+ */
+static void get_bv_prefix(filter_t* filter, u32 field, bv_prefix_t* prefix)
+{
+    u32 ip[4] = {0};
+
+    memset(prefix, 0, sizeof(*prefix));
+
+    switch (field)
+    {
+        case FILTERS_BV_LPM_SRC_IP:
+            ip[0] = filter->ip.src_ip;
+
+            prefix->cidr = ip[0] ? filter->ip.src_cidr : 0;
+
+            break;
+
+        case FILTERS_BV_LPM_DST_IP:
+            ip[0] = filter->ip.dst_ip;
+
+            prefix->cidr = ip[0] ? filter->ip.dst_cidr : 0;
+
+            break;
+
+#ifdef ENABLE_IPV6
+        case FILTERS_BV_LPM_SRC_IP6:
+            memcpy(ip, filter->ip.src_ip6, sizeof(ip));
+
+            prefix->cidr = filter->ip.src_cidr6;
+
+            break;
+
+        case FILTERS_BV_LPM_DST_IP6:
+            memcpy(ip, filter->ip.dst_ip6, sizeof(ip));
+
+            prefix->cidr = filter->ip.dst_cidr6;
+
+            break;
+#endif
+    }
+
+    if (field < FILTERS_BV_LPM_SRC_IP6 && prefix->cidr > 32)
+    {
+        prefix->cidr = 32;
+    }
+
+    mask_bv_ip(ip, prefix->cidr, prefix->ip);
+}
+
+/**
+ * Builds the prefix bitmaps of an IP field along with the LPM trie entries pointing to them.
+ *
+ * @param bvs A pointer to the bitmaps.
+ * @param off The field's segment offset inside of the bitmaps.
+ * @param field The LPM field (FILTERS_BV_LPM_*).
+ * @param prefixes The prefix of each filter rule.
+ * @param cnt The amount of filter rules.
+ * @param keys Where to store the LPM keys.
+ * @param slots Where to store the bitmap slot of each LPM key.
+ * @param keys_cnt A pointer to the amount of LPM keys.
+ *
+ * @return void
+ */
+static void build_bv_prefixes(filter_bv_t* bvs, u32 off, u32 field, bv_prefix_t* prefixes, int cnt, filter_bv_lpm_key_t* keys, u32* slots, int* keys_cnt)
+{
+    bv_prefix_t uniq[MAX_FILTERS];
+    int uniq_cnt = 0;
+
+    // The first slot contains the rules that don't check the field and is used when no other prefix matches.
+    for (int i = 0; i < cnt; i++)
+    {
+        if (!prefixes[i].cidr)
+        {
+            set_bv_bit(&bvs[off], i);
+        }
+    }
+
+    filter_bv_lpm_key_t key = {0};
+    key.prefix_len = 32;
+    key.field = field;
+
+    keys[*keys_cnt] = key;
+    slots[(*keys_cnt)++] = off;
+
+    for (int i = 0; i < cnt; i++)
+    {
+        bv_prefix_t* prefix = &prefixes[i];
+
+        if (!prefix->cidr)
+        {
+            continue;
+        }
+
+        int dup = 0;
+
+        for (int j = 0; j < uniq_cnt; j++)
+        {
+            if (uniq[j].cidr == prefix->cidr && memcmp(uniq[j].ip, prefix->ip, sizeof(prefix->ip)) == 0)
+            {
+                dup = 1;
+
+                break;
+            }
+        }
+
+        if (dup)
+        {
+            continue;
+        }
+
+        uniq[uniq_cnt++] = *prefix;
+
+        u32 slot = off + uniq_cnt;
+
+        // The longest matching prefix is contained by every other rule prefix that matches the packet.
+        for (int j = 0; j < cnt; j++)
+        {
+            bv_prefix_t* other = &prefixes[j];
+
+            if (!other->cidr)
+            {
+                set_bv_bit(&bvs[slot], j);
+
+                continue;
+            }
+
+            if (other->cidr > prefix->cidr)
+            {
+                continue;
+            }
+
+            u32 masked[4];
+            mask_bv_ip(prefix->ip, other->cidr, masked);
+
+            if (memcmp(masked, other->ip, sizeof(masked)) == 0)
+            {
+                set_bv_bit(&bvs[slot], j);
+            }
+        }
+
+        memset(&key, 0, sizeof(key));
+        key.prefix_len = 32 + prefix->cidr;
+        key.field = field;
+        memcpy(key.ip, prefix->ip, sizeof(key.ip));
+
+        keys[*keys_cnt] = key;
+        slots[(*keys_cnt)++] = slot;
+    }
+}
+
+/**
+ * Deletes LPM trie entries that aren't used by the current filter rules anymore.
+ *
+ * @param map_lpm The bit-vector LPM trie BPF map FD.
+ * @param keys The LPM keys in use.
+ * @param keys_cnt The amount of LPM keys in use.
+ *
+ * @return void
+ */
+static void delete_bv_stale_prefixes(int map_lpm, filter_bv_lpm_key_t* keys, int keys_cnt)
+{
+    filter_bv_lpm_key_t* stale = calloc(FILTERS_BV_MAX_PREFIXES * FILTERS_BV_LPM_MAX, sizeof(filter_bv_lpm_key_t));
+
+    if (!stale)
+    {
+        return;
+    }
+
+    int stale_cnt = 0;
+
+    filter_bv_lpm_key_t key;
+    filter_bv_lpm_key_t prev_key;
+
+    void* prev = NULL;
+
+    // We can't delete while iterating since that would restart the iteration.
+    while (stale_cnt < FILTERS_BV_MAX_PREFIXES * FILTERS_BV_LPM_MAX && bpf_map_get_next_key(map_lpm, prev, &key) == 0)
+    {
+        int found = 0;
+
+        for (int i = 0; i < keys_cnt; i++)
+        {
+            if (memcmp(&keys[i], &key, sizeof(key)) == 0)
+            {
+                found = 1;
+
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            stale[stale_cnt++] = key;
+        }
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+
+    for (int i = 0; i < stale_cnt; i++)
+    {
+        bpf_map_delete_elem(map_lpm, &stale[i]);
+    }
+
+    free(stale);
+}
+
+/**
+ * Writes every entry of a BPF array map.
+ *
+ * @param map The BPF map FD.
+ * @param values A pointer to the values.
+ * @param value_size The size of a single value.
+ * @param cnt The amount of values.
+ *
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+static int update_bv_array(int map, void* values, size_t value_size, u32 cnt)
+{
+    u32* keys = calloc(cnt, sizeof(u32));
+
+    if (!keys)
+    {
+        return -ENOMEM;
+    }
+
+    for (u32 i = 0; i < cnt; i++)
+    {
+        keys[i] = i;
+    }
+
+    u32 count = cnt;
+
+    int ret = bpf_map_update_batch(map, keys, values, &count, NULL);
+
+    // Batch operations require a newer kernel, so fall back to updating each element.
+    if (ret != 0)
+    {
+        for (u32 i = 0; i < cnt; i++)
+        {
+            if ((ret = bpf_map_update_elem(map, &keys[i], (u8*)values + (i * value_size), BPF_ANY)) != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    free(keys);
+
+    return ret;
+}
+
+/**
+ * Rebuilds the bit-vector classifier maps from the current filter rules.
+ *
+ * @param map_filters_bv The bit-vector BPF map FD.
+ * @param map_filters_bv_idx The bit-vector interval index BPF map FD.
+ * @param map_filters_bv_lpm The bit-vector LPM trie BPF map FD.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return 0 on success or error value of the failed BPF map operation.
+ */
+int update_filters_bv(int map_filters_bv, int map_filters_bv_idx, int map_filters_bv_lpm, config__t* cfg)
+{
+    int ret = 0;
+
+    filter_t* filters = calloc(MAX_FILTERS, sizeof(filter_t));
+    filter_bv_t* bvs = calloc(FILTERS_BV_MAX_ENTRIES, sizeof(filter_bv_t));
+    u16* idxs = calloc(FILTERS_BV_IDX_MAX_ENTRIES, sizeof(u16));
+    bv_prefix_t* prefixes = calloc(MAX_FILTERS, sizeof(bv_prefix_t));
+    filter_bv_lpm_key_t* keys = calloc(FILTERS_BV_MAX_PREFIXES * FILTERS_BV_LPM_MAX, sizeof(filter_bv_lpm_key_t));
+    u32* slots = calloc(FILTERS_BV_MAX_PREFIXES * FILTERS_BV_LPM_MAX, sizeof(u32));
+
+    if (!filters || !bvs || !idxs || !prefixes || !keys || !slots)
+    {
+        ret = -ENOMEM;
+
+        goto out;
+    }
+
+    int cnt = build_filters(cfg, filters);
+
+    build_bv_protos(bvs, filters, cnt);
+    build_bv_bytes(bvs, filters, cnt);
+
+    // Source ports, destination ports, and packet lengths.
+    u32 mins[MAX_FILTERS];
+    u32 maxs[MAX_FILTERS];
+
+    for (int i = 0; i < cnt; i++)
+    {
+        get_bv_port_range(&filters[i], 0, &mins[i], &maxs[i]);
+    }
+
+    build_bv_intervals(&bvs[FILTERS_BV_OFF_SPORT], &idxs[FILTERS_BV_IDX_SPORT], mins, maxs, cnt);
+
+    for (int i = 0; i < cnt; i++)
+    {
+        get_bv_port_range(&filters[i], 1, &mins[i], &maxs[i]);
+    }
+
+    build_bv_intervals(&bvs[FILTERS_BV_OFF_DPORT], &idxs[FILTERS_BV_IDX_DPORT], mins, maxs, cnt);
+
+    for (int i = 0; i < cnt; i++)
+    {
+        mins[i] = filters[i].ip.do_min_len ? filters[i].ip.min_len : 0;
+        maxs[i] = filters[i].ip.do_max_len ? filters[i].ip.max_len : 65535;
+    }
+
+    build_bv_intervals(&bvs[FILTERS_BV_OFF_LEN], &idxs[FILTERS_BV_IDX_LEN], mins, maxs, cnt);
+
+    // Source and destination IP addresses.
+    static const u32 lpm_offs[FILTERS_BV_LPM_MAX] = { FILTERS_BV_OFF_SRC_IP, FILTERS_BV_OFF_DST_IP, FILTERS_BV_OFF_SRC_IP6, FILTERS_BV_OFF_DST_IP6 };
+
+    int keys_cnt = 0;
+
+    for (u32 field = 0; field < FILTERS_BV_LPM_MAX; field++)
+    {
+        for (int i = 0; i < cnt; i++)
+        {
+            get_bv_prefix(&filters[i], field, &prefixes[i]);
+        }
+
+        build_bv_prefixes(bvs, lpm_offs[field], field, prefixes, cnt, keys, slots, &keys_cnt);
+    }
+
+    // The LPM trie points to bitmap slots, so the bitmaps need to be written first.
+    if ((ret = update_bv_array(map_filters_bv, bvs, sizeof(filter_bv_t), FILTERS_BV_MAX_ENTRIES)) != 0)
+    {
+        goto out;
+    }
+
+    if ((ret = update_bv_array(map_filters_bv_idx, idxs, sizeof(u16), FILTERS_BV_IDX_MAX_ENTRIES)) != 0)
+    {
+        goto out;
+    }
+
+    for (int i = 0; i < keys_cnt; i++)
+    {
+        if ((ret = bpf_map_update_elem(map_filters_bv_lpm, &keys[i], &slots[i], BPF_ANY)) != 0)
+        {
+            goto out;
+        }
+    }
+
+    delete_bv_stale_prefixes(map_filters_bv_lpm, keys, keys_cnt);
+
+    out:
+        free(filters);
+        free(bvs);
+        free(idxs);
+        free(prefixes);
+        free(keys);
+        free(slots);
+
+        return ret;
+}
\ No newline at end of file
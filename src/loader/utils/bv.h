@@ -0,0 +1,18 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+
+struct bv_prefix
+{
+    u32 ip[4];
+    int cidr;
+} typedef bv_prefix_t;
+
+int update_filters_bv(int map_filters_bv, int map_filters_bv_idx, int map_filters_bv_lpm, config__t* cfg);
\ No newline at end of file
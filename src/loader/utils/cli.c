@@ -17,6 +17,8 @@ const struct option opts[] =
     { "no-stats", required_argument, NULL, 'n' },
     { "stats-ps", required_argument, NULL, 1 },
     { "stdout-ut", required_argument, NULL, 2 },
+    { "reorder-time", required_argument, NULL, 3 },
+    { "codegen", required_argument, NULL, 4 },
 
     { NULL, 0, NULL, 0 }
 };
@@ -106,6 +108,16 @@ void parse_cli(cli_t *cli, int argc, char *argv[])
                 
                 break;
 
+            case 3:
+                cli->reorder_time = atoi(optarg);
+
+                break;
+
+            case 4:
+                cli->codegen = atoi(optarg);
+
+                break;
+
             case '?':
                 fprintf(stderr, "Missing argument option...\n");
 
@@ -21,6 +21,8 @@ struct cli
     int no_stats;
     int stats_per_second;
     int stdout_update_time;
+    int reorder_time;
+    int codegen;
 } typedef cli_t;
 
 void parse_cli(cli_t *cli, int argc, char *argv[]);
\ No newline at end of file
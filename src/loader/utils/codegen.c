@@ -0,0 +1,419 @@
+#include <loader/utils/codegen.h>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Only fields that are set are written since the compiler treats missing fields as zero.
+#define CODEGEN_FIELD(fp, filter, field) \
+    if ((filter)->field) \
+    { \
+        fprintf(fp, "            ." #field " = %llu,\n", (unsigned long long)(filter)->field); \
+    }
+
+/**
+ * Writes a filter rule as a constant filter rule structure to the generated source file.
+ * 
+ * @param fp The generated source file.
+ * @param filter A pointer to the filter rule.
+ * 
+ * @return void
+ */
+static void write_codegen_filter(FILE* fp, filter_t* filter)
+{
+    CODEGEN_FIELD(fp, filter, set);
+    CODEGEN_FIELD(fp, filter, log);
+    CODEGEN_FIELD(fp, filter, enabled);
+    CODEGEN_FIELD(fp, filter, action);
+    CODEGEN_FIELD(fp, filter, block_time);
+
+#ifdef ENABLE_FILTER_LOGGING
+    CODEGEN_FIELD(fp, filter, sample_rate);
+    CODEGEN_FIELD(fp, filter, sample_pps);
+#endif
+
+#ifdef ENABLE_RL_IP
+    CODEGEN_FIELD(fp, filter, do_ip_pps);
+    CODEGEN_FIELD(fp, filter, ip_pps);
+    CODEGEN_FIELD(fp, filter, do_ip_bps);
+    CODEGEN_FIELD(fp, filter, ip_bps);
+#endif
+
+#ifdef ENABLE_RL_FLOW
+    CODEGEN_FIELD(fp, filter, do_flow_pps);
+    CODEGEN_FIELD(fp, filter, flow_pps);
+    CODEGEN_FIELD(fp, filter, do_flow_bps);
+    CODEGEN_FIELD(fp, filter, flow_bps);
+#endif
+
+#ifdef ENABLE_FILTER_POLICE
+    CODEGEN_FIELD(fp, filter, police_flow);
+    CODEGEN_FIELD(fp, filter, police_rate);
+    CODEGEN_FIELD(fp, filter, police_burst);
+#endif
+
+#ifdef ENABLE_VLAN
+    CODEGEN_FIELD(fp, filter, do_vlan_id);
+    CODEGEN_FIELD(fp, filter, vlan_id);
+#endif
+
+    // IP header.
+    CODEGEN_FIELD(fp, filter, ip.src_ip);
+    CODEGEN_FIELD(fp, filter, ip.src_cidr);
+    CODEGEN_FIELD(fp, filter, ip.dst_ip);
+    CODEGEN_FIELD(fp, filter, ip.dst_cidr);
+
+#ifdef ENABLE_IPV6
+    for (int i = 0; i < 4; i++)
+    {
+        if (filter->ip.src_ip6[i])
+        {
+            fprintf(fp, "            .ip.src_ip6[%d] = %u,\n", i, filter->ip.src_ip6[i]);
+        }
+
+        if (filter->ip.dst_ip6[i])
+        {
+            fprintf(fp, "            .ip.dst_ip6[%d] = %u,\n", i, filter->ip.dst_ip6[i]);
+        }
+    }
+
+    CODEGEN_FIELD(fp, filter, ip.src_cidr6);
+    CODEGEN_FIELD(fp, filter, ip.dst_cidr6);
+#endif
+
+    CODEGEN_FIELD(fp, filter, ip.do_min_ttl);
+    CODEGEN_FIELD(fp, filter, ip.min_ttl);
+    CODEGEN_FIELD(fp, filter, ip.do_max_ttl);
+    CODEGEN_FIELD(fp, filter, ip.max_ttl);
+    CODEGEN_FIELD(fp, filter, ip.do_min_len);
+    CODEGEN_FIELD(fp, filter, ip.min_len);
+    CODEGEN_FIELD(fp, filter, ip.do_max_len);
+    CODEGEN_FIELD(fp, filter, ip.max_len);
+    CODEGEN_FIELD(fp, filter, ip.do_tos);
+    CODEGEN_FIELD(fp, filter, ip.tos);
+    CODEGEN_FIELD(fp, filter, ip.do_frag);
+    CODEGEN_FIELD(fp, filter, ip.frag);
+
+    // TCP header.
+    CODEGEN_FIELD(fp, filter, tcp.enabled);
+    CODEGEN_FIELD(fp, filter, tcp.do_sport_min);
+    CODEGEN_FIELD(fp, filter, tcp.sport_min);
+    CODEGEN_FIELD(fp, filter, tcp.do_sport_max);
+    CODEGEN_FIELD(fp, filter, tcp.sport_max);
+    CODEGEN_FIELD(fp, filter, tcp.do_dport_min);
+    CODEGEN_FIELD(fp, filter, tcp.dport_min);
+    CODEGEN_FIELD(fp, filter, tcp.do_dport_max);
+    CODEGEN_FIELD(fp, filter, tcp.dport_max);
+    CODEGEN_FIELD(fp, filter, tcp.do_urg);
+    CODEGEN_FIELD(fp, filter, tcp.urg);
+    CODEGEN_FIELD(fp, filter, tcp.do_ack);
+    CODEGEN_FIELD(fp, filter, tcp.ack);
+    CODEGEN_FIELD(fp, filter, tcp.do_rst);
+    CODEGEN_FIELD(fp, filter, tcp.rst);
+    CODEGEN_FIELD(fp, filter, tcp.do_psh);
+    CODEGEN_FIELD(fp, filter, tcp.psh);
+    CODEGEN_FIELD(fp, filter, tcp.do_syn);
+    CODEGEN_FIELD(fp, filter, tcp.syn);
+    CODEGEN_FIELD(fp, filter, tcp.do_fin);
+    CODEGEN_FIELD(fp, filter, tcp.fin);
+    CODEGEN_FIELD(fp, filter, tcp.do_ece);
+    CODEGEN_FIELD(fp, filter, tcp.ece);
+    CODEGEN_FIELD(fp, filter, tcp.do_cwr);
+    CODEGEN_FIELD(fp, filter, tcp.cwr);
+
+    // UDP header.
+    CODEGEN_FIELD(fp, filter, udp.enabled);
+    CODEGEN_FIELD(fp, filter, udp.do_sport_min);
+    CODEGEN_FIELD(fp, filter, udp.sport_min);
+    CODEGEN_FIELD(fp, filter, udp.do_sport_max);
+    CODEGEN_FIELD(fp, filter, udp.sport_max);
+    CODEGEN_FIELD(fp, filter, udp.do_dport_min);
+    CODEGEN_FIELD(fp, filter, udp.dport_min);
+    CODEGEN_FIELD(fp, filter, udp.do_dport_max);
+    CODEGEN_FIELD(fp, filter, udp.dport_max);
+
+    // ICMP header.
+    CODEGEN_FIELD(fp, filter, icmp.enabled);
+    CODEGEN_FIELD(fp, filter, icmp.do_code);
+    CODEGEN_FIELD(fp, filter, icmp.code);
+    CODEGEN_FIELD(fp, filter, icmp.do_type);
+    CODEGEN_FIELD(fp, filter, icmp.type);
+
+    CODEGEN_FIELD(fp, filter, id);
+}
+
+/**
+ * Writes the current filter rules as straight-line C code that is included by the XDP program when FILTERS_CODEGEN is defined.
+ * 
+ * @param path The path to the generated source file.
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return 0 on success or a negative errno value on error.
+ */
+int write_codegen_rules(const char* path, config__t* cfg)
+{
+    int ret = 0;
+
+    filter_t* filters = calloc(MAX_FILTERS, sizeof(filter_t));
+
+    if (!filters)
+    {
+        return -ENOMEM;
+    }
+
+    int cnt = build_filters(cfg, filters);
+
+    FILE* fp = fopen(path, "w");
+
+    if (!fp)
+    {
+        ret = -errno;
+
+        goto out;
+    }
+
+    fprintf(fp, "// Generated by xdpfw from the current filter rules. Do not edit.\n\n");
+    fprintf(fp, "static __always_inline void process_rules_gen(rule_ctx_t* ctx)\n");
+    fprintf(fp, "{\n");
+
+    for (int i = 0; i < cnt; i++)
+    {
+        filter_t* filter = &filters[i];
+
+        fprintf(fp, "    // Rule #%d.\n", i);
+        fprintf(fp, "    {\n");
+
+#ifdef ENABLE_FILTERS_TSS
+        fprintf(fp, "        if (%d >= ctx->max_idx)\n", i);
+        fprintf(fp, "        {\n");
+        fprintf(fp, "            return;\n");
+        fprintf(fp, "        }\n\n");
+#endif
+
+        // The rule is a constant, so the compiler removes the checks for fields that aren't set.
+        fprintf(fp, "        filter_t filter =\n");
+        fprintf(fp, "        {\n");
+
+        write_codegen_filter(fp, filter);
+
+        fprintf(fp, "        };\n\n");
+
+        fprintf(fp, "        if (match_rule(&filter, ctx))\n");
+        fprintf(fp, "        {\n");
+        fprintf(fp, "            set_rule_matched(&filter, ctx, %d);\n\n", i);
+        fprintf(fp, "            return;\n");
+        fprintf(fp, "        }\n");
+        fprintf(fp, "    }\n\n");
+    }
+
+    fprintf(fp, "}");
+
+    if (fclose(fp) != 0)
+    {
+        ret = -errno;
+    }
+
+    out:
+        free(filters);
+
+        return ret;
+}
+
+/**
+ * Compiles the XDP program with the generated filter rules.
+ * 
+ * @param inc_dir The directory containing the generated source file.
+ * @param obj_path The path to store the BPF object file at.
+ * 
+ * @return 0 on success, the compiler's exit code, or a negative errno value on error.
+ */
+int compile_codegen_prog(const char* inc_dir, const char* obj_path)
+{
+    char cmd[1024];
+
+    snprintf(cmd, sizeof(cmd), CODEGEN_CC " -I %s -I %s -I /usr/include -I /usr/local/include -D FILTERS_CODEGEN -g -O3 -ffast-math -target bpf -c -o %s %s/xdp/prog.c", CODEGEN_SRC_DIR, inc_dir, obj_path, CODEGEN_SRC_DIR);
+
+    int ret = system(cmd);
+
+    if (ret == -1)
+    {
+        return -errno;
+    }
+
+    if (!WIFEXITED(ret))
+    {
+        return -ECHILD;
+    }
+
+    return WEXITSTATUS(ret);
+}
+
+/**
+ * Opens the generated XDP program and makes it share the BPF maps of the base XDP program.
+ * 
+ * @param base A pointer to the base XDP program (must be loaded already).
+ * @param obj_path The path to the generated BPF object file.
+ * 
+ * @return XDP program structure (pointer) or NULL.
+ */
+struct xdp_program* load_codegen_prog(struct xdp_program* base, const char* obj_path)
+{
+    struct xdp_program* prog = load_bpf_obj(obj_path);
+
+    if (!prog)
+    {
+        return NULL;
+    }
+
+    struct bpf_object* obj = get_bpf_obj(prog);
+    struct bpf_object* base_obj = get_bpf_obj(base);
+
+    struct bpf_map* map;
+
+    bpf_object__for_each_map(map, obj)
+    {
+        // Internal maps (.rodata, .bss, etc.) belong to the program itself.
+        if (bpf_map__is_internal(map))
+        {
+            continue;
+        }
+
+        struct bpf_map* base_map = bpf_object__find_map_by_name(base_obj, bpf_map__name(map));
+
+        if (!base_map || bpf_map__fd(base_map) < 0)
+        {
+            continue;
+        }
+
+        // Counters, block lists, and rate limits carry over since both programs use the same maps.
+        if (bpf_map__reuse_fd(map, bpf_map__fd(base_map)) != 0)
+        {
+            xdp_program__close(prog);
+
+            return NULL;
+        }
+    }
+
+    return prog;
+}
+
+/**
+ * Attaches a new XDP program to every interface the current program is attached to and detaches the current program afterwards.
+ * 
+ * @param old A pointer to the current XDP program.
+ * @param new A pointer to the new XDP program.
+ * @param if_idx The interface indexes (0 = not attached).
+ * @param force_skb If set, forces the XDP program to run in SKB mode.
+ * @param force_offload If set, forces the XDP program to run in offload mode.
+ * 
+ * @return 0 on success or 1 on error (the current program stays attached).
+ */
+static int swap_prog(struct xdp_program* old, struct xdp_program* new, int* if_idx, int force_skb, int force_offload)
+{
+    char* mode_used = NULL;
+
+    // The new program is attached first so packets are never left unfiltered.
+    for (int i = 0; i < MAX_INTERFACES; i++)
+    {
+        if (if_idx[i] < 1)
+        {
+            continue;
+        }
+
+        if (attach_xdp(new, &mode_used, if_idx[i], 0, force_skb, force_offload) != 0)
+        {
+            for (int j = 0; j < i; j++)
+            {
+                if (if_idx[j] > 0)
+                {
+                    attach_xdp(new, &mode_used, if_idx[j], 1, force_skb, force_offload);
+                }
+            }
+
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (int i = 0; i < MAX_INTERFACES; i++)
+    {
+        if (if_idx[i] < 1)
+        {
+            continue;
+        }
+
+        attach_xdp(old, &mode_used, if_idx[i], 1, force_skb, force_offload);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Generates, compiles, and attaches an XDP program specialized for the current filter rules. If code generation is disabled, the base XDP program is attached again instead.
+ * 
+ * @param base A pointer to the base XDP program.
+ * @param active A pointer to the XDP program that is currently attached (updated on success).
+ * @param cfg A pointer to the config structure.
+ * @param if_idx The interface indexes (0 = not attached).
+ * @param force_skb If set, forces the XDP program to run in SKB mode.
+ * @param force_offload If set, forces the XDP program to run in offload mode.
+ * 
+ * @return 0 on success or a non-zero value on error (the current program stays attached).
+ */
+int swap_codegen_prog(struct xdp_program* base, struct xdp_program** active, config__t* cfg, int* if_idx, int force_skb, int force_offload)
+{
+    int ret;
+
+    struct xdp_program* prog = base;
+
+    if (cfg->codegen)
+    {
+        if (mkdir(CODEGEN_DIR, 0755) != 0 && errno != EEXIST)
+        {
+            return -errno;
+        }
+
+        if ((ret = write_codegen_rules(CODEGEN_RULES_PATH, cfg)) != 0)
+        {
+            return ret;
+        }
+
+        if ((ret = compile_codegen_prog(CODEGEN_DIR, CODEGEN_OBJ_PATH)) != 0)
+        {
+            return ret;
+        }
+
+        if ((prog = load_codegen_prog(base, CODEGEN_OBJ_PATH)) == NULL)
+        {
+            return -EINVAL;
+        }
+
+        if ((ret = set_rodata_var(prog, "features", &cfg->features, sizeof(cfg->features))) != 0)
+        {
+            xdp_program__close(prog);
+
+            return ret;
+        }
+    }
+    else if (*active == base)
+    {
+        return 0;
+    }
+
+    if ((ret = swap_prog(*active, prog, if_idx, force_skb, force_offload)) != 0)
+    {
+        if (prog != base)
+        {
+            xdp_program__close(prog);
+        }
+
+        return ret;
+    }
+
+    if (*active != base)
+    {
+        xdp_program__close(*active);
+    }
+
+    *active = prog;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+
+#define CODEGEN_DIR "/etc/xdpfw/codegen"
+#define CODEGEN_SRC_DIR "/etc/xdpfw/src"
+#define CODEGEN_RULES_PATH CODEGEN_DIR "/rules_gen.c"
+#define CODEGEN_OBJ_PATH CODEGEN_DIR "/xdp_prog_gen.o"
+#define CODEGEN_CC "clang"
+
+int write_codegen_rules(const char* path, config__t* cfg);
+int compile_codegen_prog(const char* rules_path, const char* obj_path);
+struct xdp_program* load_codegen_prog(struct xdp_program* base, const char* obj_path);
+int swap_codegen_prog(struct xdp_program* base, struct xdp_program** active, config__t* cfg, int* if_idx, int force_skb, int force_offload);
\ No newline at end of file
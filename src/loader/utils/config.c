@@ -360,12 +360,162 @@ int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides)
         }
     }
 
+    // Get filter reorder time.
+    int reorder_time;
+
+    if (config_lookup_int(&conf, "reorder_time", &reorder_time) == CONFIG_TRUE || (overrides && overrides->reorder_time > -1))
+    {
+        if (overrides && overrides->reorder_time > -1)
+        {
+            cfg->reorder_time = overrides->reorder_time;
+        }
+        else
+        {
+            cfg->reorder_time = reorder_time;
+        }
+    }
+
+    // Get code generation.
+    int codegen;
+
+    if (config_lookup_bool(&conf, "codegen", &codegen) == CONFIG_TRUE || (overrides && overrides->codegen > -1))
+    {
+        if (overrides && overrides->codegen > -1)
+        {
+            cfg->codegen = overrides->codegen;
+        }
+        else
+        {
+            cfg->codegen = codegen;
+        }
+    }
+
+    // Get IPv6 feature.
+    int enable_ipv6;
+
+    if (config_lookup_bool(&conf, "enable_ipv6", &enable_ipv6) == CONFIG_TRUE)
+    {
+        cfg->features.ipv6 = enable_ipv6;
+    }
+
+    // Get IP rate limiting feature.
+    int enable_rl_ip;
+
+    if (config_lookup_bool(&conf, "enable_rl_ip", &enable_rl_ip) == CONFIG_TRUE)
+    {
+        cfg->features.rl_ip = enable_rl_ip;
+    }
+
+    // Get flow rate limiting feature.
+    int enable_rl_flow;
+
+    if (config_lookup_bool(&conf, "enable_rl_flow", &enable_rl_flow) == CONFIG_TRUE)
+    {
+        cfg->features.rl_flow = enable_rl_flow;
+    }
+
+    // Get filter logging feature.
+    int enable_filter_logging;
+
+    if (config_lookup_bool(&conf, "enable_filter_logging", &enable_filter_logging) == CONFIG_TRUE)
+    {
+        cfg->features.filter_logging = enable_filter_logging;
+    }
+
+    // Get filter stats feature.
+    int enable_filter_stats;
+
+    if (config_lookup_bool(&conf, "enable_filter_stats", &enable_filter_stats) == CONFIG_TRUE)
+    {
+        cfg->features.filter_stats = enable_filter_stats;
+    }
+
+    // Get stats on block map feature.
+    int stats_on_block_map;
+
+    if (config_lookup_bool(&conf, "stats_on_block_map", &stats_on_block_map) == CONFIG_TRUE)
+    {
+        cfg->features.stats_on_block_map = stats_on_block_map;
+    }
+
+    // Get stats on IP range drop map feature.
+    int stats_on_ip_range_drop_map;
+
+    if (config_lookup_bool(&conf, "stats_on_ip_range_drop_map", &stats_on_ip_range_drop_map) == CONFIG_TRUE)
+    {
+        cfg->features.stats_on_ip_range_drop_map = stats_on_ip_range_drop_map;
+    }
+
+    // Get per-CPU rate limit scale.
+    int rl_percpu_scale;
+
+    if (config_lookup_int(&conf, "rl_percpu_scale", &rl_percpu_scale) == CONFIG_TRUE)
+    {
+        cfg->rl_percpu_scale = rl_percpu_scale;
+    }
+
+    // Get block sweep time.
+    int block_sweep_time;
+
+    if (config_lookup_int(&conf, "block_sweep_time", &block_sweep_time) == CONFIG_TRUE)
+    {
+        cfg->block_sweep_time = block_sweep_time;
+    }
+
+    // Get block bloom filter rebuild time.
+    int block_bloom_rebuild_time;
+
+    if (config_lookup_int(&conf, "block_bloom_rebuild_time", &block_bloom_rebuild_time) == CONFIG_TRUE)
+    {
+        cfg->block_bloom_rebuild_time = block_bloom_rebuild_time;
+    }
+
+    // Get SYN proxy allow time.
+    int syn_proxy_allow_time;
+
+    if (config_lookup_int(&conf, "syn_proxy_allow_time", &syn_proxy_allow_time) == CONFIG_TRUE)
+    {
+        cfg->syn_proxy_allow_time = syn_proxy_allow_time;
+    }
+
+    // Get inspect block time.
+    int inspect_block_time;
+
+    if (config_lookup_int(&conf, "inspect_block_time", &inspect_block_time) == CONFIG_TRUE)
+    {
+        cfg->inspect_block_time = inspect_block_time;
+    }
+
+    // Get suppressed filter log flush time.
+    int log_flush_time;
+
+    if (config_lookup_int(&conf, "log_flush_time", &log_flush_time) == CONFIG_TRUE)
+    {
+        cfg->log_flush_time = log_flush_time;
+    }
+
+    // Get filter log thread CPU.
+    int log_thread_cpu;
+
+    if (config_lookup_int(&conf, "log_thread_cpu", &log_thread_cpu) == CONFIG_TRUE)
+    {
+        cfg->log_thread_cpu = log_thread_cpu;
+    }
+
+    // Get filter log busy poll.
+    int log_busy_poll;
+
+    if (config_lookup_bool(&conf, "log_busy_poll", &log_busy_poll) == CONFIG_TRUE)
+    {
+        cfg->log_busy_poll = log_busy_poll;
+    }
+
     // Read filters.
     setting = config_lookup(&conf, "filters");
 
     if (setting && config_setting_is_list(setting))
     {
-        for (int i = 0; i < config_setting_length(setting); i++)
+        for (int i = 0; i < config_setting_length(setting) && i < MAX_CFG_FILTERS; i++)
         {
             filter_rule_cfg_t* filter = &cfg->filters[i];
 
@@ -415,6 +565,22 @@ int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides)
                 filter->block_time = block_time;
             }
 
+            // Log sample rate (not required).
+            int sample_rate;
+
+            if (config_setting_lookup_int(filter_cfg, "sample_rate", &sample_rate) == CONFIG_TRUE)
+            {
+                filter->sample_rate = sample_rate;
+            }
+
+            // Log sample PPS (not required).
+            int sample_pps;
+
+            if (config_setting_lookup_int(filter_cfg, "sample_pps", &sample_pps) == CONFIG_TRUE)
+            {
+                filter->sample_pps = sample_pps;
+            }
+
             // IP PPS (not required).
             s64 ip_pps;
 
@@ -447,6 +613,46 @@ int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides)
                 filter->flow_bps = flow_bps;
             }
 
+            // Police rate (required with the police action).
+            s64 police_rate;
+
+            if (config_setting_lookup_int64(filter_cfg, "police_rate", &police_rate) == CONFIG_TRUE)
+            {
+                filter->police_rate = police_rate;
+            }
+
+            // Police burst (not required).
+            s64 police_burst;
+
+            if (config_setting_lookup_int64(filter_cfg, "police_burst", &police_burst) == CONFIG_TRUE)
+            {
+                filter->police_burst = police_burst;
+            }
+
+            // Police flow (not required).
+            int police_flow;
+
+            if (config_setting_lookup_bool(filter_cfg, "police_flow", &police_flow) == CONFIG_TRUE)
+            {
+                filter->police_flow = police_flow;
+            }
+
+            // Police rules without a rate have an empty token bucket and would drop every matching packet.
+            if (filter->action == FILTER_ACTION_POLICE && filter->police_rate < 1)
+            {
+                log_msg(cfg, 1, 0, "[WARNING] Filter rule #%d uses the police action without a 'police_rate'. Disabling filter rule...", i + 1);
+
+                filter->enabled = 0;
+            }
+
+            // VLAN ID (not required).
+            int vlan_id;
+
+            if (config_setting_lookup_int(filter_cfg, "vlan_id", &vlan_id) == CONFIG_TRUE)
+            {
+                filter->vlan_id = vlan_id;
+            }
+
             /* IP Options */
 
             // Source IP (not required).
@@ -521,6 +727,19 @@ int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides)
                 filter->ip.tos = tos;
             }
 
+            // Fragment (not required).
+            int frag;
+
+            if (config_setting_lookup_int(filter_cfg, "fragment", &frag) == CONFIG_TRUE)
+            {
+                filter->ip.frag = frag;
+            }
+            else if (config_setting_lookup_bool(filter_cfg, "fragment", &frag) == CONFIG_TRUE)
+            {
+                // Older configs use a bool that matches non-first fragments.
+                filter->ip.frag = frag ? IP_FRAG_LATER : IP_FRAG_NONE;
+            }
+
             /* TCP options */
 
             // Enabled.
@@ -769,6 +988,81 @@ int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides)
         }
     }
 
+    // Read IPv6 range drops.
+    setting = config_lookup(&conf, "ip_drop_ranges6");
+
+    if (setting && config_setting_is_list(setting))
+    {
+        for (int i = 0; i < config_setting_length(setting) && i < MAX_IP_RANGES; i++)
+        {
+            if (cfg->drop_ranges6[i])
+            {
+                free(cfg->drop_ranges6[i]);
+                cfg->drop_ranges6[i] = NULL;
+            }
+
+            const char* new_range = config_setting_get_string_elem(setting, i);
+
+            if (!new_range)
+            {
+                continue;
+            }
+
+            cfg->drop_ranges6[i] = strdup(new_range);
+
+            cfg->drop_ranges6_cnt++;
+        }
+    }
+
+    // Read SYN proxy ports.
+    setting = config_lookup(&conf, "syn_proxy_ports");
+
+    if (setting && config_setting_is_list(setting))
+    {
+        cfg->syn_proxy_ports_cnt = 0;
+
+        for (int i = 0; i < config_setting_length(setting) && cfg->syn_proxy_ports_cnt < MAX_SYN_PROXY_PORTS; i++)
+        {
+            int port = config_setting_get_int_elem(setting, i);
+
+            if (port < 1 || port > 65535)
+            {
+                continue;
+            }
+
+            cfg->syn_proxy_ports[cfg->syn_proxy_ports_cnt++] = port;
+        }
+    }
+
+    // Read inspect patterns.
+    setting = config_lookup(&conf, "inspect_patterns");
+
+    if (setting && config_setting_is_list(setting))
+    {
+        for (int i = 0; i < MAX_INSPECT_PATTERNS; i++)
+        {
+            if (cfg->inspect_patterns[i])
+            {
+                free(cfg->inspect_patterns[i]);
+                cfg->inspect_patterns[i] = NULL;
+            }
+        }
+
+        cfg->inspect_patterns_cnt = 0;
+
+        for (int i = 0; i < config_setting_length(setting) && cfg->inspect_patterns_cnt < MAX_INSPECT_PATTERNS; i++)
+        {
+            const char* pattern = config_setting_get_string_elem(setting, i);
+
+            if (!pattern || !pattern[0] || strlen(pattern) > MAX_INSPECT_PATTERN_LEN)
+            {
+                continue;
+            }
+
+            cfg->inspect_patterns[cfg->inspect_patterns_cnt++] = strdup(pattern);
+        }
+    }
+
     config_destroy(&conf);
 
     return EXIT_SUCCESS;
@@ -855,12 +1149,80 @@ int save_cfg(config__t* cfg, const char* file_path)
     setting = config_setting_add(root, "stdout_update_time", CONFIG_TYPE_INT);
     config_setting_set_int(setting, cfg->stdout_update_time);
 
+    // Add filter reorder time.
+    setting = config_setting_add(root, "reorder_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->reorder_time);
+
+    // Add code generation.
+    setting = config_setting_add(root, "codegen", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->codegen);
+
+    // Add IPv6 feature.
+    setting = config_setting_add(root, "enable_ipv6", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.ipv6);
+
+    // Add IP rate limiting feature.
+    setting = config_setting_add(root, "enable_rl_ip", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.rl_ip);
+
+    // Add flow rate limiting feature.
+    setting = config_setting_add(root, "enable_rl_flow", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.rl_flow);
+
+    // Add filter logging feature.
+    setting = config_setting_add(root, "enable_filter_logging", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.filter_logging);
+
+    // Add filter stats feature.
+    setting = config_setting_add(root, "enable_filter_stats", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.filter_stats);
+
+    // Add stats on block map feature.
+    setting = config_setting_add(root, "stats_on_block_map", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.stats_on_block_map);
+
+    // Add stats on IP range drop map feature.
+    setting = config_setting_add(root, "stats_on_ip_range_drop_map", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->features.stats_on_ip_range_drop_map);
+
+    // Add per-CPU rate limit scale.
+    setting = config_setting_add(root, "rl_percpu_scale", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->rl_percpu_scale);
+
+    // Add block sweep time.
+    setting = config_setting_add(root, "block_sweep_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->block_sweep_time);
+
+    // Add block bloom filter rebuild time.
+    setting = config_setting_add(root, "block_bloom_rebuild_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->block_bloom_rebuild_time);
+
+    // Add SYN proxy allow time.
+    setting = config_setting_add(root, "syn_proxy_allow_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->syn_proxy_allow_time);
+
+    // Add inspect block time.
+    setting = config_setting_add(root, "inspect_block_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->inspect_block_time);
+
+    // Add suppressed filter log flush time.
+    setting = config_setting_add(root, "log_flush_time", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->log_flush_time);
+
+    // Add filter log thread CPU.
+    setting = config_setting_add(root, "log_thread_cpu", CONFIG_TYPE_INT);
+    config_setting_set_int(setting, cfg->log_thread_cpu);
+
+    // Add filter log busy poll.
+    setting = config_setting_add(root, "log_busy_poll", CONFIG_TYPE_BOOL);
+    config_setting_set_bool(setting, cfg->log_busy_poll);
+
     // Add filters.
     config_setting_t* filters = config_setting_add(root, "filters", CONFIG_TYPE_LIST);
 
     if (filters)
     {
-        for (int i = 0; i < MAX_FILTERS; i++)
+        for (int i = 0; i < MAX_CFG_FILTERS; i++)
         {
             filter_rule_cfg_t* filter = &cfg->filters[i];
 
@@ -901,6 +1263,20 @@ int save_cfg(config__t* cfg, const char* file_path)
                     config_setting_set_int(block_time, filter->block_time);
                 }
 
+                // Add log sample rate.
+                if (filter->sample_rate > -1)
+                {
+                    config_setting_t* sample_rate = config_setting_add(filter_cfg, "sample_rate", CONFIG_TYPE_INT);
+                    config_setting_set_int(sample_rate, filter->sample_rate);
+                }
+
+                // Add log sample PPS.
+                if (filter->sample_pps > -1)
+                {
+                    config_setting_t* sample_pps = config_setting_add(filter_cfg, "sample_pps", CONFIG_TYPE_INT);
+                    config_setting_set_int(sample_pps, filter->sample_pps);
+                }
+
                 // Add IP PPS.
                 if (filter->ip_pps > -1)
                 {
@@ -929,6 +1305,34 @@ int save_cfg(config__t* cfg, const char* file_path)
                     config_setting_set_int64(bps, filter->flow_bps);
                 }
 
+                // Add police rate.
+                if (filter->police_rate > -1)
+                {
+                    config_setting_t* police_rate = config_setting_add(filter_cfg, "police_rate", CONFIG_TYPE_INT64);
+                    config_setting_set_int64(police_rate, filter->police_rate);
+                }
+
+                // Add police burst.
+                if (filter->police_burst > -1)
+                {
+                    config_setting_t* police_burst = config_setting_add(filter_cfg, "police_burst", CONFIG_TYPE_INT64);
+                    config_setting_set_int64(police_burst, filter->police_burst);
+                }
+
+                // Add police flow.
+                if (filter->police_flow > 0)
+                {
+                    config_setting_t* police_flow = config_setting_add(filter_cfg, "police_flow", CONFIG_TYPE_BOOL);
+                    config_setting_set_bool(police_flow, filter->police_flow);
+                }
+
+                // Add VLAN ID.
+                if (filter->vlan_id > -1)
+                {
+                    config_setting_t* vlan_id = config_setting_add(filter_cfg, "vlan_id", CONFIG_TYPE_INT);
+                    config_setting_set_int(vlan_id, filter->vlan_id);
+                }
+
                 // Add source IPv4.
                 if (filter->ip.src_ip)
                 {
@@ -992,6 +1396,13 @@ int save_cfg(config__t* cfg, const char* file_path)
                     config_setting_set_int(tos, filter->ip.tos);
                 }
 
+                // Add fragment.
+                if (filter->ip.frag > -1)
+                {
+                    config_setting_t* frag = config_setting_add(filter_cfg, "fragment", CONFIG_TYPE_INT);
+                    config_setting_set_int(frag, filter->ip.frag);
+                }
+
 
                 // Add TCP enabled.
                 if (filter->tcp.enabled > -1)
@@ -1136,6 +1547,59 @@ int save_cfg(config__t* cfg, const char* file_path)
         }
     }
 
+    // Add IPv6 ranges.
+    config_setting_t* ip_drop_ranges6 = config_setting_add(root, "ip_drop_ranges6", CONFIG_TYPE_LIST);
+
+    if (ip_drop_ranges6)
+    {
+        for (int i = 0; i < MAX_IP_RANGES; i++)
+        {
+            const char* range = cfg->drop_ranges6[i];
+
+            if (range)
+            {
+                config_setting_t* elem = config_setting_add(ip_drop_ranges6, NULL, CONFIG_TYPE_STRING);
+
+                if (elem)
+                {
+                    config_setting_set_string(elem, range);
+                }
+            }
+        }
+    }
+
+    // Add SYN proxy ports.
+    config_setting_t* syn_proxy_ports = config_setting_add(root, "syn_proxy_ports", CONFIG_TYPE_LIST);
+
+    if (syn_proxy_ports)
+    {
+        for (int i = 0; i < cfg->syn_proxy_ports_cnt; i++)
+        {
+            config_setting_t* elem = config_setting_add(syn_proxy_ports, NULL, CONFIG_TYPE_INT);
+
+            if (elem)
+            {
+                config_setting_set_int(elem, cfg->syn_proxy_ports[i]);
+            }
+        }
+    }
+
+    // Add inspect patterns.
+    config_setting_t* inspect_patterns = config_setting_add(root, "inspect_patterns", CONFIG_TYPE_LIST);
+
+    if (inspect_patterns)
+    {
+        for (int i = 0; i < cfg->inspect_patterns_cnt; i++)
+        {
+            config_setting_t* elem = config_setting_add(inspect_patterns, NULL, CONFIG_TYPE_STRING);
+
+            if (elem)
+            {
+                config_setting_set_string(elem, cfg->inspect_patterns[i]);
+            }
+        }
+    }
+
     // Write config to file.
     file = fopen(file_path, "w");
 
@@ -1171,11 +1635,20 @@ void set_filter_defaults(filter_rule_cfg_t* filter)
     filter->action = 1;
     filter->block_time = 1;
 
+    filter->sample_rate = -1;
+    filter->sample_pps = -1;
+
     filter->ip_pps = -1;
     filter->ip_bps = -1;
     filter->flow_pps = -1;
     filter->flow_bps = -1;
 
+    filter->police_rate = -1;
+    filter->police_burst = -1;
+    filter->police_flow = 0;
+
+    filter->vlan_id = -1;
+
     if (filter->ip.src_ip)
     {
         free(filter->ip.src_ip);
@@ -1211,6 +1684,7 @@ void set_filter_defaults(filter_rule_cfg_t* filter)
     filter->ip.max_len = -1;
 
     filter->ip.tos = -1;
+    filter->ip.frag = -1;
 
     filter->tcp.enabled = -1;
 
@@ -1273,6 +1747,27 @@ void set_cfg_defaults(config__t* cfg)
     cfg->no_stats = 0;
     cfg->stats_per_second = 0;
     cfg->stdout_update_time = 1000;
+    cfg->reorder_time = 0;
+    cfg->codegen = 0;
+
+    cfg->features.ipv6 = 1;
+    cfg->features.rl_ip = 1;
+    cfg->features.rl_flow = 1;
+    cfg->features.filter_logging = 1;
+    cfg->features.filter_stats = 1;
+    cfg->features.stats_on_block_map = 1;
+    cfg->features.stats_on_ip_range_drop_map = 1;
+    cfg->features.rl_percpu_scale = 1;
+
+    cfg->rl_percpu_scale = 0;
+    cfg->block_sweep_time = 5;
+    cfg->block_bloom_rebuild_time = 60;
+    cfg->syn_proxy_allow_time = 300;
+    cfg->inspect_block_time = 60;
+    cfg->log_flush_time = 10;
+    cfg->log_thread_cpu = -1;
+    cfg->log_busy_poll = 0;
+    cfg->syn_proxy_ports_cnt = 0;
 
     if (cfg->log_file)
     {
@@ -1301,11 +1796,13 @@ void set_cfg_defaults(config__t* cfg)
 
     cfg->filters_cnt = 0;
 
-    for (int i = 0; i < MAX_FILTERS; i++)
+    for (int i = 0; i < MAX_CFG_FILTERS; i++)
     {
         filter_rule_cfg_t* filter = &cfg->filters[i];
 
         set_filter_defaults(filter);
+
+        filter->id = i;
     }
 
     cfg->drop_ranges_cnt = 0;
@@ -1323,6 +1820,38 @@ void set_cfg_defaults(config__t* cfg)
 
         cfg->drop_ranges[i] = NULL;
     }
+
+    cfg->drop_ranges6_cnt = 0;
+
+    for (int i = 0; i < MAX_IP_RANGES; i++)
+    {
+        char* drop_range = cfg->drop_ranges6[i];
+
+        if (!drop_range)
+        {
+            continue;
+        }
+
+        free(drop_range);
+
+        cfg->drop_ranges6[i] = NULL;
+    }
+
+    cfg->inspect_patterns_cnt = 0;
+
+    for (int i = 0; i < MAX_INSPECT_PATTERNS; i++)
+    {
+        char* pattern = cfg->inspect_patterns[i];
+
+        if (!pattern)
+        {
+            continue;
+        }
+
+        free(pattern);
+
+        cfg->inspect_patterns[i] = NULL;
+    }
 }
 
 /**
@@ -1337,16 +1866,23 @@ void print_filter(filter_rule_cfg_t* filter, int idx)
 {
     printf("\tFilter #%d\n", idx);
     printf("\t\tEnabled => %d\n", filter->enabled);
-    printf("\t\tLog => %d\n\n", filter->log);
+    printf("\t\tLog => %d\n", filter->log);
+    printf("\t\tSample Rate => %d\n", filter->sample_rate);
+    printf("\t\tSample PPS => %d\n\n", filter->sample_pps);
 
-    printf("\t\tAction => %d (0 = Block, 1 = Allow)\n", filter->action);
-    printf("\t\tBlock Time => %d\n\n", filter->block_time);
+    printf("\t\tAction => %d (0 = Block, 1 = Allow, 2 = Police, 3 = Inspect)\n", filter->action);
+    printf("\t\tBlock Time => %d\n", filter->block_time);
+    printf("\t\tVLAN ID => %d\n\n", filter->vlan_id);
 
     printf("\t\tIP PPS => %lld\n", filter->ip_pps);
     printf("\t\tIP BPS => %lld\n", filter->ip_bps);
 
     printf("\t\tFlow PPS => %lld\n", filter->flow_pps);
-    printf("\t\tFlow BPS => %lld\n", filter->flow_bps);
+    printf("\t\tFlow BPS => %lld\n\n", filter->flow_bps);
+
+    printf("\t\tPolice Rate => %lld\n", filter->police_rate);
+    printf("\t\tPolice Burst => %lld\n", filter->police_burst);
+    printf("\t\tPolice Flow => %d\n", filter->police_flow);
 
     printf("\t\tMin Packet Length => %d\n", filter->ip.min_len);
     printf("\t\tMax Packet Length => %d\n\n", filter->ip.max_len);
@@ -1390,7 +1926,8 @@ void print_filter(filter_rule_cfg_t* filter, int idx)
     printf("\t\t\tMin TTL => %d\n", filter->ip.min_ttl);
     printf("\t\t\tMax TTL => %d\n", filter->ip.max_ttl);
 
-    printf("\t\t\tTOS => %d\n\n", filter->ip.tos);
+    printf("\t\t\tTOS => %d\n", filter->ip.tos);
+    printf("\t\t\tFragment => %d\n\n", filter->ip.frag);
 
     // TCP Options.
     const char* tcp_sport = "N/A";
@@ -1474,7 +2011,26 @@ void print_cfg(config__t* cfg)
     printf("\tUpdate Time => %d\n", cfg->update_time);
     printf("\tNo Stats => %d\n", cfg->no_stats);
     printf("\tStats Per Second => %d\n", cfg->stats_per_second);
-    printf("\tStdout Update Time => %d\n\n", cfg->stdout_update_time);
+    printf("\tStdout Update Time => %d\n", cfg->stdout_update_time);
+    printf("\tReorder Time => %d\n", cfg->reorder_time);
+    printf("\tCode Generation => %d\n\n", cfg->codegen);
+
+    printf("Features\n");
+    printf("\tIPv6 => %d\n", cfg->features.ipv6);
+    printf("\tIP Rate Limiting => %d\n", cfg->features.rl_ip);
+    printf("\tFlow Rate Limiting => %d\n", cfg->features.rl_flow);
+    printf("\tFilter Logging => %d\n", cfg->features.filter_logging);
+    printf("\tFilter Stats => %d\n", cfg->features.filter_stats);
+    printf("\tStats On Block Map => %d\n", cfg->features.stats_on_block_map);
+    printf("\tStats On IP Range Drop Map => %d\n", cfg->features.stats_on_ip_range_drop_map);
+    printf("\tPer-CPU Rate Limit Scale => %d\n", cfg->rl_percpu_scale);
+    printf("\tBlock Sweep Time => %d\n", cfg->block_sweep_time);
+    printf("\tBlock Bloom Rebuild Time => %d\n", cfg->block_bloom_rebuild_time);
+    printf("\tSYN Proxy Allow Time => %d\n", cfg->syn_proxy_allow_time);
+    printf("\tInspect Block Time => %d\n", cfg->inspect_block_time);
+    printf("\tLog Flush Time => %d\n", cfg->log_flush_time);
+    printf("\tLog Thread CPU => %d\n", cfg->log_thread_cpu);
+    printf("\tLog Busy Poll => %d\n\n", cfg->log_busy_poll);
 
     printf("Interfaces\n");
     
@@ -1544,6 +2100,55 @@ void print_cfg(config__t* cfg)
     {
         printf("\t- None\n");
     }
+
+    printf("\nIPv6 Drop Ranges\n");
+
+    if (cfg->drop_ranges6_cnt > 0)
+    {
+        for (int i = 0; i < cfg->drop_ranges6_cnt; i++)
+        {
+            const char* range = cfg->drop_ranges6[i];
+    
+            if (!range)
+            {
+                continue;
+            }
+
+            printf("\t- %s\n", range);
+        }
+    }
+    else
+    {
+        printf("\t- None\n");
+    }
+
+    printf("\nSYN Proxy Ports\n");
+
+    if (cfg->syn_proxy_ports_cnt > 0)
+    {
+        for (int i = 0; i < cfg->syn_proxy_ports_cnt; i++)
+        {
+            printf("\t- %d\n", cfg->syn_proxy_ports[i]);
+        }
+    }
+    else
+    {
+        printf("\t- None\n");
+    }
+
+    printf("\nInspect Patterns\n");
+
+    if (cfg->inspect_patterns_cnt > 0)
+    {
+        for (int i = 0; i < cfg->inspect_patterns_cnt; i++)
+        {
+            printf("\t- %s\n", cfg->inspect_patterns[i]);
+        }
+    }
+    else
+    {
+        printf("\t- None\n");
+    }
 }
 
 /**
@@ -1555,7 +2160,7 @@ void print_cfg(config__t* cfg)
  */
 int get_next_filter_idx(config__t* cfg)
 {
-    for (int i = 0; i < MAX_FILTERS; i++)
+    for (int i = 0; i < MAX_CFG_FILTERS; i++)
     {
         filter_rule_cfg_t* filter = &cfg->filters[i];
 
@@ -1570,6 +2175,29 @@ int get_next_filter_idx(config__t* cfg)
     return -1;
 }
 
+/**
+ * Retrieves a filter rule by its config index (the rule's ID which stays the same when rules are reordered).
+ * 
+ * @param cfg A pointer to the config structure.
+ * @param id The filter rule's ID.
+ * 
+ * @return A pointer to the filter rule or NULL if it wasn't found.
+ */
+filter_rule_cfg_t* get_filter_by_id(config__t* cfg, int id)
+{
+    for (int i = 0; i < MAX_CFG_FILTERS; i++)
+    {
+        filter_rule_cfg_t* filter = &cfg->filters[i];
+
+        if (filter->set && filter->id == id)
+        {
+            return filter;
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * Retrieves the next available IP drop range index.
  * 
@@ -1591,5 +2219,29 @@ int get_next_ip_drop_range_idx(config__t* cfg)
         return i;
     }
 
+    return -1;
+}
+
+/**
+ * Retrieves the next available IPv6 drop range index.
+ * 
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return The next available index or -1 if there are no available indexes.
+ */
+int get_next_ip6_drop_range_idx(config__t* cfg)
+{
+    for (int i = 0; i < MAX_IP_RANGES; i++)
+    {
+        const char* range = cfg->drop_ranges6[i];
+
+        if (range)
+        {
+            continue;
+        }
+
+        return i;
+    }
+
     return -1;
 }
\ No newline at end of file
@@ -28,6 +28,8 @@ struct filter_rule_ip_opts
     int max_len;
 
     int tos;
+
+    int frag;
 } typedef filter_rule_ip_opts_t;
 
 struct filter_rule_filter_tcp
@@ -65,6 +67,9 @@ struct filter_rule_filter_icmp
 
 struct filter_rule_cfg
 {
+    // The rule's position inside of the config when it was loaded (used as the filter stats key since rules may be reordered).
+    int id;
+
     int set;
     int log;
     int enabled;
@@ -72,12 +77,21 @@ struct filter_rule_cfg
     int action;
     int block_time;
 
+    int sample_rate;
+    int sample_pps;
+
     s64 ip_pps;
     s64 ip_bps;
 
     s64 flow_pps;
     s64 flow_bps;
 
+    s64 police_rate;
+    s64 police_burst;
+    int police_flow;
+
+    int vlan_id;
+
     filter_rule_ip_opts_t ip;
     
     filter_rule_filter_tcp_t tcp;
@@ -94,15 +108,36 @@ struct config
     unsigned int no_stats : 1;
     unsigned int stats_per_second : 1;
     int stdout_update_time;
+    int reorder_time;
+    unsigned int codegen : 1;
+    int rl_percpu_scale;
+    int block_sweep_time;
+    int block_bloom_rebuild_time;
+    int syn_proxy_allow_time;
+    int inspect_block_time;
+    int log_flush_time;
+    int log_thread_cpu;
+    unsigned int log_busy_poll : 1;
+
+    features_t features;
 
     int interfaces_cnt;
     char* interfaces[MAX_INTERFACES];
 
     int filters_cnt;
-    filter_rule_cfg_t filters[MAX_FILTERS];
+    filter_rule_cfg_t filters[MAX_CFG_FILTERS];
     
     int drop_ranges_cnt;
     char* drop_ranges[MAX_IP_RANGES];
+
+    int drop_ranges6_cnt;
+    char* drop_ranges6[MAX_IP_RANGES];
+
+    int syn_proxy_ports_cnt;
+    u16 syn_proxy_ports[MAX_SYN_PROXY_PORTS];
+
+    int inspect_patterns_cnt;
+    char* inspect_patterns[MAX_INSPECT_PATTERNS];
 } typedef config__t; // config_t is taken by libconfig -.-
 
 struct config_overrides
@@ -115,6 +150,8 @@ struct config_overrides
     int no_stats;
     int stats_per_second;
     int stdout_update_time;
+    int reorder_time;
+    int codegen;
 } typedef config_overrides_t;
 
 void set_cfg_defaults(config__t *cfg);
@@ -132,6 +169,8 @@ int read_cfg(FILE* file, char** buffer);
 int parse_cfg(config__t *cfg, const char* data, config_overrides_t* overrides);
 
 int get_next_filter_idx(config__t* cfg);
+filter_rule_cfg_t* get_filter_by_id(config__t* cfg, int id);
 int get_next_ip_drop_range_idx(config__t* cfg);
+int get_next_ip6_drop_range_idx(config__t* cfg);
 
 #include <loader/utils/logging.h>
\ No newline at end of file
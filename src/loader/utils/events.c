@@ -0,0 +1,201 @@
+#include <loader/utils/events.h>
+
+/**
+ * Blocks the signals that stop or reload the loader and creates a signal FD to receive them with.
+ * 
+ * @note This must be called before creating threads since they inherit the signal mask.
+ * 
+ * @return The signal FD on success or a negative error value.
+ */
+int create_signal_fd()
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) != 0)
+    {
+        return -errno;
+    }
+
+    int sig_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    if (sig_fd < 0)
+    {
+        int ret = -errno;
+
+        sigprocmask(SIG_UNBLOCK, &mask, NULL);
+
+        return ret;
+    }
+
+    return sig_fd;
+}
+
+/**
+ * Sets the interval of a timer FD.
+ * 
+ * @param timer_fd The timer FD.
+ * @param interval The interval in milliseconds.
+ * 
+ * @return 0 on success or a negative error value.
+ */
+int set_timer_fd(int timer_fd, int interval)
+{
+    struct itimerspec spec = {0};
+
+    spec.it_interval.tv_sec = interval / 1000;
+    spec.it_interval.tv_nsec = (interval % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+
+    if (timerfd_settime(timer_fd, 0, &spec, NULL) != 0)
+    {
+        return -errno;
+    }
+
+    return 0;
+}
+
+/**
+ * Creates a periodic timer FD using the monotonic clock.
+ * 
+ * @param interval The interval in milliseconds.
+ * 
+ * @return The timer FD on success or a negative error value.
+ */
+int create_timer_fd(int interval)
+{
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd < 0)
+    {
+        return -errno;
+    }
+
+    int ret;
+
+    if ((ret = set_timer_fd(timer_fd, interval)) != 0)
+    {
+        close(timer_fd);
+
+        return ret;
+    }
+
+    return timer_fd;
+}
+
+/**
+ * Watches the config file's directory for changes using inotify.
+ * 
+ * @note The directory is watched instead of the file since most editors replace the file when saving.
+ * 
+ * @param cfg_file The config file's path.
+ * 
+ * @return The inotify FD on success or a negative error value.
+ */
+int create_cfg_watch(const char* cfg_file)
+{
+    int cfg_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (cfg_watch_fd < 0)
+    {
+        return -errno;
+    }
+
+    char* dir = strdup(cfg_file);
+
+    if (!dir)
+    {
+        close(cfg_watch_fd);
+
+        return -ENOMEM;
+    }
+
+    char* sep = strrchr(dir, '/');
+    const char* watch_dir = ".";
+
+    if (sep == dir)
+    {
+        watch_dir = "/";
+    }
+    else if (sep)
+    {
+        *sep = '\0';
+        watch_dir = dir;
+    }
+
+    int ret = inotify_add_watch(cfg_watch_fd, watch_dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    free(dir);
+
+    if (ret < 0)
+    {
+        ret = -errno;
+
+        close(cfg_watch_fd);
+
+        return ret;
+    }
+
+    return cfg_watch_fd;
+}
+
+/**
+ * Reads all pending events from the config watch FD.
+ * 
+ * @param cfg_watch_fd The inotify FD.
+ * @param cfg_file The config file's path.
+ * 
+ * @return 1 if the config file was written or replaced or 0 otherwise.
+ */
+int read_cfg_watch(int cfg_watch_fd, const char* cfg_file)
+{
+    const char* name = strrchr(cfg_file, '/');
+    name = name ? name + 1 : cfg_file;
+
+    int changed = 0;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    ssize_t len;
+
+    while ((len = read(cfg_watch_fd, buf, sizeof(buf))) > 0)
+    {
+        for (char* ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len)
+        {
+            struct inotify_event* e = (struct inotify_event*)ptr;
+
+            if (e->len > 0 && strcmp(e->name, name) == 0)
+            {
+                changed = 1;
+            }
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * Adds a FD to an epoll instance for input events.
+ * 
+ * @param epoll_fd The epoll FD.
+ * @param fd The FD to add.
+ * 
+ * @return 0 on success or a negative error value.
+ */
+int add_epoll_fd(int epoll_fd, int fd)
+{
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        return -errno;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/inotify.h>
+
+#define MAX_LOADER_EVENTS 4
+
+int create_signal_fd();
+int create_timer_fd(int interval);
+int set_timer_fd(int timer_fd, int interval);
+int create_cfg_watch(const char* cfg_file);
+int read_cfg_watch(int cfg_watch_fd, const char* cfg_file);
+int add_epoll_fd(int epoll_fd, int fd);
\ No newline at end of file
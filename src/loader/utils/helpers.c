@@ -22,6 +22,8 @@ void print_help_menu()
     printf("  -n, --no-stats       Override config's no stats value.\n");
     printf("      --stats-ps       Override config's stats per second value.\n");
     printf("      --stdout-ut      Override config's stdout update time value.\n");
+    printf("      --reorder-time   Override config's filter reorder time value.\n");
+    printf("      --codegen        Override config's code generation value.\n");
 }
 
 /**
@@ -69,6 +71,68 @@ ip_range_t parse_ip_range(const char *ip)
     return ret;
 }
 
+/**
+ * Parses an IPv6 string with CIDR support. Stores the IP in network byte order in ip.ip (host bits are cleared) and CIDR in ip.cidr.
+ * 
+ * @param ip The IPv6 string.
+ * 
+ * @return Returns an IPv6 structure with IP and CIDR (ip.success is 0 if the IP is invalid).
+ */
+ip6_range_t parse_ip6_range(const char* ip)
+{
+    ip6_range_t ret = {0};
+    ret.cidr = 128;
+
+    char ip_copy[INET6_ADDRSTRLEN + 4];
+    strncpy(ip_copy, ip, sizeof(ip_copy) - 1);
+    ip_copy[sizeof(ip_copy) - 1] = '\0';
+
+    char* cidr = strchr(ip_copy, '/');
+
+    if (cidr)
+    {
+        *cidr = '\0';
+        cidr++;
+
+        unsigned long val = strtoul(cidr, NULL, 10);
+
+        if (val > 128)
+        {
+            return ret;
+        }
+
+        ret.cidr = (u8) val;
+    }
+
+    struct in6_addr addr;
+
+    if (inet_pton(AF_INET6, ip_copy, &addr) != 1)
+    {
+        return ret;
+    }
+
+    // Clear the host bits so the IP is the network's first address.
+    for (int i = 0; i < 16; i++)
+    {
+        int bits = ret.cidr - (i * 8);
+
+        if (bits <= 0)
+        {
+            addr.s6_addr[i] = 0;
+        }
+        else if (bits < 8)
+        {
+            addr.s6_addr[i] &= (u8) (0xFF << (8 - bits));
+        }
+    }
+
+    memcpy(ret.ip, addr.s6_addr, sizeof(ret.ip));
+
+    ret.success = 1;
+
+    return ret;
+}
+
 /**
  * Retrieves protocol name by ID.
  * 
@@ -123,6 +187,19 @@ u64 get_boot_nano_time()
     return sys.uptime * 1e9;
 }
 
+/**
+ * Retrieves nanoseconds from the monotonic clock which is the clock used by bpf_ktime_get_ns() inside of the XDP program.
+ * 
+ * @return The current monotonic time in nanoseconds.
+ */
+u64 get_mono_nano_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((u64)ts.tv_sec * NANO_TO_SEC) + ts.tv_nsec;
+}
+
 /**
  * Parses a port range string and returns the minimum and maximum port.
  * 
@@ -185,4 +262,40 @@ port_range_t parse_port_range(const char* range_str)
     ret.success = 1;
 
     return ret;
+}
+
+/**
+ * Retrieves the amount of RX queues of a network interface.
+ * 
+ * @param interface The interface's name.
+ * 
+ * @return The amount of RX queues or 0 on error.
+ */
+int get_rx_queue_cnt(const char* interface)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/queues", interface);
+
+    DIR* dir = opendir(path);
+
+    if (!dir)
+    {
+        return 0;
+    }
+
+    int cnt = 0;
+
+    struct dirent* entry;
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "rx-", 3) == 0)
+        {
+            cnt++;
+        }
+    }
+
+    closedir(dir);
+
+    return cnt;
 }
\ No newline at end of file
@@ -11,6 +11,10 @@
 #include <ctype.h>
 
 #include <sys/sysinfo.h>
+#include <time.h>
+
+#include <dirent.h>
+#include <limits.h>
 
 struct ip_range
 {
@@ -18,6 +22,13 @@ struct ip_range
     u8 cidr;
 } typedef ip_range_t;
 
+struct ip6_range
+{
+    unsigned int success;
+    u32 ip[4];
+    u8 cidr;
+} typedef ip6_range_t;
+
 struct port_range
 {
     unsigned int success;
@@ -30,7 +41,10 @@ extern int cont;
 void print_help_menu();
 void hdl_signal(int code);
 ip_range_t parse_ip_range(const char* ip);
+ip6_range_t parse_ip6_range(const char* ip);
 const char* get_protocol_str_by_id(int id);
 void print_tool_info();
 u64 get_boot_nano_time();
-port_range_t parse_port_range(const char* range_str);
\ No newline at end of file
+u64 get_mono_nano_time();
+port_range_t parse_port_range(const char* range_str);
+int get_rx_queue_cnt(const char* interface);
\ No newline at end of file
@@ -0,0 +1,691 @@
+#define _GNU_SOURCE
+
+#include <loader/utils/inspect.h>
+
+#ifdef ENABLE_FILTER_INSPECT
+struct inspect_cb_entry
+{
+    inspect_cb_t cb;
+    void* data;
+} typedef inspect_cb_entry_t;
+
+static inspect_cb_entry_t inspect_cbs[MAX_INSPECT_CBS];
+static int inspect_cbs_cnt = 0;
+
+// The amount of registered callbacks that may set a verdict.
+static int inspect_verdict_cbs_cnt = 0;
+
+static inspect_sock_t* inspect_socks = NULL;
+static int inspect_socks_cnt = 0;
+
+static volatile int inspect_running = 0;
+
+static int inspect_map_block = -1;
+static int inspect_map_block6 = -1;
+static u64* inspect_block_bloom = NULL;
+
+/**
+ * Registers an inspection callback that is called for every packet matching a filter rule with the inspect action.
+ *
+ * @note Callbacks must be registered before the inspection threads are started.
+ *
+ * @param cb The callback.
+ * @param data A pointer passed to the callback.
+ * @param sets_verdict Whether the callback may set a verdict (the inspection threads aren't started without one).
+ *
+ * @return 0 on success or -ENOSPC if the maximum amount of callbacks is registered.
+ */
+int register_inspect_cb(inspect_cb_t cb, void* data, int sets_verdict)
+{
+    if (inspect_cbs_cnt >= MAX_INSPECT_CBS)
+    {
+        return -ENOSPC;
+    }
+
+    inspect_cbs[inspect_cbs_cnt].cb = cb;
+    inspect_cbs[inspect_cbs_cnt].data = data;
+
+    inspect_cbs_cnt++;
+
+    if (sets_verdict)
+    {
+        inspect_verdict_cbs_cnt++;
+    }
+
+    return 0;
+}
+
+/**
+ * Retrieves the offset and EtherType of a packet's layer-3 header (skipping VLAN tags).
+ *
+ * @param data A pointer to the start of the packet (Ethernet header).
+ * @param len The packet's length.
+ * @param off A pointer to store the layer-3 header's offset in.
+ *
+ * @return The EtherType (network byte order) or -1 if the packet is too short.
+ */
+static int get_pkt_l3(const u8* data, u32 len, u32* off)
+{
+    *off = sizeof(struct ethhdr);
+
+    if (len < *off)
+    {
+        return -1;
+    }
+
+    u16 h_proto = ((struct ethhdr*)data)->h_proto;
+
+    // Skip up to two VLAN tags (QinQ).
+    for (int i = 0; i < 2 && (h_proto == htons(ETH_P_8021Q) || h_proto == htons(ETH_P_8021AD)); i++)
+    {
+        if (len < *off + 4)
+        {
+            return -1;
+        }
+
+        h_proto = *(u16*)(data + *off + 2);
+        *off += 4;
+    }
+
+    return h_proto;
+}
+
+/**
+ * Retrieves the source IP of a packet along with whether it's an IPv6 packet.
+ *
+ * @param data A pointer to the start of the packet (Ethernet header).
+ * @param len The packet's length.
+ * @param src_ip A pointer to store the IPv4 source address in.
+ * @param src_ip6 A pointer to store the IPv6 source address in.
+ *
+ * @return 0 for IPv4, 1 for IPv6, or -1 if the packet isn't an IP packet.
+ */
+static int get_pkt_src_ip(const u8* data, u32 len, u32* src_ip, u128* src_ip6)
+{
+    u32 off;
+    int h_proto = get_pkt_l3(data, len, &off);
+
+    if (h_proto == htons(ETH_P_IP))
+    {
+        if (len < off + sizeof(struct iphdr))
+        {
+            return -1;
+        }
+
+        *src_ip = ((struct iphdr*)(data + off))->saddr;
+
+        return 0;
+    }
+
+    if (h_proto == htons(ETH_P_IPV6))
+    {
+        if (len < off + sizeof(struct ipv6hdr))
+        {
+            return -1;
+        }
+
+        memcpy(src_ip6, &((struct ipv6hdr*)(data + off))->saddr, sizeof(*src_ip6));
+
+        return 1;
+    }
+
+    return -1;
+}
+
+/**
+ * Retrieves the offset of a packet's payload (after the TCP, UDP, or ICMP header).
+ *
+ * @note Non-first fragments and packets using other protocols or IPv6 extension headers use the data after the IP header as their payload.
+ *
+ * @param data A pointer to the start of the packet (Ethernet header).
+ * @param len The packet's length.
+ * @param off A pointer to store the payload's offset in.
+ *
+ * @return 0 on success or -1 if the packet isn't an IP packet.
+ */
+static int get_pkt_payload(const u8* data, u32 len, u32* off)
+{
+    int h_proto = get_pkt_l3(data, len, off);
+
+    u8 protocol = 0;
+
+    if (h_proto == htons(ETH_P_IP))
+    {
+        if (len < *off + sizeof(struct iphdr))
+        {
+            return -1;
+        }
+
+        struct iphdr* iph = (struct iphdr*)(data + *off);
+
+        *off += iph->ihl * 4;
+
+        if (!(iph->frag_off & htons(IPV4_FRAG_OFFSET)))
+        {
+            protocol = iph->protocol;
+        }
+    }
+    else if (h_proto == htons(ETH_P_IPV6))
+    {
+        if (len < *off + sizeof(struct ipv6hdr))
+        {
+            return -1;
+        }
+
+        protocol = ((struct ipv6hdr*)(data + *off))->nexthdr;
+
+        *off += sizeof(struct ipv6hdr);
+    }
+    else
+    {
+        return -1;
+    }
+
+    if (protocol == IPPROTO_TCP)
+    {
+        if (len >= *off + sizeof(struct tcphdr))
+        {
+            *off += ((struct tcphdr*)(data + *off))->doff * 4;
+        }
+    }
+    else if (protocol == IPPROTO_UDP)
+    {
+        *off += sizeof(struct udphdr);
+    }
+    else if (protocol == IPPROTO_ICMP || protocol == IPPROTO_ICMPV6)
+    {
+        // Both ICMP headers are eight bytes long including the rest of the header.
+        *off += 8;
+    }
+
+    if (*off > len)
+    {
+        *off = len;
+    }
+
+    return 0;
+}
+
+/**
+ * Blocks the source IP of an inspected packet the same way the XDP program does when a drop rule has a block time.
+ *
+ * @param pkt A pointer to the inspected packet.
+ * @param block_time How long to block the source IP for in seconds.
+ *
+ * @return void
+ */
+static void block_pkt_src(inspect_pkt_t* pkt, u64 block_time)
+{
+    u32 src_ip = 0;
+    u128 src_ip6 = 0;
+
+    int ipv6 = get_pkt_src_ip(pkt->data, pkt->len, &src_ip, &src_ip6);
+
+    if (ipv6 < 0)
+    {
+        return;
+    }
+
+    u64 expires = get_mono_nano_time() + (block_time * NANO_TO_SEC);
+
+    if (!ipv6)
+    {
+        if (inspect_map_block < 0 || add_block(inspect_map_block, src_ip, expires) != 0)
+        {
+            return;
+        }
+    }
+    else
+    {
+        if (inspect_map_block6 < 0 || add_block6(inspect_map_block6, src_ip6, expires) != 0)
+        {
+            return;
+        }
+    }
+
+#ifdef ENABLE_BLOCK_BLOOM
+    if (inspect_block_bloom)
+    {
+        add_block_bloom(inspect_block_bloom, ipv6 ? (u32*)&src_ip6 : &src_ip, ipv6);
+    }
+#endif
+}
+
+/**
+ * Runs the inspection callbacks on a packet and applies the verdict.
+ *
+ * @param pkt A pointer to the inspected packet.
+ *
+ * @return void
+ */
+static void inspect_pkt(inspect_pkt_t* pkt)
+{
+    inspect_verdict_t verdict = {0};
+
+    for (int i = 0; i < inspect_cbs_cnt; i++)
+    {
+        if (inspect_cbs[i].cb(pkt, &verdict, inspect_cbs[i].data))
+        {
+            break;
+        }
+    }
+
+    if (verdict.verdict == INSPECT_VERDICT_BLOCK && verdict.block_time > 0)
+    {
+        block_pkt_src(pkt, verdict.block_time);
+    }
+}
+
+/**
+ * The inspection thread of an AF_XDP socket which runs the inspection callbacks on received packets.
+ *
+ * @param arg A pointer to the AF_XDP socket.
+ *
+ * @return NULL
+ */
+static void* inspect_thread(void* arg)
+{
+    inspect_sock_t* sock = arg;
+
+    struct pollfd pfd = {0};
+    pfd.fd = xsk_socket__fd(sock->xsk);
+    pfd.events = POLLIN;
+
+    while (inspect_running)
+    {
+        if (poll(&pfd, 1, INSPECT_POLL_TIMEOUT) <= 0)
+        {
+            continue;
+        }
+
+        u32 idx_rx = 0;
+        u32 rcvd = xsk_ring_cons__peek(&sock->rx, INSPECT_BATCH, &idx_rx);
+
+        if (!rcvd)
+        {
+            continue;
+        }
+
+        // Every frame fits inside of the fill ring, so there is always room for the received frames.
+        u32 idx_fq = 0;
+
+        while (xsk_ring_prod__reserve(&sock->fq, rcvd, &idx_fq) != rcvd && inspect_running);
+
+        if (!inspect_running)
+        {
+            break;
+        }
+
+        for (u32 i = 0; i < rcvd; i++)
+        {
+            const struct xdp_desc* desc = xsk_ring_cons__rx_desc(&sock->rx, idx_rx + i);
+
+            inspect_pkt_t pkt = {0};
+            pkt.data = xsk_umem__get_data(sock->bufs, desc->addr);
+            pkt.len = desc->len;
+            pkt.interface = sock->interface;
+            pkt.queue = sock->queue;
+
+            inspect_pkt(&pkt);
+
+            // Return the frame to the fill ring (the address may include the frame's headroom).
+            *xsk_ring_prod__fill_addr(&sock->fq, idx_fq + i) = desc->addr - (desc->addr % XSK_UMEM__DEFAULT_FRAME_SIZE);
+        }
+
+        xsk_ring_prod__submit(&sock->fq, rcvd);
+        xsk_ring_cons__release(&sock->rx, rcvd);
+
+        if (xsk_ring_prod__needs_wakeup(&sock->fq))
+        {
+            recvfrom(pfd.fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Creates an AF_XDP socket on an interface's RX queue using zero-copy mode if the driver supports it.
+ *
+ * @param cfg A pointer to the config structure.
+ * @param sock A pointer to the AF_XDP socket.
+ *
+ * @return 0 on success or a negative error value.
+ */
+static int create_inspect_sock(config__t* cfg, inspect_sock_t* sock)
+{
+    int ret;
+
+    u64 size = (u64)INSPECT_FRAMES * XSK_UMEM__DEFAULT_FRAME_SIZE;
+
+    sock->bufs = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (sock->bufs == MAP_FAILED)
+    {
+        sock->bufs = NULL;
+
+        return -errno;
+    }
+
+    if ((ret = xsk_umem__create(&sock->umem, sock->bufs, size, &sock->fq, &sock->cq, NULL)) != 0)
+    {
+        return ret;
+    }
+
+    struct xsk_socket_config xsk_cfg = {0};
+    xsk_cfg.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+    xsk_cfg.libxdp_flags = XSK_LIBXDP_FLAGS__INHIBIT_PROG_LOAD;
+    xsk_cfg.bind_flags = XDP_ZEROCOPY | XDP_USE_NEED_WAKEUP;
+
+    // The socket doesn't transmit, so it doesn't need a TX ring.
+    if ((ret = xsk_socket__create(&sock->xsk, sock->interface, sock->queue, sock->umem, &sock->rx, NULL, &xsk_cfg)) != 0)
+    {
+        log_msg(cfg, 4, 0, "Zero-copy mode isn't supported on '%s' queue #%u (%d). Using copy mode...", sock->interface, sock->queue, ret);
+
+        xsk_cfg.bind_flags = XDP_COPY | XDP_USE_NEED_WAKEUP;
+
+        if ((ret = xsk_socket__create(&sock->xsk, sock->interface, sock->queue, sock->umem, &sock->rx, NULL, &xsk_cfg)) != 0)
+        {
+            return ret;
+        }
+    }
+
+    // Give every frame to the kernel.
+    u32 idx = 0;
+
+    if (xsk_ring_prod__reserve(&sock->fq, INSPECT_FRAMES, &idx) != INSPECT_FRAMES)
+    {
+        return -ENOMEM;
+    }
+
+    for (u32 i = 0; i < INSPECT_FRAMES; i++)
+    {
+        *xsk_ring_prod__fill_addr(&sock->fq, idx + i) = (u64)i * XSK_UMEM__DEFAULT_FRAME_SIZE;
+    }
+
+    xsk_ring_prod__submit(&sock->fq, INSPECT_FRAMES);
+
+    return 0;
+}
+
+/**
+ * Deletes an AF_XDP socket along with its UMEM.
+ *
+ * @param sock A pointer to the AF_XDP socket.
+ *
+ * @return void
+ */
+static void delete_inspect_sock(inspect_sock_t* sock)
+{
+    if (sock->xsk)
+    {
+        xsk_socket__delete(sock->xsk);
+        sock->xsk = NULL;
+    }
+
+    if (sock->umem)
+    {
+        xsk_umem__delete(sock->umem);
+        sock->umem = NULL;
+    }
+
+    if (sock->bufs)
+    {
+        munmap(sock->bufs, (u64)INSPECT_FRAMES * XSK_UMEM__DEFAULT_FRAME_SIZE);
+        sock->bufs = NULL;
+    }
+}
+
+/**
+ * Creates an AF_XDP socket and inspection thread for every RX queue of the attached interfaces.
+ *
+ * @param cfg A pointer to the config structure.
+ * @param if_idx The indexes of the attached interfaces (0 if not attached).
+ * @param map_xsks The AF_XDP socket BPF map FD.
+ * @param map_xsks_ifaces The AF_XDP socket interface BPF map FD.
+ * @param map_block The block BPF map FD.
+ * @param map_block6 The IPv6 block BPF map FD.
+ * @param block_bloom A pointer to the block bloom filter words (or NULL).
+ *
+ * @return The amount of inspection threads started, -ENOENT if no callback setting a verdict is registered, or another negative error value.
+ */
+int start_inspect(config__t* cfg, int* if_idx, int map_xsks, int map_xsks_ifaces, int map_block, int map_block6, u64* block_bloom)
+{
+    int ret;
+
+    // Inspected packets are consumed, so without a verdict the matching packets would be dropped silently instead of passed.
+    if (inspect_verdict_cbs_cnt < 1)
+    {
+        return -ENOENT;
+    }
+
+    inspect_map_block = map_block;
+    inspect_map_block6 = map_block6;
+    inspect_block_bloom = block_bloom;
+
+    inspect_socks = calloc(MAX_INTERFACES * MAX_CPUS, sizeof(inspect_sock_t));
+
+    if (!inspect_socks)
+    {
+        return -ENOMEM;
+    }
+
+    inspect_running = 1;
+
+    for (int i = 0; i < cfg->interfaces_cnt && i < MAX_INTERFACES; i++)
+    {
+        const char* interface = cfg->interfaces[i];
+
+        if (!interface || if_idx[i] <= 0)
+        {
+            continue;
+        }
+
+        int queues = get_rx_queue_cnt(interface);
+
+        if (queues < 1)
+        {
+            queues = 1;
+        }
+        else if (queues > MAX_CPUS)
+        {
+            queues = MAX_CPUS;
+        }
+
+        // Each interface uses its own range of the AF_XDP socket map.
+        u32 ifindex = if_idx[i];
+        u32 base = i * MAX_CPUS;
+
+        if ((ret = bpf_map_update_elem(map_xsks_ifaces, &ifindex, &base, BPF_ANY)) != 0)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to add interface '%s' to AF_XDP socket interface map (%d)...", interface, ret);
+
+            continue;
+        }
+
+        for (int j = 0; j < queues; j++)
+        {
+            inspect_sock_t* sock = &inspect_socks[inspect_socks_cnt];
+
+            snprintf(sock->interface, sizeof(sock->interface), "%s", interface);
+            sock->queue = j;
+
+            if ((ret = create_inspect_sock(cfg, sock)) != 0)
+            {
+                log_msg(cfg, 1, 0, "[WARNING] Failed to create AF_XDP socket on '%s' queue #%d (%d)...", interface, j, ret);
+
+                delete_inspect_sock(sock);
+
+                continue;
+            }
+
+            u32 key = base + j;
+            int fd = xsk_socket__fd(sock->xsk);
+
+            if ((ret = bpf_map_update_elem(map_xsks, &key, &fd, BPF_ANY)) != 0)
+            {
+                log_msg(cfg, 1, 0, "[WARNING] Failed to add AF_XDP socket on '%s' queue #%d to socket map (%d)...", interface, j, ret);
+
+                delete_inspect_sock(sock);
+
+                continue;
+            }
+
+            if ((ret = pthread_create(&sock->thread, NULL, inspect_thread, sock)) != 0)
+            {
+                log_msg(cfg, 1, 0, "[WARNING] Failed to create inspection thread for '%s' queue #%d (%d)...", interface, j, ret);
+
+                bpf_map_delete_elem(map_xsks, &key);
+                delete_inspect_sock(sock);
+
+                continue;
+            }
+
+            sock->started = 1;
+
+            inspect_socks_cnt++;
+        }
+    }
+
+    return inspect_socks_cnt;
+}
+
+/**
+ * Stops the inspection threads and deletes their AF_XDP sockets.
+ *
+ * @return void
+ */
+void stop_inspect()
+{
+    inspect_running = 0;
+
+    if (!inspect_socks)
+    {
+        return;
+    }
+
+    for (int i = 0; i < inspect_socks_cnt; i++)
+    {
+        inspect_sock_t* sock = &inspect_socks[i];
+
+        if (sock->started)
+        {
+            pthread_join(sock->thread, NULL);
+        }
+
+        // Deleting the socket also removes it from the AF_XDP socket map.
+        delete_inspect_sock(sock);
+    }
+
+    free(inspect_socks);
+
+    inspect_socks = NULL;
+    inspect_socks_cnt = 0;
+}
+
+/**
+ * An inspection callback that prints a line for each inspected packet (used with a verbose level of 5 or higher).
+ *
+ * @param pkt A pointer to the inspected packet.
+ * @param verdict A pointer to the verdict.
+ * @param data Unused.
+ *
+ * @return 0 (the callback doesn't set a verdict).
+ */
+int inspect_log_cb(inspect_pkt_t* pkt, inspect_verdict_t* verdict, void* data)
+{
+    u32 src_ip = 0;
+    u128 src_ip6 = 0;
+
+    int ipv6 = get_pkt_src_ip(pkt->data, pkt->len, &src_ip, &src_ip6);
+
+    char src_ip_str[INET6_ADDRSTRLEN] = "N/A";
+
+    if (ipv6 == 0)
+    {
+        inet_ntop(AF_INET, &src_ip, src_ip_str, sizeof(src_ip_str));
+    }
+    else if (ipv6 == 1)
+    {
+        inet_ntop(AF_INET6, &src_ip6, src_ip_str, sizeof(src_ip_str));
+    }
+
+    // The config isn't used since it may be reloaded while the inspection threads are running.
+    fprintf(stdout, "[5] Inspected packet on '%s' queue #%u (Source => %s, Length => %u).\n", pkt->interface, pkt->queue, src_ip_str, pkt->len);
+
+    return 0;
+}
+
+/**
+ * Copies the inspect patterns and block time from the config for the pattern callback.
+ *
+ * @param patterns A pointer to the patterns structure.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return The amount of patterns.
+ */
+int init_inspect_patterns(inspect_patterns_t* patterns, config__t* cfg)
+{
+    memset(patterns, 0, sizeof(*patterns));
+
+    patterns->block_time = cfg->inspect_block_time;
+
+    for (int i = 0; i < cfg->inspect_patterns_cnt && i < MAX_INSPECT_PATTERNS; i++)
+    {
+        const char* pattern = cfg->inspect_patterns[i];
+
+        if (!pattern)
+        {
+            continue;
+        }
+
+        u32 len = strlen(pattern);
+
+        if (len < 1 || len > MAX_INSPECT_PATTERN_LEN)
+        {
+            continue;
+        }
+
+        memcpy(patterns->patterns[patterns->cnt], pattern, len);
+        patterns->lens[patterns->cnt] = len;
+
+        patterns->cnt++;
+    }
+
+    return patterns->cnt;
+}
+
+/**
+ * An inspection callback that blocks the source IP of packets whose payload contains one of the inspect patterns.
+ *
+ * @param pkt A pointer to the inspected packet.
+ * @param verdict A pointer to the verdict.
+ * @param data A pointer to the inspect patterns (inspect_patterns_t).
+ *
+ * @return 1 if the packet contains a pattern (block verdict) or 0 otherwise.
+ */
+int inspect_pattern_cb(inspect_pkt_t* pkt, inspect_verdict_t* verdict, void* data)
+{
+    inspect_patterns_t* patterns = data;
+
+    u32 off;
+
+    if (get_pkt_payload(pkt->data, pkt->len, &off) != 0)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < patterns->cnt; i++)
+    {
+        if (memmem(pkt->data + off, pkt->len - off, patterns->patterns[i], patterns->lens[i]))
+        {
+            verdict->verdict = INSPECT_VERDICT_BLOCK;
+            verdict->block_time = patterns->block_time;
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+#include <xdp/xsk.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <poll.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+#include <loader/utils/bloom.h>
+#include <loader/utils/logging.h>
+#include <loader/utils/helpers.h>
+
+#ifdef ENABLE_FILTER_INSPECT
+// The UMEM of each AF_XDP socket has as many frames as the fill ring, so received frames can always be returned right away.
+#define INSPECT_FRAMES XSK_RING_PROD__DEFAULT_NUM_DESCS
+#define INSPECT_BATCH 64
+#define INSPECT_POLL_TIMEOUT 100
+
+#define MAX_INSPECT_CBS 8
+
+enum
+{
+    INSPECT_VERDICT_NONE = 0,
+    INSPECT_VERDICT_BLOCK
+};
+
+struct inspect_pkt
+{
+    const u8* data;
+    u32 len;
+
+    const char* interface;
+    u32 queue;
+} typedef inspect_pkt_t;
+
+struct inspect_verdict
+{
+    int verdict;
+
+    // How long to block the packet's source IP for in seconds (INSPECT_VERDICT_BLOCK).
+    u64 block_time;
+} typedef inspect_verdict_t;
+
+// The payload patterns of the built-in pattern callback (copied from the config on startup since the config may be reloaded while the inspection threads are running).
+struct inspect_patterns
+{
+    int cnt;
+
+    char patterns[MAX_INSPECT_PATTERNS][MAX_INSPECT_PATTERN_LEN];
+    u32 lens[MAX_INSPECT_PATTERNS];
+
+    // How long to block the source IP of packets containing a pattern for in seconds.
+    u64 block_time;
+} typedef inspect_patterns_t;
+
+// Callbacks run inside of the inspection threads and return 1 when they set a verdict (which stops the remaining callbacks) or 0 otherwise.
+typedef int (*inspect_cb_t)(inspect_pkt_t* pkt, inspect_verdict_t* verdict, void* data);
+
+struct inspect_sock
+{
+    char interface[IF_NAMESIZE];
+    u32 queue;
+
+    void* bufs;
+    struct xsk_umem* umem;
+    struct xsk_socket* xsk;
+
+    struct xsk_ring_prod fq;
+    struct xsk_ring_cons cq;
+    struct xsk_ring_cons rx;
+
+    pthread_t thread;
+    unsigned int started : 1;
+} typedef inspect_sock_t;
+
+int register_inspect_cb(inspect_cb_t cb, void* data, int sets_verdict);
+int inspect_log_cb(inspect_pkt_t* pkt, inspect_verdict_t* verdict, void* data);
+
+int init_inspect_patterns(inspect_patterns_t* patterns, config__t* cfg);
+int inspect_pattern_cb(inspect_pkt_t* pkt, inspect_verdict_t* verdict, void* data);
+
+int start_inspect(config__t* cfg, int* if_idx, int map_xsks, int map_xsks_ifaces, int map_block, int map_block6, u64* block_bloom);
+void stop_inspect();
+#endif
\ No newline at end of file
@@ -1,5 +1,20 @@
+#define _GNU_SOURCE
+
 #include <loader/utils/logging.h>
 
+static struct ring_buffer* filters_rb = NULL;
+static int filters_rb_busy_poll = 0;
+
+static pthread_t filters_rb_thread;
+static int filters_rb_stop_fd = -1;
+static volatile int filters_rb_running = 0;
+
+// The consumer thread reads the filter rules from the config, so it's locked while the config is changed.
+static pthread_mutex_t filters_rb_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Set while the main thread waits for the lock, since mutexes aren't fair and the busy polling thread would take the lock right back.
+static int filters_rb_lock_wanted = 0;
+
 /**
  * Prints a log message to stdout/stderr along with a file if specified.
  * 
@@ -106,18 +121,186 @@ void log_msg(config__t* cfg, int req_lvl, int error, const char* msg, ...)
 }
 
 /**
- * Polls the filters map ringbuffer.
+ * Consumes all available events from the filters map ringbuffer.
+ * 
+ * @return void
+ */
+static void consume_filters_rb()
+{
+    pthread_mutex_lock(&filters_rb_lock);
+
+    ring_buffer__consume(filters_rb);
+
+    pthread_mutex_unlock(&filters_rb_lock);
+}
+
+/**
+ * The filters map ringbuffer consumer thread which sleeps until the ringbuffer has events (or spins when busy polling).
+ * 
+ * @param arg Unused.
+ * 
+ * @return NULL
+ */
+static void* filters_rb_thread_fn(void* arg)
+{
+    if (filters_rb_busy_poll)
+    {
+        while (filters_rb_running)
+        {
+            if (__atomic_load_n(&filters_rb_lock_wanted, __ATOMIC_ACQUIRE))
+            {
+                sched_yield();
+
+                continue;
+            }
+
+            consume_filters_rb();
+        }
+
+        return NULL;
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epoll_fd < 0)
+    {
+        return NULL;
+    }
+
+    // The ringbuffer's epoll FD becomes readable when any of its rings have events.
+    struct epoll_event ev = {0};
+    ev.events = EPOLLIN;
+
+    ev.data.fd = ring_buffer__epoll_fd(filters_rb);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+
+    ev.data.fd = filters_rb_stop_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+
+    struct epoll_event events[2];
+
+    while (filters_rb_running)
+    {
+        int cnt = epoll_wait(epoll_fd, events, 2, -1);
+
+        for (int i = 0; i < cnt; i++)
+        {
+            if (events[i].data.fd != filters_rb_stop_fd)
+            {
+                consume_filters_rb();
+            }
+        }
+    }
+
+    close(epoll_fd);
+
+    return NULL;
+}
+
+/**
+ * Starts the filters map ringbuffer consumer thread.
  * 
  * @param rb A pointer to the ringbuffer.
+ * @param cpu The CPU to pin the thread to (-1 = not pinned).
+ * @param busy_poll Whether to busy poll the ringbuffer instead of waiting for events.
+ * 
+ * @return 0 on success or a negative error value.
+ */
+int start_filters_rb(struct ring_buffer* rb, int cpu, int busy_poll)
+{
+    int ret;
+
+    filters_rb = rb;
+    filters_rb_busy_poll = busy_poll;
+
+    if ((filters_rb_stop_fd = eventfd(0, EFD_CLOEXEC)) < 0)
+    {
+        return -errno;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if (cpu > -1)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    filters_rb_running = 1;
+
+    // This fails if the CPU doesn't exist.
+    ret = pthread_create(&filters_rb_thread, &attr, filters_rb_thread_fn, NULL);
+
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0)
+    {
+        filters_rb_running = 0;
+
+        close(filters_rb_stop_fd);
+        filters_rb_stop_fd = -1;
+
+        return -ret;
+    }
+
+    return 0;
+}
+
+/**
+ * Stops the filters map ringbuffer consumer thread after it consumed the remaining events.
  * 
  * @return void
  */
-void poll_filters_rb(struct ring_buffer* rb)
+void stop_filters_rb()
 {
-    if (rb)
+    if (!filters_rb_running)
+    {
+        return;
+    }
+
+    filters_rb_running = 0;
+
+    u64 val = 1;
+    
+    if (write(filters_rb_stop_fd, &val, sizeof(val)) < 0)
     {
-        ring_buffer__poll(rb, RB_TIMEOUT);
+        // The thread still wakes up on the next event.
     }
+
+    pthread_join(filters_rb_thread, NULL);
+
+    close(filters_rb_stop_fd);
+    filters_rb_stop_fd = -1;
+
+    consume_filters_rb();
+}
+
+/**
+ * Blocks the filters map ringbuffer consumer thread from handling events (used while changing the config).
+ * 
+ * @return void
+ */
+void lock_filters_rb()
+{
+    __atomic_add_fetch(&filters_rb_lock_wanted, 1, __ATOMIC_ACQ_REL);
+
+    pthread_mutex_lock(&filters_rb_lock);
+
+    __atomic_sub_fetch(&filters_rb_lock_wanted, 1, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * Allows the filters map ringbuffer consumer thread to handle events again.
+ * 
+ * @return void
+ */
+void unlock_filters_rb()
+{
+    pthread_mutex_unlock(&filters_rb_lock);
 }
 
 /**
@@ -134,7 +317,8 @@ int hdl_filters_rb_event(void* ctx, void* data, size_t sz)
     config__t* cfg = (config__t*)ctx;
     filter_log_event_t* e = (filter_log_event_t*)data;
 
-    filter_rule_cfg_t* filter = &cfg->filters[e->filter_id];
+    // Rules may have been reordered since the event was sent, so look up the rule by its config index.
+    filter_rule_cfg_t* filter = get_filter_by_id(cfg, e->filter_id);
 
     if (filter == NULL)
     {
@@ -161,10 +345,99 @@ int hdl_filters_rb_event(void* ctx, void* data, size_t sz)
     {
         action = "Passed";
     }
+    else if (filter->action == 2)
+    {
+        action = "Policed";
+    }
+    else if (filter->action == 3)
+    {
+        action = "Inspected";
+    }
 
     const char* protocol_str = get_protocol_str_by_id(e->protocol);
 
     log_msg(cfg, 0, 0, "[FILTER %d] %s %s packet '%s:%d' => '%s:%d' (IP PPS => %llu, IP BPS => %llu, Flow PPS => %llu, Flow BPS => %llu Filter Block Time => %llu, length => %d)...", e->filter_id + 1, action, protocol_str, src_ip_str, htons(e->src_port), dst_ip_str, htons(e->dst_port), e->ip_pps, e->ip_bps, e->flow_pps, e->flow_bps, filter->block_time, e->length);
 
     return 0;
+}
+
+/**
+ * Logs and resets the filter matches that the XDP program didn't send to the ringbuffer (sampling or a full ringbuffer).
+ * 
+ * @param cfg A pointer to the config structure.
+ * @param map_filter_log_suppressed The suppressed filter log BPF map FD.
+ * @param cpus The amount of CPUs the host has.
+ * 
+ * @return The amount of flushed entries or a negative error value.
+ */
+int flush_filter_log_suppressed(config__t* cfg, int map_filter_log_suppressed, int cpus)
+{
+    filter_log_suppressed_key_t* keys = calloc(MAX_FILTER_LOG_SUPPRESSED, sizeof(filter_log_suppressed_key_t));
+
+    if (!keys)
+    {
+        return -ENOMEM;
+    }
+
+    int cnt = 0;
+
+    filter_log_suppressed_key_t key;
+    filter_log_suppressed_key_t prev_key;
+
+    void* prev = NULL;
+
+    // We can't delete while iterating since that would restart the iteration.
+    while (cnt < MAX_FILTER_LOG_SUPPRESSED && bpf_map_get_next_key(map_filter_log_suppressed, prev, &key) == 0)
+    {
+        keys[cnt++] = key;
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+
+    filter_log_suppressed_t vals[MAX_CPUS];
+
+    for (int i = 0; i < cnt; i++)
+    {
+        memset(vals, 0, sizeof(vals));
+
+        if (bpf_map_lookup_elem(map_filter_log_suppressed, &keys[i], vals) != 0)
+        {
+            continue;
+        }
+
+        // Matches counted between the lookup and delete are lost, which is fine for a summary.
+        bpf_map_delete_elem(map_filter_log_suppressed, &keys[i]);
+
+        u64 packets = 0;
+        u64 bytes = 0;
+
+        for (int j = 0; j < cpus && j < MAX_CPUS; j++)
+        {
+            packets += vals[j].packets;
+            bytes += vals[j].bytes;
+        }
+
+        if (!packets)
+        {
+            continue;
+        }
+
+        char src_ip_str[INET6_ADDRSTRLEN];
+
+        if (memcmp(keys[i].src_ip6, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16) != 0)
+        {
+            inet_ntop(AF_INET6, keys[i].src_ip6, src_ip_str, sizeof(src_ip_str));
+        }
+        else
+        {
+            inet_ntop(AF_INET, &keys[i].src_ip, src_ip_str, sizeof(src_ip_str));
+        }
+
+        log_msg(cfg, 0, 0, "[FILTER %d] Suppressed %llu matched packet(s) (%llu bytes) from '%s' since the last flush...", keys[i].filter_id + 1, packets, bytes, src_ip_str);
+    }
+
+    free(keys);
+
+    return cnt;
 }
\ No newline at end of file
@@ -3,8 +3,15 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
 
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include <common/all.h>
 
@@ -12,11 +19,13 @@
 
 #include <xdp/libxdp.h>
 
-#define RB_TIMEOUT 100
-
 extern int doing_stats;
 
 void log_msg(config__t* cfg, int req_lvl, int error, const char* msg, ...);
 
-void poll_filters_rb(struct ring_buffer* rb);
-int hdl_filters_rb_event(void* ctx, void* data, size_t sz);
\ No newline at end of file
+int start_filters_rb(struct ring_buffer* rb, int cpu, int busy_poll);
+void stop_filters_rb();
+void lock_filters_rb();
+void unlock_filters_rb();
+int hdl_filters_rb_event(void* ctx, void* data, size_t sz);
+int flush_filter_log_suppressed(config__t* cfg, int map_filter_log_suppressed, int cpus);
\ No newline at end of file
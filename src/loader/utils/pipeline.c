@@ -0,0 +1,122 @@
+#include <loader/utils/pipeline.h>
+
+// The XDP program stage names (indexes are the stage numbers inside of the program array map).
+static const char* pipeline_stages[PIPELINE_STAGE_MAX] =
+{
+    "xdp_prog_block",
+    "xdp_prog_range_drop",
+    "xdp_prog_rl",
+    "xdp_prog_filters"
+};
+
+/**
+ * Sets an XDP program stage inside of the program array map or removes the stage if the program name is NULL.
+ * 
+ * @param map_pipeline The program array BPF map FD.
+ * @param stage The stage (PIPELINE_STAGE_*).
+ * @param prog A pointer to the loaded XDP program containing the stage.
+ * @param prog_name The stage's program (function) name or NULL to skip the stage.
+ * 
+ * @return 0 on success or a negative errno value on error.
+ */
+int set_pipeline_stage(int map_pipeline, u32 stage, struct xdp_program* prog, const char* prog_name)
+{
+    if (!prog_name)
+    {
+        // The stage is already skipped if it isn't set.
+        if (bpf_map_delete_elem(map_pipeline, &stage) != 0 && errno != ENOENT)
+        {
+            return -errno;
+        }
+
+        return 0;
+    }
+
+    struct bpf_program* stage_prog = bpf_object__find_program_by_name(get_bpf_obj(prog), prog_name);
+
+    if (!stage_prog)
+    {
+        return -ENOENT;
+    }
+
+    int fd = bpf_program__fd(stage_prog);
+
+    if (fd < 0)
+    {
+        return fd;
+    }
+
+    if (bpf_map_update_elem(map_pipeline, &stage, &fd, BPF_ANY) != 0)
+    {
+        return -errno;
+    }
+
+    return 0;
+}
+
+/**
+ * Sets every XDP program stage to the stages of the given XDP program and skips stages that aren't compiled in or are disabled.
+ * 
+ * @param map_pipeline The program array BPF map FD.
+ * @param prog A pointer to the loaded XDP program.
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return 0 on success or a negative errno value on error.
+ */
+int update_pipeline(int map_pipeline, struct xdp_program* prog, config__t* cfg)
+{
+    int ret;
+
+    for (u32 stage = 0; stage < PIPELINE_STAGE_MAX; stage++)
+    {
+        const char* prog_name = pipeline_stages[stage];
+
+        switch (stage)
+        {
+            case PIPELINE_STAGE_RANGE_DROP:
+#ifndef ENABLE_IP_RANGE_DROP
+                prog_name = NULL;
+#endif
+
+                break;
+
+            case PIPELINE_STAGE_RL:
+            {
+                int rl = 0;
+
+#ifdef ENABLE_RL_IP
+                rl |= cfg->features.rl_ip;
+#endif
+
+#ifdef ENABLE_RL_FLOW
+                rl |= cfg->features.rl_flow;
+#endif
+
+#ifndef ENABLE_FILTERS
+                rl = 0;
+#endif
+
+                if (!rl)
+                {
+                    prog_name = NULL;
+                }
+
+                break;
+            }
+
+            case PIPELINE_STAGE_FILTERS:
+#ifndef ENABLE_FILTERS
+                prog_name = NULL;
+#endif
+
+                break;
+        }
+
+        if ((ret = set_pipeline_stage(map_pipeline, stage, prog, prog_name)) != 0)
+        {
+            return ret;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
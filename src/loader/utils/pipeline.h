@@ -0,0 +1,13 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+
+int set_pipeline_stage(int map_pipeline, u32 stage, struct xdp_program* prog, const char* prog_name);
+int update_pipeline(int map_pipeline, struct xdp_program* prog, config__t* cfg);
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <loader/utils/reorder.h>
+
+/**
+ * Checks whether two inclusive ranges overlap.
+ *
+ * @param min_a The first range's minimum.
+ * @param max_a The first range's maximum.
+ * @param min_b The second range's minimum.
+ * @param max_b The second range's maximum.
+ *
+ * @return 1 if the ranges overlap or 0 otherwise.
+ */
+static int ranges_overlap(int min_a, int max_a, int min_b, int max_b)
+{
+    return min_a <= max_b && min_b <= max_a;
+}
+
+/**
+ * Checks whether two IPv4 prefixes overlap.
+ *
+ * @param ip_a The first IP (network byte order).
+ * @param cidr_a The first IP's CIDR.
+ * @param ip_b The second IP (network byte order).
+ * @param cidr_b The second IP's CIDR.
+ *
+ * @return 1 if the prefixes overlap or 0 otherwise.
+ */
+static int prefixes_overlap(u32 ip_a, u8 cidr_a, u32 ip_b, u8 cidr_b)
+{
+    u8 cidr = (cidr_a < cidr_b) ? cidr_a : cidr_b;
+
+    u32 mask = cidr ? htonl(0xFFFFFFFF << (32 - cidr)) : 0;
+
+    return ((ip_a ^ ip_b) & mask) == 0;
+}
+
+#if defined(ENABLE_IPV6) && defined(ALLOW_SINGLE_IP_V4_V6)
+/**
+ * Checks whether two IPv6 prefixes overlap.
+ *
+ * @param ip_a A pointer to the first IP (network byte order).
+ * @param cidr_a The first IP's prefix length.
+ * @param ip_b A pointer to the second IP (network byte order).
+ * @param cidr_b The second IP's prefix length.
+ *
+ * @return 1 if the prefixes overlap or 0 otherwise.
+ */
+static int prefixes6_overlap(u32* ip_a, u8 cidr_a, u32* ip_b, u8 cidr_b)
+{
+    int cidr = (cidr_a < cidr_b) ? cidr_a : cidr_b;
+
+    for (int i = 0; i < 4 && cidr > 0; i++, cidr -= 32)
+    {
+        if (!prefixes_overlap(ip_a[i], (cidr > 32) ? 32 : cidr, ip_b[i], (cidr > 32) ? 32 : cidr))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+#endif
+
+/**
+ * Checks whether two filter rules may match the same packet.
+ * 
+ * This only returns 0 if there is a field both rules match on with values that can't both match a packet, so swapping the rules can't change which rule a packet matches first.
+ *
+ * @param a A pointer to the first filter rule.
+ * @param b A pointer to the second filter rule.
+ *
+ * @return 1 if both rules may match the same packet or 0 otherwise.
+ */
+int filters_overlap(filter_t* a, filter_t* b)
+{
+    int proto_a = get_filter_protocol(a);
+    int proto_b = get_filter_protocol(b);
+
+    if (proto_a && proto_b && proto_a != proto_b)
+    {
+        return 0;
+    }
+
+    // TTL is checked for both IPv4 and IPv6 packets (hop limit).
+    if (!ranges_overlap(a->ip.do_min_ttl ? a->ip.min_ttl : 0, a->ip.do_max_ttl ? a->ip.max_ttl : 255, b->ip.do_min_ttl ? b->ip.min_ttl : 0, b->ip.do_max_ttl ? b->ip.max_ttl : 255))
+    {
+        return 0;
+    }
+
+    if (!ranges_overlap(a->ip.do_min_len ? a->ip.min_len : 0, a->ip.do_max_len ? a->ip.max_len : 65535, b->ip.do_min_len ? b->ip.min_len : 0, b->ip.do_max_len ? b->ip.max_len : 65535))
+    {
+        return 0;
+    }
+
+    // IP addresses of one IP version only exclude packets of the other IP version if ALLOW_SINGLE_IP_V4_V6 is defined.
+#if !defined(ENABLE_IPV6) || defined(ALLOW_SINGLE_IP_V4_V6)
+    if (a->ip.src_ip && b->ip.src_ip && !prefixes_overlap(a->ip.src_ip, a->ip.src_cidr, b->ip.src_ip, b->ip.src_cidr))
+    {
+        return 0;
+    }
+
+    if (a->ip.dst_ip && b->ip.dst_ip && !prefixes_overlap(a->ip.dst_ip, a->ip.dst_cidr, b->ip.dst_ip, b->ip.dst_cidr))
+    {
+        return 0;
+    }
+#endif
+
+#if defined(ENABLE_IPV6) && defined(ALLOW_SINGLE_IP_V4_V6)
+    int v4_a = a->ip.src_ip || a->ip.dst_ip;
+    int v4_b = b->ip.src_ip || b->ip.dst_ip;
+
+    int v6_a = a->ip.src_cidr6 || a->ip.dst_cidr6;
+    int v6_b = b->ip.src_cidr6 || b->ip.dst_cidr6;
+
+    // A rule with IPv4 addresses only matches IPv4 packets and a rule with IPv6 addresses only matches IPv6 packets.
+    if ((v4_a && v6_b) || (v6_a && v4_b))
+    {
+        return 0;
+    }
+
+    if (a->ip.src_cidr6 && b->ip.src_cidr6 && !prefixes6_overlap(a->ip.src_ip6, a->ip.src_cidr6, b->ip.src_ip6, b->ip.src_cidr6))
+    {
+        return 0;
+    }
+
+    if (a->ip.dst_cidr6 && b->ip.dst_cidr6 && !prefixes6_overlap(a->ip.dst_ip6, a->ip.dst_cidr6, b->ip.dst_ip6, b->ip.dst_cidr6))
+    {
+        return 0;
+    }
+#endif
+
+#ifndef ENABLE_IPV6
+    // TOS is only checked for IPv4 packets.
+    if (a->ip.do_tos && b->ip.do_tos && a->ip.tos != b->ip.tos)
+    {
+        return 0;
+    }
+#endif
+
+    if (proto_a == IPPROTO_TCP && proto_b == IPPROTO_TCP)
+    {
+        filter_tcp_t* ta = &a->tcp;
+        filter_tcp_t* tb = &b->tcp;
+
+        if (!ranges_overlap(ta->do_sport_min ? ta->sport_min : 0, ta->do_sport_max ? ta->sport_max : 65535, tb->do_sport_min ? tb->sport_min : 0, tb->do_sport_max ? tb->sport_max : 65535))
+        {
+            return 0;
+        }
+
+        if (!ranges_overlap(ta->do_dport_min ? ta->dport_min : 0, ta->do_dport_max ? ta->dport_max : 65535, tb->do_dport_min ? tb->dport_min : 0, tb->do_dport_max ? tb->dport_max : 65535))
+        {
+            return 0;
+        }
+
+        if ((ta->do_urg && tb->do_urg && ta->urg != tb->urg) ||
+            (ta->do_ack && tb->do_ack && ta->ack != tb->ack) ||
+            (ta->do_rst && tb->do_rst && ta->rst != tb->rst) ||
+            (ta->do_psh && tb->do_psh && ta->psh != tb->psh) ||
+            (ta->do_syn && tb->do_syn && ta->syn != tb->syn) ||
+            (ta->do_fin && tb->do_fin && ta->fin != tb->fin) ||
+            (ta->do_ece && tb->do_ece && ta->ece != tb->ece) ||
+            (ta->do_cwr && tb->do_cwr && ta->cwr != tb->cwr))
+        {
+            return 0;
+        }
+    }
+    else if (proto_a == IPPROTO_UDP && proto_b == IPPROTO_UDP)
+    {
+        filter_udp_t* ua = &a->udp;
+        filter_udp_t* ub = &b->udp;
+
+        if (!ranges_overlap(ua->do_sport_min ? ua->sport_min : 0, ua->do_sport_max ? ua->sport_max : 65535, ub->do_sport_min ? ub->sport_min : 0, ub->do_sport_max ? ub->sport_max : 65535))
+        {
+            return 0;
+        }
+
+        if (!ranges_overlap(ua->do_dport_min ? ua->dport_min : 0, ua->do_dport_max ? ua->dport_max : 65535, ub->do_dport_min ? ub->dport_min : 0, ub->do_dport_max ? ub->dport_max : 65535))
+        {
+            return 0;
+        }
+    }
+    else if (proto_a == IPPROTO_ICMP && proto_b == IPPROTO_ICMP)
+    {
+        if ((a->icmp.do_type && b->icmp.do_type && a->icmp.type != b->icmp.type) || (a->icmp.do_code && b->icmp.do_code && a->icmp.code != b->icmp.code))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Moves filter rules with more hits in front of the rules before them as long as the rules can't match the same packet.
+ * 
+ * Rules are only swapped with a neighbor they don't overlap with, so each packet still matches the same rule first.
+ * The caller needs to update the BPF maps afterwards.
+ *
+ * @param map_filter_stats The filter stats map BPF FD.
+ * @param cpus The amount of CPUs the host has.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return The amount of swaps on success (0 if the order didn't change) or a negative error code on failure.
+ */
+int reorder_filters(int map_filter_stats, int cpus, config__t* cfg)
+{
+    int ret = 0;
+    int swaps = 0;
+
+    int cnt = 0;
+
+    // The config indexes of set and enabled rules (these slots are refilled in the new order).
+    int* slots = calloc(MAX_CFG_FILTERS, sizeof(int));
+    int* order = calloc(MAX_CFG_FILTERS, sizeof(int));
+    u64* hits = calloc(MAX_CFG_FILTERS, sizeof(u64));
+    filter_t* filters = calloc(MAX_CFG_FILTERS, sizeof(filter_t));
+    filter_rule_cfg_t* rules = calloc(MAX_CFG_FILTERS, sizeof(filter_rule_cfg_t));
+
+    if (!slots || !order || !hits || !filters || !rules)
+    {
+        ret = -ENOMEM;
+
+        goto out;
+    }
+
+    for (int i = 0; i < cfg->filters_cnt; i++)
+    {
+        filter_rule_cfg_t* filter = &cfg->filters[i];
+
+        if (!filter->set || !filter->enabled)
+        {
+            continue;
+        }
+
+        filter_stats_t stats;
+
+        if ((ret = get_filter_stats(map_filter_stats, cpus, filter->id, &stats)) != 0)
+        {
+            goto out;
+        }
+
+        slots[cnt] = i;
+        order[cnt] = cnt;
+        hits[cnt] = stats.hits;
+        rules[cnt] = *filter;
+
+        build_filter(filter, &filters[cnt]);
+
+        cnt++;
+    }
+
+    // Insertion sort where a rule stops moving once it reaches a rule it overlaps with or a rule with at least as many hits.
+    for (int i = 1; i < cnt; i++)
+    {
+        for (int j = i; j > 0; j--)
+        {
+            int cur = order[j];
+            int prev = order[j - 1];
+
+            if (hits[cur] <= hits[prev] || filters_overlap(&filters[cur], &filters[prev]))
+            {
+                break;
+            }
+
+            order[j - 1] = cur;
+            order[j] = prev;
+
+            swaps++;
+        }
+    }
+
+    for (int i = 0; i < cnt; i++)
+    {
+        cfg->filters[slots[i]] = rules[order[i]];
+    }
+
+    ret = swaps;
+
+    out:
+        free(slots);
+        free(order);
+        free(hits);
+        free(filters);
+        free(rules);
+
+        return ret;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+#include <loader/utils/stats.h>
+
+int filters_overlap(filter_t* a, filter_t* b);
+int reorder_filters(int map_filter_stats, int cpus, config__t* cfg);
\ No newline at end of file
@@ -26,6 +26,19 @@ int calc_stats(int map_stats, int cpus, int per_second)
     u64 dropped = 0;
     u64 passed = 0;
 
+#ifdef ENABLE_BLOCK_BLOOM
+    u64 bloom_hits = 0;
+    u64 bloom_false_hits = 0;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    u64 inspected = 0;
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    u64 syn_proxy = 0;
+#endif
+
     if (bpf_map_lookup_elem(map_stats, &key, stats) != 0)
     {
         return EXIT_FAILURE;
@@ -46,6 +59,19 @@ int calc_stats(int map_stats, int cpus, int per_second)
         allowed += stats[i].allowed;
         dropped += stats[i].dropped;
         passed += stats[i].passed;
+
+#ifdef ENABLE_BLOCK_BLOOM
+        bloom_hits += stats[i].bloom_hits;
+        bloom_false_hits += stats[i].bloom_false_hits;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+        inspected += stats[i].inspected;
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+        syn_proxy += stats[i].syn_proxy;
+#endif
     }
 
     u64 allowed_val = allowed, dropped_val = dropped, passed_val = passed;
@@ -92,7 +118,137 @@ int calc_stats(int map_stats, int cpus, int per_second)
     printf("\033[1;31mDropped:\033[0m %s  |  ", dropped_str);
     printf("\033[1;34mPassed:\033[0m %s", passed_str);
 
+#ifdef ENABLE_BLOCK_BLOOM
+    // The percentage of bloom filter hits where the source wasn't inside of the block maps.
+    double bloom_fp = (bloom_hits > 0) ? ((double)bloom_false_hits / bloom_hits) * 100 : 0;
+
+    printf("  |  \033[1;33mBloom FP:\033[0m %.2f%%", bloom_fp);
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    // Inspected packets are consumed by the inspection threads and aren't included in the other counters.
+    printf("  |  \033[1;35mInspected:\033[0m %llu", inspected);
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+    // SYN-ACK and RST replies sent back to the source aren't included in the other counters.
+    printf("  |  \033[1;36mSYN Proxy:\033[0m %llu", syn_proxy);
+#endif
+
     fflush(stdout);
 
     return EXIT_SUCCESS;
+}
+
+/**
+ * Retrieves a filter rule's counters summed across all CPUs.
+ *
+ * @param map_filter_stats The filter stats map BPF FD.
+ * @param cpus The amount of CPUs the host has.
+ * @param id The filter rule's ID (config index).
+ * @param stats A pointer to store the counters in.
+ *
+ * @return 0 on success or error value of bpf_map_lookup_elem().
+ */
+int get_filter_stats(int map_filter_stats, int cpus, u32 id, filter_stats_t* stats)
+{
+    int ret;
+
+    filter_stats_t stats_cpus[MAX_CPUS];
+    memset(stats_cpus, 0, sizeof(stats_cpus));
+
+    memset(stats, 0, sizeof(*stats));
+
+    if ((ret = bpf_map_lookup_elem(map_filter_stats, &id, stats_cpus)) != 0)
+    {
+        return ret;
+    }
+
+    for (int i = 0; i < cpus && i < MAX_CPUS; i++)
+    {
+        stats->hits += stats_cpus[i].hits;
+        stats->bytes += stats_cpus[i].bytes;
+
+        if (stats_cpus[i].last_hit > stats->last_hit)
+        {
+            stats->last_hit = stats_cpus[i].last_hit;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Displays the hit and byte counters of each set filter rule.
+ *
+ * @param map_filter_stats The filter stats map BPF FD.
+ * @param cpus The amount of CPUs the host has.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return 0 on success or 1 on failure.
+ */
+int print_filter_stats(int map_filter_stats, int cpus, config__t* cfg)
+{
+    // The XDP program's timestamps are retrieved with bpf_ktime_get_ns() which uses the monotonic clock.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    u64 now_ns = (u64)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    printf("Filter Stats\n");
+
+    for (int i = 0; i < cfg->filters_cnt; i++)
+    {
+        filter_rule_cfg_t* filter = &cfg->filters[i];
+
+        if (!filter->set)
+        {
+            continue;
+        }
+
+        filter_stats_t stats;
+
+        if (get_filter_stats(map_filter_stats, cpus, filter->id, &stats) != 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        if (stats.last_hit > 0 && now_ns >= stats.last_hit)
+        {
+            printf("\t#%d => Hits: %llu | Bytes: %llu | Last Hit: %.2f seconds ago\n", filter->id + 1, stats.hits, stats.bytes, (now_ns - stats.last_hit) / 1e9);
+        }
+        else
+        {
+            printf("\t#%d => Hits: %llu | Bytes: %llu | Last Hit: N/A\n", filter->id + 1, stats.hits, stats.bytes);
+        }
+    }
+
+    printf("\n");
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Resets the counters of every filter rule.
+ *
+ * @param map_filter_stats The filter stats map BPF FD.
+ *
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+int reset_filter_stats(int map_filter_stats)
+{
+    int ret;
+
+    filter_stats_t stats_cpus[MAX_CPUS];
+    memset(stats_cpus, 0, sizeof(stats_cpus));
+
+    for (u32 i = 0; i < MAX_CFG_FILTERS; i++)
+    {
+        if ((ret = bpf_map_update_elem(map_filter_stats, &i, stats_cpus, BPF_ANY)) != 0)
+        {
+            return ret;
+        }
+    }
+
+    return 0;
 }
\ No newline at end of file
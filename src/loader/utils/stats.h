@@ -9,4 +9,8 @@
 
 #include <time.h>
 
-int calc_stats(int map_stats, int cpus, int per_second);
\ No newline at end of file
+int calc_stats(int map_stats, int cpus, int per_second);
+
+int get_filter_stats(int map_filter_stats, int cpus, u32 id, filter_stats_t* stats);
+int print_filter_stats(int map_filter_stats, int cpus, config__t* cfg);
+int reset_filter_stats(int map_filter_stats);
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include <loader/utils/tss.h>
+
+/**
+ * Retrieves a filter rule's exact match key if the rule only uses exact match fields.
+ *
+ * @param filter A pointer to the filter rule.
+ * @param key A pointer to store the exact match key in.
+ *
+ * @return 1 if the rule is an exact match rule or 0 otherwise.
+ */
+int get_filter_tss_key(filter_t* filter, filter_tss_key_t* key)
+{
+    memset(key, 0, sizeof(*key));
+
+    // Rate limits depend on the client's current rates.
+#ifdef ENABLE_RL_IP
+    if (filter->do_ip_pps || filter->do_ip_bps)
+    {
+        return 0;
+    }
+#endif
+
+#ifdef ENABLE_RL_FLOW
+    if (filter->do_flow_pps || filter->do_flow_bps)
+    {
+        return 0;
+    }
+#endif
+
+#ifdef ENABLE_FILTER_POLICE
+    // The exact match table doesn't store the token bucket settings.
+    if (filter->action == FILTER_ACTION_POLICE)
+    {
+        return 0;
+    }
+#endif
+
+    if (filter->ip.do_min_ttl || filter->ip.do_max_ttl || filter->ip.do_min_len || filter->ip.do_max_len || filter->ip.do_tos || filter->ip.do_frag)
+    {
+        return 0;
+    }
+
+#ifdef ENABLE_VLAN
+    // The exact match key doesn't include the VLAN ID.
+    if (filter->do_vlan_id)
+    {
+        return 0;
+    }
+#endif
+
+    if (filter->ip.src_ip)
+    {
+        if (filter->ip.src_cidr != 32)
+        {
+            return 0;
+        }
+
+        key->mask |= FILTERS_TSS_SRC_IP;
+        key->src_ip[0] = filter->ip.src_ip;
+    }
+
+    if (filter->ip.dst_ip)
+    {
+        if (filter->ip.dst_cidr != 32)
+        {
+            return 0;
+        }
+
+        key->mask |= FILTERS_TSS_DST_IP;
+        key->dst_ip[0] = filter->ip.dst_ip;
+    }
+
+#ifdef ENABLE_IPV6
+    if ((filter->ip.src_cidr6 && filter->ip.src_cidr6 != 128) || (filter->ip.dst_cidr6 && filter->ip.dst_cidr6 != 128))
+    {
+        return 0;
+    }
+
+    if (filter->ip.src_cidr6)
+    {
+        key->mask |= FILTERS_TSS_SRC_IP6;
+        memcpy(key->src_ip, filter->ip.src_ip6, sizeof(key->src_ip));
+    }
+
+    if (filter->ip.dst_cidr6)
+    {
+        key->mask |= FILTERS_TSS_DST_IP6;
+        memcpy(key->dst_ip, filter->ip.dst_ip6, sizeof(key->dst_ip));
+    }
+
+    if (key->mask & (FILTERS_TSS_SRC_IP | FILTERS_TSS_DST_IP | FILTERS_TSS_SRC_IP6 | FILTERS_TSS_DST_IP6))
+    {
+#ifndef ALLOW_SINGLE_IP_V4_V6
+        // IP addresses of the other IP version are ignored instead of excluding the packet.
+        return 0;
+#endif
+
+        if ((key->mask & (FILTERS_TSS_SRC_IP | FILTERS_TSS_DST_IP)) && (key->mask & (FILTERS_TSS_SRC_IP6 | FILTERS_TSS_DST_IP6)))
+        {
+            return 0;
+        }
+    }
+#endif
+
+    int proto = get_filter_protocol(filter);
+
+    if (proto == IPPROTO_TCP)
+    {
+        filter_tcp_t* tcp = &filter->tcp;
+
+        if (tcp->do_urg || tcp->do_ack || tcp->do_rst || tcp->do_psh || tcp->do_syn || tcp->do_fin || tcp->do_ece || tcp->do_cwr)
+        {
+            return 0;
+        }
+
+        if ((tcp->do_sport_min && (!tcp->do_sport_max || tcp->sport_min != tcp->sport_max)) || (tcp->do_dport_min && (!tcp->do_dport_max || tcp->dport_min != tcp->dport_max)))
+        {
+            return 0;
+        }
+
+        if (tcp->do_sport_min)
+        {
+            key->mask |= FILTERS_TSS_SPORT;
+            key->sport = tcp->sport_min;
+        }
+
+        if (tcp->do_dport_min)
+        {
+            key->mask |= FILTERS_TSS_DPORT;
+            key->dport = tcp->dport_min;
+        }
+    }
+    else if (proto == IPPROTO_UDP)
+    {
+        filter_udp_t* udp = &filter->udp;
+
+        if ((udp->do_sport_min && (!udp->do_sport_max || udp->sport_min != udp->sport_max)) || (udp->do_dport_min && (!udp->do_dport_max || udp->dport_min != udp->dport_max)))
+        {
+            return 0;
+        }
+
+        if (udp->do_sport_min)
+        {
+            key->mask |= FILTERS_TSS_SPORT;
+            key->sport = udp->sport_min;
+        }
+
+        if (udp->do_dport_min)
+        {
+            key->mask |= FILTERS_TSS_DPORT;
+            key->dport = udp->dport_min;
+        }
+    }
+    else if (proto == IPPROTO_ICMP)
+    {
+        if (filter->icmp.do_code || filter->icmp.do_type)
+        {
+            return 0;
+        }
+    }
+
+    if (proto)
+    {
+        key->mask |= FILTERS_TSS_PROTO;
+        key->protocol = proto;
+    }
+
+    // Rules without any fields match every packet and are processed as regular filter rules.
+    return key->mask != 0;
+}
+
+/**
+ * Checks whether a filter config rule is stored inside of the exact match table instead of the filters map.
+ *
+ * @param filter_cfg A pointer to the filter config rule.
+ *
+ * @return 1 on yes or 0 on no.
+ */
+int is_filter_tss(filter_rule_cfg_t* filter_cfg)
+{
+    filter_t filter = {0};
+    build_filter(filter_cfg, &filter);
+
+    filter_tss_key_t key;
+
+    return get_filter_tss_key(&filter, &key);
+}
+
+/**
+ * Deletes exact match rules that weren't inserted by the current update.
+ *
+ * @param map_filters_tss The exact match BPF map FD.
+ * @param gen The current generation.
+ *
+ * @return void
+ */
+static void delete_stale_tss(int map_filters_tss, u32 gen)
+{
+    filter_tss_key_t* stale = calloc(MAX_FILTERS_TSS, sizeof(filter_tss_key_t));
+
+    if (!stale)
+    {
+        return;
+    }
+
+    int stale_cnt = 0;
+
+    filter_tss_key_t key;
+    filter_tss_key_t prev_key;
+    filter_tss_val_t val;
+
+    void* prev = NULL;
+
+    // We can't delete while iterating since that would restart the iteration.
+    while (stale_cnt < MAX_FILTERS_TSS && bpf_map_get_next_key(map_filters_tss, prev, &key) == 0)
+    {
+        if (bpf_map_lookup_elem(map_filters_tss, &key, &val) == 0 && val.gen != gen)
+        {
+            stale[stale_cnt++] = key;
+        }
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+
+    for (int i = 0; i < stale_cnt; i++)
+    {
+        bpf_map_delete_elem(map_filters_tss, &stale[i]);
+    }
+
+    free(stale);
+}
+
+/**
+ * Inserts exact match filter rules into the exact match table along with the field masks the XDP program needs to probe.
+ *
+ * @param map_filters_tss The exact match BPF map FD.
+ * @param map_filters_tss_masks The exact match masks BPF map FD.
+ * @param cfg A pointer to the config structure.
+ *
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+int update_filters_tss(int map_filters_tss, int map_filters_tss_masks, config__t* cfg)
+{
+    int ret = 0;
+
+    u32 idx = 0;
+
+    filter_tss_masks_t masks = {0};
+    filter_tss_masks_t old_masks = {0};
+
+    bpf_map_lookup_elem(map_filters_tss_masks, &idx, &old_masks);
+
+    // Entries from previous updates are removed using the generation after the new entries are inserted.
+    masks.gen = old_masks.gen + 1;
+
+    filter_tss_key_t* keys = calloc(MAX_CFG_FILTERS, sizeof(filter_tss_key_t));
+    filter_tss_val_t* vals = calloc(MAX_CFG_FILTERS, sizeof(filter_tss_val_t));
+
+    if (!keys || !vals)
+    {
+        ret = -ENOMEM;
+
+        goto out;
+    }
+
+    int cnt = 0;
+
+    u32 priority = 0;
+    u32 filters_before = 0;
+
+    for (int i = 0; i < cfg->filters_cnt; i++)
+    {
+        filter_rule_cfg_t* filter_cfg = &cfg->filters[i];
+
+        if (!filter_cfg->set || !filter_cfg->enabled)
+        {
+            continue;
+        }
+
+        filter_t filter = {0};
+        build_filter(filter_cfg, &filter);
+
+        if (!get_filter_tss_key(&filter, &keys[cnt]))
+        {
+            filters_before++;
+            priority++;
+
+            continue;
+        }
+
+        filter_tss_val_t* val = &vals[cnt++];
+
+        val->gen = masks.gen;
+        val->priority = priority++;
+        val->filters_before = filters_before;
+        val->log = filter.log;
+        val->action = filter.action;
+        val->block_time = filter.block_time;
+
+#ifdef ENABLE_FILTER_LOGGING
+        val->sample_rate = filter.sample_rate;
+        val->sample_pps = filter.sample_pps;
+#endif
+
+        val->id = filter.id;
+
+        u32 mask = keys[cnt - 1].mask;
+
+        int found = 0;
+
+        for (u32 j = 0; j < masks.cnt; j++)
+        {
+            if (masks.masks[j] == mask)
+            {
+                found = 1;
+
+                break;
+            }
+        }
+
+        if (!found && masks.cnt < FILTERS_TSS_MAX_MASKS)
+        {
+            masks.masks[masks.cnt++] = mask;
+        }
+    }
+
+    // Insert in reverse order so the first rule wins if multiple rules use the same key.
+    for (int i = cnt - 1; i >= 0; i--)
+    {
+        if ((ret = bpf_map_update_elem(map_filters_tss, &keys[i], &vals[i], BPF_ANY)) != 0)
+        {
+            goto out;
+        }
+    }
+
+    if ((ret = bpf_map_update_elem(map_filters_tss_masks, &idx, &masks, BPF_ANY)) != 0)
+    {
+        goto out;
+    }
+
+    delete_stale_tss(map_filters_tss, masks.gen);
+
+    out:
+        free(keys);
+        free(vals);
+
+        return ret;
+}
\ No newline at end of file
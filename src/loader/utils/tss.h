@@ -0,0 +1,14 @@
+#pragma once
+
+#include <xdp/libxdp.h>
+
+#include <common/all.h>
+
+#include <errno.h>
+
+#include <loader/utils/config.h>
+#include <loader/utils/xdp.h>
+
+int get_filter_tss_key(filter_t* filter, filter_tss_key_t* key);
+int is_filter_tss(filter_rule_cfg_t* filter_cfg);
+int update_filters_tss(int map_filters_tss, int map_filters_tss_masks, config__t* cfg);
\ No newline at end of file
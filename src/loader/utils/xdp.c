@@ -1,5 +1,7 @@
 #include <loader/utils/xdp.h>
 
+#include <loader/utils/tss.h>
+
 /**
  * Finds a BPF map's FD.
  * 
@@ -97,6 +99,75 @@ struct bpf_object* get_bpf_obj(struct xdp_program* prog)
     return xdp_program__bpf_obj(prog);
 }
 
+/**
+ * Sets a read-only global variable (.rodata) of an XDP program that isn't loaded yet.
+ * 
+ * @param prog A pointer to the XDP program.
+ * @param var_name The variable's name.
+ * @param val A pointer to the new value.
+ * @param size The value's size (must match the variable's size).
+ * 
+ * @return 0 on success or a negative errno value on error.
+ */
+int set_rodata_var(struct xdp_program* prog, const char* var_name, const void* val, size_t size)
+{
+    struct bpf_object* obj = get_bpf_obj(prog);
+
+    struct bpf_map* map = bpf_object__find_map_by_name(obj, ".rodata");
+
+    if (!map)
+    {
+        return -ENOENT;
+    }
+
+    size_t map_size = 0;
+    u8* data = bpf_map__initial_value(map, &map_size);
+
+    if (!data)
+    {
+        return -EINVAL;
+    }
+
+    // The variable's offset inside of the section is retrieved from the program's BTF info.
+    struct btf* btf = bpf_object__btf(obj);
+
+    if (!btf)
+    {
+        return -ENOENT;
+    }
+
+    int sec_id = btf__find_by_name_kind(btf, ".rodata", BTF_KIND_DATASEC);
+
+    if (sec_id < 0)
+    {
+        return sec_id;
+    }
+
+    const struct btf_type* sec = btf__type_by_id(btf, sec_id);
+    const struct btf_var_secinfo* vars = btf_var_secinfos(sec);
+
+    for (int i = 0; i < btf_vlen(sec); i++)
+    {
+        const struct btf_type* var = btf__type_by_id(btf, vars[i].type);
+
+        if (strcmp(btf__name_by_offset(btf, var->name_off), var_name) != 0)
+        {
+            continue;
+        }
+
+        if (vars[i].size != size || vars[i].offset + size > map_size)
+        {
+            return -EINVAL;
+        }
+
+        memcpy(data + vars[i].offset, val, size);
+
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
 /**
  * Attempts to attach or detach (progfd = -1) a BPF/XDP program to an interface.
  * 
@@ -199,11 +270,14 @@ int attach_xdp(struct xdp_program *prog, char** mode, int ifidx, int detach, int
  * @param map_filters The filters BPF map FD.
  * @param idx The filter index to delete.
  * 
- * @return 0 on success or the error value of bpf_map_delete_elem().
+ * @return 0 on success or the error value of bpf_map_update_elem().
  */
 int delete_filter(int map_filters, u32 idx)
 {
-    return bpf_map_delete_elem(map_filters, &idx);
+    // Array map entries can't be deleted, so we unset the rule instead.
+    filter_t filter = {0};
+
+    return bpf_map_update_elem(map_filters, &idx, &filter, BPF_ANY);
 }
 
 /**
@@ -222,74 +296,108 @@ void delete_filters(int map_filters)
 }
 
 /**
- * Updates a filter rule.
+ * Converts a filter config rule to a filter rule used by the XDP program.
  * 
- * @param map_filters The filters BPF map FD.
  * @param filter_cfg A pointer to the filter config rule.
- * @param idx The filter index to insert or update.
+ * @param filter A pointer to the filter rule to fill out.
  * 
- * @return 0 on success or error value of bpf_map_update_elem().
+ * @return void
  */
-int update_filter(int map_filters, filter_rule_cfg_t* filter_cfg, int idx)
+void build_filter(filter_rule_cfg_t* filter_cfg, filter_t* filter)
 {
-    filter_t filter = {0};
+    filter->set = filter_cfg->set;
 
-    filter.set = filter_cfg->set;
+    filter->id = filter_cfg->id;
 
-    if (!filter_cfg->enabled)
-    {
-        return 0;
-    }
-    
     if (filter_cfg->enabled > -1)
     {
-        filter.enabled = filter_cfg->enabled;
+        filter->enabled = filter_cfg->enabled;
     }
 
     if (filter_cfg->log > -1)
     {
-        filter.log = filter_cfg->log;
+        filter->log = filter_cfg->log;
     }
 
     if (filter_cfg->action > -1)
     {
-        filter.action = filter_cfg->action;
+        filter->action = filter_cfg->action;
     }
 
     if (filter_cfg->block_time > -1)
     {
-        filter.block_time = filter_cfg->block_time;
+        filter->block_time = filter_cfg->block_time;
+    }
+
+#ifdef ENABLE_FILTER_LOGGING
+    if (filter_cfg->sample_rate > -1)
+    {
+        filter->sample_rate = filter_cfg->sample_rate;
     }
 
+    if (filter_cfg->sample_pps > -1)
+    {
+        filter->sample_pps = filter_cfg->sample_pps;
+    }
+#endif
+
 #ifdef ENABLE_RL_IP
     if (filter_cfg->ip_pps > -1)
     {
-        filter.do_ip_pps = 1;
+        filter->do_ip_pps = 1;
 
-        filter.ip_pps = (u64) filter_cfg->ip_pps;
+        filter->ip_pps = (u64) filter_cfg->ip_pps;
     }
 
     if (filter_cfg->ip_bps > -1)
     {
-        filter.do_ip_bps = 1;
+        filter->do_ip_bps = 1;
 
-        filter.ip_bps = (u64) filter_cfg->ip_bps;
+        filter->ip_bps = (u64) filter_cfg->ip_bps;
     }
 #endif
 
 #ifdef ENABLE_RL_FLOW
     if (filter_cfg->flow_pps > -1)
     {
-        filter.do_flow_pps = 1;
+        filter->do_flow_pps = 1;
 
-        filter.flow_pps = (u64) filter_cfg->flow_pps;
+        filter->flow_pps = (u64) filter_cfg->flow_pps;
     }
 
     if (filter_cfg->flow_bps > -1)
     {
-        filter.do_flow_bps = 1;
+        filter->do_flow_bps = 1;
 
-        filter.flow_bps = (u64) filter_cfg->flow_bps;
+        filter->flow_bps = (u64) filter_cfg->flow_bps;
+    }
+#endif
+
+#ifdef ENABLE_FILTER_POLICE
+    if (filter_cfg->police_rate > -1)
+    {
+        filter->police_rate = (u64) filter_cfg->police_rate;
+    }
+
+    // The burst defaults to one second worth of the rate.
+    if (filter_cfg->police_burst > -1)
+    {
+        filter->police_burst = (u64) filter_cfg->police_burst;
+    }
+    else
+    {
+        filter->police_burst = filter->police_rate;
+    }
+
+    filter->police_flow = filter_cfg->police_flow > 0;
+#endif
+
+#ifdef ENABLE_VLAN
+    if (filter_cfg->vlan_id > -1)
+    {
+        filter->do_vlan_id = 1;
+
+        filter->vlan_id = filter_cfg->vlan_id & VLAN_VID_MASK;
     }
 #endif
 
@@ -297,211 +405,298 @@ int update_filter(int map_filters, filter_rule_cfg_t* filter_cfg, int idx)
     {
         ip_range_t ip_range = parse_ip_range(filter_cfg->ip.src_ip);
 
-        filter.ip.src_ip = ip_range.ip;
-        filter.ip.src_cidr = ip_range.cidr;
+        filter->ip.src_ip = ip_range.ip;
+        filter->ip.src_cidr = ip_range.cidr;
     }
 
     if (filter_cfg->ip.dst_ip)
     {
         ip_range_t ip_range = parse_ip_range(filter_cfg->ip.dst_ip);
 
-        filter.ip.dst_ip = ip_range.ip;
-        filter.ip.dst_cidr = ip_range.cidr;
+        filter->ip.dst_ip = ip_range.ip;
+        filter->ip.dst_cidr = ip_range.cidr;
     }
 
 #ifdef ENABLE_IPV6
     if (filter_cfg->ip.src_ip6)
     {
-        struct in6_addr in;
-
-        inet_pton(AF_INET6, filter_cfg->ip.src_ip6, &in);
+        ip6_range_t ip_range = parse_ip6_range(filter_cfg->ip.src_ip6);
 
-        memcpy(filter.ip.src_ip6, in.__in6_u.__u6_addr32, 4);
+        if (ip_range.success)
+        {
+            memcpy(filter->ip.src_ip6, ip_range.ip, sizeof(filter->ip.src_ip6));
+            filter->ip.src_cidr6 = ip_range.cidr;
+        }
     }
 
     if (filter_cfg->ip.dst_ip6)
     {
-        struct in6_addr in;
-
-        inet_pton(AF_INET6, filter_cfg->ip.dst_ip6, &in);
+        ip6_range_t ip_range = parse_ip6_range(filter_cfg->ip.dst_ip6);
 
-        memcpy(filter.ip.dst_ip6, in.__in6_u.__u6_addr32, 4);
+        if (ip_range.success)
+        {
+            memcpy(filter->ip.dst_ip6, ip_range.ip, sizeof(filter->ip.dst_ip6));
+            filter->ip.dst_cidr6 = ip_range.cidr;
+        }
     }
 #endif
 
     if (filter_cfg->ip.min_ttl > -1)
     {
-        filter.ip.do_min_ttl = 1;
+        filter->ip.do_min_ttl = 1;
 
-        filter.ip.min_ttl = filter_cfg->ip.min_ttl;
+        filter->ip.min_ttl = filter_cfg->ip.min_ttl;
     }
 
     if (filter_cfg->ip.max_ttl > -1)
     {
-        filter.ip.do_max_ttl = 1;
+        filter->ip.do_max_ttl = 1;
 
-        filter.ip.max_ttl = filter_cfg->ip.max_ttl;
+        filter->ip.max_ttl = filter_cfg->ip.max_ttl;
     }
 
     if (filter_cfg->ip.min_len > -1)
     {
-        filter.ip.do_min_len = 1;
+        filter->ip.do_min_len = 1;
 
-        filter.ip.min_len = filter_cfg->ip.min_len;
+        filter->ip.min_len = filter_cfg->ip.min_len;
     }
 
     if (filter_cfg->ip.max_len > -1)
     {
-        filter.ip.do_max_len = 1;
+        filter->ip.do_max_len = 1;
 
-        filter.ip.max_len = filter_cfg->ip.max_len;
+        filter->ip.max_len = filter_cfg->ip.max_len;
     }
 
     if (filter_cfg->ip.tos > -1)
     {
-        filter.ip.do_tos = 1;
+        filter->ip.do_tos = 1;
+
+        filter->ip.tos = filter_cfg->ip.tos;
+    }
+
+    if (filter_cfg->ip.frag > -1)
+    {
+        filter->ip.do_frag = 1;
 
-        filter.ip.tos = filter_cfg->ip.tos;
+        filter->ip.frag = filter_cfg->ip.frag & IP_FRAG_ANY;
     }
 
     if (filter_cfg->tcp.enabled > -1)
     {
-        filter.tcp.enabled = filter_cfg->tcp.enabled;
+        filter->tcp.enabled = filter_cfg->tcp.enabled;
     }
 
     port_range_t tcp_src_port_range = parse_port_range(filter_cfg->tcp.sport);
 
     if (tcp_src_port_range.success)
     {
-        filter.tcp.do_sport_min = 1;
-        filter.tcp.do_sport_max = 1;
+        filter->tcp.do_sport_min = 1;
+        filter->tcp.do_sport_max = 1;
 
-        filter.tcp.sport_min = tcp_src_port_range.min;
-        filter.tcp.sport_max = tcp_src_port_range.max;
+        filter->tcp.sport_min = tcp_src_port_range.min;
+        filter->tcp.sport_max = tcp_src_port_range.max;
     }
 
     port_range_t tcp_dst_port_range = parse_port_range(filter_cfg->tcp.dport);
 
     if (tcp_dst_port_range.success)
     {
-        filter.tcp.do_dport_min = 1;
-        filter.tcp.do_dport_max = 1;
+        filter->tcp.do_dport_min = 1;
+        filter->tcp.do_dport_max = 1;
 
-        filter.tcp.dport_min = tcp_dst_port_range.min;
-        filter.tcp.dport_max = tcp_dst_port_range.max;
+        filter->tcp.dport_min = tcp_dst_port_range.min;
+        filter->tcp.dport_max = tcp_dst_port_range.max;
     }
 
     if (filter_cfg->tcp.urg > -1)
     {
-        filter.tcp.do_urg = 1;
+        filter->tcp.do_urg = 1;
 
-        filter.tcp.urg = filter_cfg->tcp.urg;
+        filter->tcp.urg = filter_cfg->tcp.urg;
     }
 
     if (filter_cfg->tcp.ack > -1)
     {
-        filter.tcp.do_ack = 1;
+        filter->tcp.do_ack = 1;
 
-        filter.tcp.ack = filter_cfg->tcp.ack;
+        filter->tcp.ack = filter_cfg->tcp.ack;
     }
 
     if (filter_cfg->tcp.rst > -1)
     {
-        filter.tcp.do_rst = 1;
+        filter->tcp.do_rst = 1;
 
-        filter.tcp.rst = filter_cfg->tcp.rst;
+        filter->tcp.rst = filter_cfg->tcp.rst;
     }
 
     if (filter_cfg->tcp.psh > -1)
     {
-        filter.tcp.do_psh = 1;
+        filter->tcp.do_psh = 1;
 
-        filter.tcp.psh = filter_cfg->tcp.psh;
+        filter->tcp.psh = filter_cfg->tcp.psh;
     }
 
     if (filter_cfg->tcp.syn > -1)
     {
-        filter.tcp.do_syn = 1;
+        filter->tcp.do_syn = 1;
 
-        filter.tcp.syn = filter_cfg->tcp.syn;
+        filter->tcp.syn = filter_cfg->tcp.syn;
     }
 
     if (filter_cfg->tcp.fin > -1)
     {
-        filter.tcp.do_fin = 1;
+        filter->tcp.do_fin = 1;
 
-        filter.tcp.fin = filter_cfg->tcp.fin;
+        filter->tcp.fin = filter_cfg->tcp.fin;
     }
 
     if (filter_cfg->tcp.ece > -1)
     {
-        filter.tcp.do_ece = 1;
+        filter->tcp.do_ece = 1;
 
-        filter.tcp.ece = filter_cfg->tcp.ece;
+        filter->tcp.ece = filter_cfg->tcp.ece;
     }
 
     if (filter_cfg->tcp.cwr > -1)
     {
-        filter.tcp.do_cwr = 1;
+        filter->tcp.do_cwr = 1;
 
-        filter.tcp.cwr = filter_cfg->tcp.cwr;
+        filter->tcp.cwr = filter_cfg->tcp.cwr;
     }
 
     if (filter_cfg->udp.enabled > -1)
     {
-        filter.udp.enabled = filter_cfg->udp.enabled;
+        filter->udp.enabled = filter_cfg->udp.enabled;
     }
 
     port_range_t udp_src_port_range = parse_port_range(filter_cfg->udp.sport);
 
     if (udp_src_port_range.success)
     {
-        filter.udp.do_sport_min = 1;
-        filter.udp.do_sport_max = 1;
+        filter->udp.do_sport_min = 1;
+        filter->udp.do_sport_max = 1;
 
-        filter.udp.sport_min = udp_src_port_range.min;
-        filter.udp.sport_max = udp_src_port_range.max;
+        filter->udp.sport_min = udp_src_port_range.min;
+        filter->udp.sport_max = udp_src_port_range.max;
     }
 
     port_range_t udp_dst_port_range = parse_port_range(filter_cfg->udp.dport);
 
     if (udp_dst_port_range.success)
     {
-        filter.udp.do_dport_min = 1;
-        filter.udp.do_dport_max = 1;
+        filter->udp.do_dport_min = 1;
+        filter->udp.do_dport_max = 1;
 
-        filter.udp.dport_min = udp_dst_port_range.min;
-        filter.udp.dport_max = udp_dst_port_range.max;
+        filter->udp.dport_min = udp_dst_port_range.min;
+        filter->udp.dport_max = udp_dst_port_range.max;
     }
 
     if (filter_cfg->icmp.enabled > -1)
     {
-        filter.icmp.enabled = filter_cfg->icmp.enabled;
+        filter->icmp.enabled = filter_cfg->icmp.enabled;
     }
 
     if (filter_cfg->icmp.code > -1)
     {
-        filter.icmp.do_code = 1;
+        filter->icmp.do_code = 1;
 
-        filter.icmp.code = filter_cfg->icmp.code;
+        filter->icmp.code = filter_cfg->icmp.code;
     }
 
     if (filter_cfg->icmp.type > -1)
     {
-        filter.icmp.do_type = 1;
+        filter->icmp.do_type = 1;
 
-        filter.icmp.type = filter_cfg->icmp.type;
+        filter->icmp.type = filter_cfg->icmp.type;
     }
+}
 
-    filter_t filter_cpus[MAX_CPUS];
-    memset(filter_cpus, 0, sizeof(filter_cpus));
+/**
+ * Converts every set and enabled filter config rule to filter rules using the same indexes update_filters() inserts into the filters map.
+ * 
+ * @param cfg A pointer to the config structure.
+ * @param filters Where to store the filter rules (must hold MAX_FILTERS rules).
+ * 
+ * @return The amount of filter rules.
+ */
+int build_filters(config__t* cfg, filter_t* filters)
+{
+    int cnt = 0;
+
+    for (int i = 0; i < cfg->filters_cnt && cnt < MAX_FILTERS; i++)
+    {
+        filter_rule_cfg_t* filter = &cfg->filters[i];
+
+        if (!filter->set || !filter->enabled)
+        {
+            continue;
+        }
 
-    for (int j = 0; j < MAX_CPUS; j++)
+#ifdef ENABLE_FILTERS_TSS
+        // Exact match rules are inserted into the tuple space search map instead.
+        if (is_filter_tss(filter))
+        {
+            continue;
+        }
+#endif
+
+        memset(&filters[cnt], 0, sizeof(filters[cnt]));
+        build_filter(filter, &filters[cnt++]);
+    }
+
+    return cnt;
+}
+
+/**
+ * Retrieves the protocol a filter rule matches on.
+ * 
+ * @param filter A pointer to the filter rule.
+ * 
+ * @return IPPROTO_TCP, IPPROTO_UDP, IPPROTO_ICMP, or 0 if the rule matches any protocol.
+ */
+int get_filter_protocol(filter_t* filter)
+{
+    // The XDP program checks TCP, then UDP, and then ICMP.
+    if (filter->tcp.enabled)
+    {
+        return IPPROTO_TCP;
+    }
+
+    if (filter->udp.enabled)
+    {
+        return IPPROTO_UDP;
+    }
+
+    if (filter->icmp.enabled)
+    {
+        return IPPROTO_ICMP;
+    }
+
+    return 0;
+}
+
+/**
+ * Updates a filter rule.
+ * 
+ * @param map_filters The filters BPF map FD.
+ * @param filter_cfg A pointer to the filter config rule.
+ * @param idx The filter index to insert or update.
+ * 
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+int update_filter(int map_filters, filter_rule_cfg_t* filter_cfg, int idx)
+{
+    if (!filter_cfg->enabled)
     {
-        filter_cpus[j] = filter;
+        return 0;
     }
 
-    return bpf_map_update_elem(map_filters, &idx, &filter_cpus, BPF_ANY);
+    filter_t filter = {0};
+    build_filter(filter_cfg, &filter);
+
+    return bpf_map_update_elem(map_filters, &idx, &filter, BPF_ANY);
 }
 
 /**
@@ -520,10 +715,6 @@ void update_filters(int map_filters, config__t *cfg)
     // Add a filter to the filter maps.
     for (int i = 0; i < cfg->filters_cnt; i++)
     {
-        // Delete previous rule from BPF map.
-        // We do this in the case rules were edited and were put out of order since the key doesn't uniquely map to a specific rule.
-        delete_filter(map_filters, i);
-
         filter_rule_cfg_t* filter = &cfg->filters[i];
 
         // Only insert set and enabled filters.
@@ -532,6 +723,21 @@ void update_filters(int map_filters, config__t *cfg)
             continue;
         }
 
+#ifdef ENABLE_FILTERS_TSS
+        // Exact match rules are inserted into the tuple space search map instead.
+        if (is_filter_tss(filter))
+        {
+            continue;
+        }
+#endif
+
+        if (cur_idx >= MAX_FILTERS)
+        {
+            fprintf(stderr, "[WARNING] Failed to update filter #%d since the filters map is full (%d)...\n", cur_idx, MAX_FILTERS);
+
+            continue;
+        }
+
         // Attempt to update filter.
         if ((ret = update_filter(map_filters, filter, cur_idx)) != 0)
         {
@@ -542,7 +748,114 @@ void update_filters(int map_filters, config__t *cfg)
 
         cur_idx++;
     }
+
+    // Unset the rules left over from the previous update.
+    // Rules are always stored from the first index on and the XDP program stops at the first rule that isn't set, so we can stop there as well.
+    filter_t filter;
+
+    for (u32 i = cur_idx; i < MAX_FILTERS; i++)
+    {
+        if (bpf_map_lookup_elem(map_filters, &i, &filter) != 0 || !filter.set)
+        {
+            break;
+        }
+
+        delete_filter(map_filters, i);
+    }
+}
+
+#ifdef ENABLE_FILTERS_CACHE
+/**
+ * Checks whether the verdict of a filter rule can be cached for a flow.
+ * 
+ * @param filter A pointer to the filter rule.
+ * 
+ * @return 1 on yes or 0 on no.
+ */
+static int is_filter_cacheable(filter_t* filter)
+{
+    // Rate limits depend on the client's current rates.
+#ifdef ENABLE_RL_IP
+    if (filter->do_ip_pps || filter->do_ip_bps)
+    {
+        return 0;
+    }
+#endif
+
+#ifdef ENABLE_RL_FLOW
+    if (filter->do_flow_pps || filter->do_flow_bps)
+    {
+        return 0;
+    }
+#endif
+
+    // Every match needs to be logged.
+    if (filter->log)
+    {
+        return 0;
+    }
+
+    // These fields may change between packets of the same flow.
+    if (filter->ip.do_min_ttl || filter->ip.do_max_ttl || filter->ip.do_min_len || filter->ip.do_max_len || filter->ip.do_tos)
+    {
+        return 0;
+    }
+
+    filter_tcp_t* tcp = &filter->tcp;
+
+    if (tcp->do_urg || tcp->do_ack || tcp->do_rst || tcp->do_psh || tcp->do_syn || tcp->do_fin || tcp->do_ece || tcp->do_cwr)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Bumps the verdict cache generation so verdicts cached with the previous filter rules are ignored.
+ * This also stores the amount of filter rules at the start of the filters map whose verdicts can be cached.
+ * 
+ * @param map_filters_cache_meta The verdict cache meta BPF map FD.
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+int update_filters_cache(int map_filters_cache_meta, config__t* cfg)
+{
+    filter_t* filters = calloc(MAX_FILTERS, sizeof(filter_t));
+
+    if (!filters)
+    {
+        return -ENOMEM;
+    }
+
+    int cnt = build_filters(cfg, filters);
+
+    u32 idx = 0;
+
+    filter_cache_meta_t meta = {0};
+    bpf_map_lookup_elem(map_filters_cache_meta, &idx, &meta);
+
+    meta.gen++;
+
+    // Verdicts are only cached if they don't depend on the first rule that can't be cached or any rule after it.
+    meta.cacheable = MAX_FILTERS;
+
+    for (int i = 0; i < cnt; i++)
+    {
+        if (!is_filter_cacheable(&filters[i]))
+        {
+            meta.cacheable = i;
+
+            break;
+        }
+    }
+
+    free(filters);
+
+    return bpf_map_update_elem(map_filters_cache_meta, &idx, &meta, BPF_ANY);
 }
+#endif
 
 /**
  * Pins a BPF map to the file system.
@@ -662,6 +975,132 @@ int add_block6(int map_block6, u128 ip, u64 expires)
     return bpf_map_update_elem(map_block6, &ip, &expires, BPF_ANY);
 }
 
+#ifdef ENABLE_BLOCK_SWEEP
+/**
+ * Removes expired entries from a block map using batch operations.
+ * 
+ * @param map_block The block map's FD.
+ * @param key_size The size of the block map's key.
+ * @param now The current time (nanoseconds since system boot).
+ * 
+ * @return The amount of removed entries or a negative error value of bpf_map_lookup_batch().
+ */
+static int sweep_block_map(int map_block, size_t key_size, u64 now)
+{
+    int ret = 0;
+
+    u8* keys = malloc(BLOCK_SWEEP_BATCH_SIZE * key_size);
+    u8* expired = malloc(BLOCK_SWEEP_BATCH_SIZE * key_size);
+    u64* vals = malloc(BLOCK_SWEEP_BATCH_SIZE * sizeof(u64));
+
+    if (!keys || !expired || !vals)
+    {
+        ret = -ENOMEM;
+
+        goto out;
+    }
+
+    u32 batch = 0;
+    void* in_batch = NULL;
+
+    int done = 0;
+
+    while (!done)
+    {
+        u32 cnt = BLOCK_SWEEP_BATCH_SIZE;
+
+        if (bpf_map_lookup_batch(map_block, in_batch, &batch, keys, vals, &cnt, NULL) != 0)
+        {
+            if (errno != ENOENT)
+            {
+                ret = -errno;
+
+                goto out;
+            }
+
+            // The last batch may still contain entries.
+            done = 1;
+        }
+
+        u32 expired_cnt = 0;
+
+        for (u32 i = 0; i < cnt; i++)
+        {
+            // Entries without an expiry time are permanent.
+            if (vals[i] > 0 && now > vals[i])
+            {
+                memcpy(expired + (expired_cnt++ * key_size), keys + (i * key_size), key_size);
+            }
+        }
+
+        if (expired_cnt > 0)
+        {
+            u32 deleted = expired_cnt;
+
+            // The batch delete stops at the first key that doesn't exist anymore (e.g. evicted by the LRU), so delete the remaining keys one at a time.
+            if (bpf_map_delete_batch(map_block, expired, &deleted, NULL) != 0)
+            {
+                for (u32 i = deleted; i < expired_cnt; i++)
+                {
+                    if (bpf_map_delete_elem(map_block, expired + (i * key_size)) == 0)
+                    {
+                        deleted++;
+                    }
+                }
+            }
+
+            ret += deleted;
+        }
+
+        in_batch = &batch;
+    }
+
+    out:
+        free(keys);
+        free(expired);
+        free(vals);
+
+        return ret;
+}
+
+/**
+ * Removes expired entries from the block maps.
+ * 
+ * If the XDP program blocks a source again between the lookup and delete, the new block is removed as well and the next matching packet blocks the source again.
+ * 
+ * @param map_block The IPv4 block map's FD.
+ * @param map_block6 The IPv6 block map's FD (ignored if below 0).
+ * 
+ * @return The amount of removed entries or a negative error value of bpf_map_lookup_batch().
+ */
+int sweep_blocks(int map_block, int map_block6)
+{
+    u64 now = get_mono_nano_time();
+
+    int ret;
+    int removed = 0;
+
+    if ((ret = sweep_block_map(map_block, sizeof(u32), now)) < 0)
+    {
+        return ret;
+    }
+
+    removed += ret;
+
+    if (map_block6 > -1)
+    {
+        if ((ret = sweep_block_map(map_block6, sizeof(u128), now)) < 0)
+        {
+            return ret;
+        }
+
+        removed += ret;
+    }
+
+    return removed;
+}
+#endif
+
 /**
  * Deletes an IPv4 range from the drop map.
  * 
@@ -730,4 +1169,127 @@ void update_range_drops(int map_range_drop, config__t* cfg)
 
         add_range_drop(map_range_drop, t.ip, t.cidr);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Deletes an IPv6 range from the drop map.
+ * 
+ * @param map_range_drop6 The IPv6 range drop map's FD.
+ * @param net The network IP (network byte order with the host bits cleared).
+ * @param cidr The network's CIDR.
+ * 
+ * @return 0 on success or error value of bpf_map_delete_elem(). 
+ */
+int delete_range_drop6(int map_range_drop6, u32* net, u8 cidr)
+{
+    lpm_trie_key6_t key = {0};
+    key.prefix_len = cidr;
+    memcpy(key.data, net, sizeof(key.data));
+
+    return bpf_map_delete_elem(map_range_drop6, &key);
+}
+
+/**
+ * Adds an IPv6 range to the drop map.
+ * 
+ * @param map_range_drop6 The IPv6 range drop map's FD.
+ * @param net The network IP (network byte order with the host bits cleared).
+ * @param cidr The network's CIDR.
+ * 
+ * @return 0 on success or error value of bpf_map_update_elem(). 
+ */
+int add_range_drop6(int map_range_drop6, u32* net, u8 cidr)
+{
+    lpm_trie_key6_t key = {0};
+    key.prefix_len = cidr;
+    memcpy(key.data, net, sizeof(key.data));
+
+    // The XDP program only checks whether an entry exists.
+    u64 val = cidr;
+
+    return bpf_map_update_elem(map_range_drop6, &key, &val, BPF_ANY);
+}
+
+/**
+ * Updates IPv6 ranges from config file.
+ * 
+ * @param map_range_drop6 The IPv6 range drop map's FD.
+ * @param cfg A pointer to the config file
+ * 
+ * @return void
+ */
+void update_range_drops6(int map_range_drop6, config__t* cfg)
+{
+    for (int i = 0; i < MAX_IP_RANGES; i++)
+    {
+        const char* range = cfg->drop_ranges6[i];
+
+        if (!range)
+        {
+            continue;
+        }
+
+        ip6_range_t t = parse_ip6_range(range);
+
+        if (!t.success)
+        {
+            log_msg(cfg, 1, 0, "[WARNING] Failed to parse IPv6 drop range '%s'...", range);
+
+            continue;
+        }
+
+        add_range_drop6(map_range_drop6, t.ip, t.cidr);
+    }
+}
+
+#ifdef ENABLE_SYN_PROXY
+/**
+ * Replaces the SYN proxy's protected destination ports with the ports from the config.
+ * 
+ * @param map_syn_proxy_ports The SYN proxy ports map's FD.
+ * @param cfg A pointer to the config structure.
+ * 
+ * @return 0 on success or error value of bpf_map_update_elem().
+ */
+int update_syn_proxy_ports(int map_syn_proxy_ports, config__t* cfg)
+{
+    int ret;
+
+    u16 keys[MAX_SYN_PROXY_PORTS];
+    int keys_cnt = 0;
+
+    u16 key;
+    u16 prev_key;
+
+    void* prev = NULL;
+
+    // We can't delete while iterating since that would restart the iteration.
+    while (keys_cnt < MAX_SYN_PROXY_PORTS && bpf_map_get_next_key(map_syn_proxy_ports, prev, &key) == 0)
+    {
+        keys[keys_cnt++] = key;
+
+        prev_key = key;
+        prev = &prev_key;
+    }
+
+    for (int i = 0; i < keys_cnt; i++)
+    {
+        bpf_map_delete_elem(map_syn_proxy_ports, &keys[i]);
+    }
+
+    for (int i = 0; i < cfg->syn_proxy_ports_cnt; i++)
+    {
+        // The XDP program looks up the TCP header's destination port (network byte order).
+        key = htons(cfg->syn_proxy_ports[i]);
+
+        u8 val = 1;
+
+        if ((ret = bpf_map_update_elem(map_syn_proxy_ports, &key, &val, BPF_ANY)) != 0)
+        {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <xdp/libxdp.h>
+#include <bpf/btf.h>
 
 #include  <common/all.h>
 
@@ -15,15 +16,23 @@ void set_libbpf_log_mode(int silent);
 
 struct xdp_program *load_bpf_obj(const char *file_name);
 struct bpf_object* get_bpf_obj(struct xdp_program* prog);
+int set_rodata_var(struct xdp_program* prog, const char* var_name, const void* val, size_t size);
 
 int attach_xdp(struct xdp_program *prog, char** mode, int ifidx, int detach, int force_skb, int force_offload);
 
 int delete_filter(int map_filters, u32 idx);
 void delete_filters(int map_filters);
 
+void build_filter(filter_rule_cfg_t* filter_cfg, filter_t* filter);
+int build_filters(config__t* cfg, filter_t* filters);
+int get_filter_protocol(filter_t* filter);
 int update_filter(int map_filters, filter_rule_cfg_t* filter, int idx);
 void update_filters(int map_filters, config__t *cfg);
 
+#ifdef ENABLE_FILTERS_CACHE
+int update_filters_cache(int map_filters_cache_meta, config__t* cfg);
+#endif
+
 int pin_bpf_map(struct bpf_object* obj, const char* pin_dir, const char* map_name);
 int unpin_bpf_map(struct bpf_object* obj, const char* pin_dir, const char* map_name);
 int get_map_fd_pin(const char* pin_dir, const char* map_name);
@@ -34,6 +43,18 @@ int add_block(int map_block, u32 ip, u64 expires);
 int delete_block6(int map_block6, u128 ip);
 int add_block6(int map_block6, u128 ip, u64 expires);
 
+#ifdef ENABLE_BLOCK_SWEEP
+int sweep_blocks(int map_block, int map_block6);
+#endif
+
 int delete_range_drop(int map_range_drop, u32 net, u8 cidr);
 int add_range_drop(int map_range_drop, u32 net, u8 cidr);
-void update_range_drops(int map_range_drop, config__t* cfg);
\ No newline at end of file
+void update_range_drops(int map_range_drop, config__t* cfg);
+
+int delete_range_drop6(int map_range_drop6, u32* net, u8 cidr);
+int add_range_drop6(int map_range_drop6, u32* net, u8 cidr);
+void update_range_drops6(int map_range_drop6, config__t* cfg);
+
+#ifdef ENABLE_SYN_PROXY
+int update_syn_proxy_ports(int map_syn_proxy_ports, config__t* cfg);
+#endif
\ No newline at end of file
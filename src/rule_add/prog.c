@@ -5,6 +5,10 @@
 #include <unistd.h>
 
 #include <loader/utils/xdp.h>
+#include <loader/utils/bv.h>
+#include <loader/utils/bucket.h>
+#include <loader/utils/tss.h>
+#include <loader/utils/bloom.h>
 #include <loader/utils/config.h>
 
 #include <rule_add/utils/cli.h>
@@ -29,17 +33,27 @@ int main(int argc, char *argv[])
     cli.action = -1;
     cli.block_time = -1;
 
+    cli.sample_rate = -1;
+    cli.sample_pps = -1;
+
     cli.ip_pps = -1;
     cli.ip_bps = -1;
 
     cli.flow_pps = -1;
     cli.flow_bps = -1;
 
+    cli.police_rate = -1;
+    cli.police_burst = -1;
+    cli.police_flow = -1;
+
+    cli.vlan_id = -1;
+
     cli.min_ttl = -1;
     cli.max_ttl = -1;
     cli.min_len = -1;
     cli.max_len = -1;
     cli.tos = -1;
+    cli.frag = -1;
 
     cli.tcp_enabled = -1;
     cli.tcp_urg = -1;
@@ -70,32 +84,41 @@ int main(int argc, char *argv[])
         printf("OPTIONS:\n");
         printf("  -c, --cfg         The path to the config file (default /etc/xdpfw/xdpfw.conf).\n");
         printf("  -s, --save        Saves the new config to file system.\n");
-        printf("  -m, --mode        The mode to use (0 = filters, 1 = IPv4 range drop, 2 = IP block map).\n");
+        printf("  -m, --mode        The mode to use (0 = filters, 1 = IP range drop, 2 = IP block map).\n");
         printf("  -i, --idx         The filters index to update when using filters mode (0) (index starts from 1; retrieve index using xdpfw -l).\n");
         printf("  -d, --ip          The IP range or single IP to add (for modes 1 and 2).\n");
-        printf("  -v, --v6          If set, parses IP address as IPv6 when adding to block map (for mode 2).\n");
+        printf("  -v, --v6          If set, parses IP address as IPv6 when adding to the range drop or block map (for modes 1 and 2).\n");
         printf("  -e, --expires     How long to block the IP for in seconds (for mode 2).\n\n");
 
         printf("Filter Mode Options:\n");
         printf("  --enabled         Enables or disables the dynamic filter.\n");
-        printf("  --action          The action when a packet matches (0 = drop, 1 = allow).\n");
+        printf("  --action          The action when a packet matches (0 = drop, 1 = allow, 2 = police, 3 = inspect).\n");
         printf("  --log             Enables or disables logging for this filter.\n");
-        printf("  --block-time      How long to add the source IP to the block list for if matched and the action is drop (0 = no time).\n\n");
+        printf("  --block-time      How long to add the source IP to the block list for if matched and the action is drop (0 = no time).\n");
+        printf("  --sample-rate     Only logs every Nth match of this filter.\n");
+        printf("  --sample-pps      The maximum amount of matches logged per second on each CPU for this filter.\n\n");
 
         printf("  --sip             The source IPv4 address (with CIDR support).\n");
         printf("  --dip             The destination IPv4 address (with CIDR support).\n");
-        printf("  --sip6            The source IPv6 address.\n");
-        printf("  --dip6            The destination IPv6 address.\n");
+        printf("  --sip6            The source IPv6 address (with prefix support).\n");
+        printf("  --dip6            The destination IPv6 address (with prefix support).\n");
         printf("  --min-ttl         The minimum IP TTL to match.\n");
         printf("  --max-ttl         The maximum IP TTL to match.\n");
         printf("  --min-len         The minimum packet length to match.\n");
         printf("  --max-len         The maximum packet length to match.\n");
-        printf("  --tos             The IP Type of Service to match.\n\n");
+        printf("  --tos             The IP Type of Service to match.\n");
+        printf("  --frag            The fragment type to match (0 = not fragmented, 1 = first fragment, 2 = non-first fragment, 3 = any fragment).\n\n");
 
         printf("  --ip-pps          The minimum IP-level packet rate (per second) to match.\n");
         printf("  --ip-bps          The minimum IP-level byte rate (per second) to match.\n");
         printf("  --flow-pps        The minimum flow-level packet rate (per second) to match.\n");
         printf("  --flow-bps        The minimum flow-level byte rate (per second) to match.\n\n");
+
+        printf("  --police-rate     The token bucket rate in bytes per second when the action is police.\n");
+        printf("  --police-burst    The token bucket size in bytes when the action is police (default = police rate).\n");
+        printf("  --police-flow     Uses a token bucket per source flow instead of per source IP when the action is police.\n\n");
+
+        printf("  --vlan            The outer VLAN ID to match (0 = untagged packets).\n\n");
         
         printf("  --tcp             Enable or disables matching on the TCP protocol.\n");
         printf("  --tsport          The TCP source port to match on.\n");
@@ -129,7 +152,8 @@ int main(int argc, char *argv[])
     }
 
     // Load config.
-    config__t cfg = {0};
+    // The config structure is static since it may be too large for the stack (see MAX_CFG_FILTERS).
+    static config__t cfg = {0};
     
     if (cli.save || cli.mode == 0)
     {
@@ -180,11 +204,13 @@ int main(int argc, char *argv[])
 
         if (idx < 0)
         {
-            fprintf(stderr, "Failed to retrieve filter next. Make sure you haven't exceeded the maximum filters allowed (%d).\n", MAX_FILTERS);
+            fprintf(stderr, "Failed to retrieve filter next. Make sure you haven't exceeded the maximum filters allowed (%d).\n", MAX_CFG_FILTERS);
 
             return EXIT_FAILURE;
         }
 
+        new_filter.id = idx;
+
         // Fill out new filter.
         if (cli.enabled > -1)
         {
@@ -206,6 +232,16 @@ int main(int argc, char *argv[])
             new_filter.block_time = cli.block_time;
         }
 
+        if (cli.sample_rate > -1)
+        {
+            new_filter.sample_rate = cli.sample_rate;
+        }
+
+        if (cli.sample_pps > -1)
+        {
+            new_filter.sample_pps = cli.sample_pps;
+        }
+
         if (cli.src_ip)
         {
             new_filter.ip.src_ip = cli.src_ip;
@@ -248,6 +284,26 @@ int main(int argc, char *argv[])
             new_filter.flow_bps = cli.flow_bps;
         }
 
+        if (cli.police_rate > -1)
+        {
+            new_filter.police_rate = cli.police_rate;
+        }
+
+        if (cli.police_burst > -1)
+        {
+            new_filter.police_burst = cli.police_burst;
+        }
+
+        if (cli.police_flow > -1)
+        {
+            new_filter.police_flow = cli.police_flow;
+        }
+
+        if (cli.vlan_id > -1)
+        {
+            new_filter.vlan_id = cli.vlan_id;
+        }
+
         if (cli.min_ttl > -1)
         {
             new_filter.ip.min_ttl = cli.min_ttl;
@@ -273,6 +329,11 @@ int main(int argc, char *argv[])
             new_filter.ip.tos = cli.tos;
         }
 
+        if (cli.frag > -1)
+        {
+            new_filter.ip.frag = cli.frag;
+        }
+
         if (cli.tcp_enabled > -1)
         {
             new_filter.tcp.enabled = cli.tcp_enabled;
@@ -358,6 +419,14 @@ int main(int argc, char *argv[])
             new_filter.icmp.type = cli.icmp_type;
         }
 
+        // Police rules without a rate have an empty token bucket and would drop every matching packet.
+        if (new_filter.action == FILTER_ACTION_POLICE && new_filter.police_rate < 1)
+        {
+            fprintf(stderr, "[ERROR] The police action requires a police rate (--police-rate).\n");
+
+            return EXIT_FAILURE;
+        }
+
         // Set filter at index.
         cfg.filters[idx] = new_filter;
 
@@ -365,6 +434,145 @@ int main(int argc, char *argv[])
         fprintf(stdout, "Updating filters (index %d)...\n", idx);
 
         update_filters(map_filters, &cfg);
+
+#ifdef ENABLE_FILTERS_BV
+        // Rebuild the bit-vector classifier maps.
+        int map_filters_bv = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv");
+        int map_filters_bv_idx = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv_idx");
+        int map_filters_bv_lpm = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv_lpm");
+
+        if (map_filters_bv < 0 || map_filters_bv_idx < 0 || map_filters_bv_lpm < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve bit-vector classifier BPF maps from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_bv(map_filters_bv, map_filters_bv_idx, map_filters_bv_lpm, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update bit-vector classifier maps (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+        // Rebuild the filter buckets.
+        int map_filter_buckets = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filter_buckets");
+
+        if (map_filter_buckets < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve BPF map 'map_filter_buckets' from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filter_buckets(map_filter_buckets, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update filter buckets (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+        // Rebuild the exact match table.
+        int map_filters_tss = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_tss");
+        int map_filters_tss_masks = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_tss_masks");
+
+        if (map_filters_tss < 0 || map_filters_tss_masks < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve exact match BPF maps from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_tss(map_filters_tss, map_filters_tss_masks, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update exact match filters (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+        // Invalidate the cached verdicts.
+        int map_filters_cache_meta = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_cache_meta");
+
+        if (map_filters_cache_meta < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve BPF map 'map_filters_cache_meta' from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_cache(map_filters_cache_meta, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update verdict cache generation (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+    }
+    // Handle IPv6 range drop mode.
+    else if (cli.mode == 1 && cli.v6)
+    {
+        printf("Using IPv6 range drop mode (1)...\n");
+
+        // Make sure IP range is specified.
+        if (!cli.ip)
+        {
+            fprintf(stderr, "No IP address or range specified. Please set an IP range using -d, --ip arguments.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        // Get range map.
+        int map_range_drop6 = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_range_drop6");
+
+        if (map_range_drop6 < 0)
+        {
+            fprintf(stderr, "Failed to retrieve 'map_range_drop6' BPF map FD.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        printf("Using 'map_range_drop6' FD => %d.\n", map_range_drop6);
+
+        // Parse IP range.
+        ip6_range_t range = parse_ip6_range(cli.ip);
+
+        if (!range.success)
+        {
+            fprintf(stderr, "Failed to parse IPv6 range '%s'.\n", cli.ip);
+
+            return EXIT_FAILURE;
+        }
+
+        // Attempt to add range.
+        if ((ret = add_range_drop6(map_range_drop6, range.ip, range.cidr)) != 0)
+        {
+            fprintf(stderr, "Error adding range to BPF map (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+
+        printf("Added IP range '%s' to IPv6 range drop map...\n", cli.ip);
+
+        if (cli.save)
+        {
+            // Get next available index.
+            int idx = get_next_ip6_drop_range_idx(&cfg);
+
+            if (idx < 0)
+            {
+                fprintf(stderr, "No available IPv6 drop range indexes. Perhaps the maximum IP ranges has been exceeded?\n");
+
+                return EXIT_FAILURE;
+            }
+
+            cfg.drop_ranges6[idx] = strdup(cli.ip);
+        }
     }
     // Handle IPv4 range drop mode.
     else if (cli.mode == 1)
@@ -461,19 +669,26 @@ int main(int argc, char *argv[])
                 return EXIT_FAILURE;
             }
 
+            // The XDP program uses the raw address bytes as the key.
             u128 ip = 0;
+            memcpy(&ip, addr.s6_addr, sizeof(ip));
 
-            for (int i = 0; i < 16; i++)
+            if ((ret = add_block6(map_block6, ip, expires_rel)) != 0)
             {
-                ip = (ip << 8) | addr.s6_addr[i];
+                fprintf(stderr, "Failed to add IP '%s' to BPF map (%d).\n", cli.ip, ret);
+
+                return EXIT_FAILURE;
             }
 
-            if ((ret = add_block6(map_block6, ip, expires_rel)) != 0)
+#ifdef ENABLE_BLOCK_BLOOM
+            // The XDP program skips the block map lookup if the source isn't inside of the bloom filter.
+            if ((ret = add_block_bloom_pin((u32*)&ip, 1)) != 0)
             {
-                fprintf(stderr, "Failed to add IP '%s' to BPF map (%d).\n", cli.ip, ret);
+                fprintf(stderr, "Failed to add IP '%s' to the block bloom filter (%d).\n", cli.ip, ret);
 
                 return EXIT_FAILURE;
             }
+#endif
         }
         else
         {
@@ -502,6 +717,16 @@ int main(int argc, char *argv[])
                 return EXIT_FAILURE;
             }
 
+#ifdef ENABLE_BLOCK_BLOOM
+            // The XDP program skips the block map lookup if the source isn't inside of the bloom filter.
+            if ((ret = add_block_bloom_pin(&addr.s_addr, 0)) != 0)
+            {
+                fprintf(stderr, "Failed to add IP '%s' to the block bloom filter (%d).\n", cli.ip, ret);
+
+                return EXIT_FAILURE;
+            }
+#endif
+
             if (cli.expires > 0)
             {
                 printf("Added '%s' to block map for %lld seconds...\n", cli.ip, cli.expires);
@@ -19,6 +19,8 @@ const struct option opts[] =
     { "action", required_argument, NULL, 29 },
     { "log", required_argument, NULL, 30 },
     { "block-time", required_argument, NULL, 31 },
+    { "sample-rate", required_argument, NULL, 39 },
+    { "sample-pps", required_argument, NULL, 40 },
 
     { "sip", required_argument, NULL, 0 },
     { "dip", required_argument, NULL, 1 },
@@ -29,6 +31,7 @@ const struct option opts[] =
     { "min-len", required_argument, NULL, 6 },
     { "max-len", required_argument, NULL, 7 },
     { "tos", required_argument, NULL, 8 },
+    { "frag", required_argument, NULL, 38 },
 
     { "ip-pps", required_argument, NULL, 9 },
     { "ip-bps", required_argument, NULL, 10 },
@@ -36,6 +39,12 @@ const struct option opts[] =
     { "flow-pps", required_argument, NULL, 32 },
     { "flow-bps", required_argument, NULL, 33 },
 
+    { "police-rate", required_argument, NULL, 34 },
+    { "police-burst", required_argument, NULL, 35 },
+    { "police-flow", required_argument, NULL, 36 },
+
+    { "vlan", required_argument, NULL, 37 },
+
     { "tcp", required_argument, NULL, 11 },
     { "tsport", required_argument, NULL, 12 },
     { "tdport", required_argument, NULL, 13 },
@@ -127,6 +136,16 @@ void parse_cli(cli_t* cli, int argc, char* argv[])
 
                 break;
 
+            case 39:
+                cli->sample_rate = atoi(optarg);
+
+                break;
+
+            case 40:
+                cli->sample_pps = atoi(optarg);
+
+                break;
+
             case 0:
                 cli->src_ip = optarg;
 
@@ -172,6 +191,11 @@ void parse_cli(cli_t* cli, int argc, char* argv[])
 
                 break;
 
+            case 38:
+                cli->frag = atoi(optarg);
+
+                break;
+
             case 9:
                 cli->ip_pps = strtoll(optarg, NULL, 10);
 
@@ -192,6 +216,26 @@ void parse_cli(cli_t* cli, int argc, char* argv[])
 
                 break;
 
+            case 34:
+                cli->police_rate = strtoll(optarg, NULL, 10);
+
+                break;
+
+            case 35:
+                cli->police_burst = strtoll(optarg, NULL, 10);
+
+                break;
+
+            case 36:
+                cli->police_flow = atoi(optarg);
+
+                break;
+
+            case 37:
+                cli->vlan_id = atoi(optarg);
+
+                break;
+
             case 11:
                 cli->tcp_enabled = atoi(optarg);
 
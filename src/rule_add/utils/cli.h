@@ -30,6 +30,9 @@ struct cli
     int action;
     int block_time;
 
+    int sample_rate;
+    int sample_pps;
+
     char* src_ip;
     char* dst_ip;
 
@@ -42,11 +45,18 @@ struct cli
     s64 flow_pps;
     s64 flow_bps;
 
+    s64 police_rate;
+    s64 police_burst;
+    int police_flow;
+
+    int vlan_id;
+
     int min_ttl;
     int max_ttl;
     int min_len;
     int max_len;
     int tos;
+    int frag;
 
     int tcp_enabled;
     char* tcp_sport;
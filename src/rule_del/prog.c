@@ -5,6 +5,9 @@
 #include <unistd.h>
 
 #include <loader/utils/xdp.h>
+#include <loader/utils/bv.h>
+#include <loader/utils/bucket.h>
+#include <loader/utils/tss.h>
 #include <loader/utils/config.h>
 
 #include <rule_del/utils/cli.h>
@@ -33,10 +36,10 @@ int main(int argc, char *argv[])
         printf("OPTIONS:\n");
         printf("  -c, --cfg         The path to the config file (default /etc/xdpfw/xdpfw.conf).\n");
         printf("  -s, --save        Saves the new config to file system.\n");
-        printf("  -m, --mode        The mode to use (0 = filters, 1 = IPv4 range drop, 2 = IP block map).\n");
+        printf("  -m, --mode        The mode to use (0 = filters, 1 = IP range drop, 2 = IP block map).\n");
         printf("  -i, --idx         The filters index to remove when using filters mode (0) (index starts from 1; retrieve index using xdpfw -l).\n");
         printf("  -d, --ip          The IP range or single IP to use (for modes 1 and 2).\n");
-        printf("  -v, --v6          If set, parses IP address as IPv6 when removing from block map (for mode 2).\n");
+        printf("  -v, --v6          If set, parses IP address as IPv6 when removing from the range drop or block map (for modes 1 and 2).\n");
 
         return EXIT_SUCCESS;
     }
@@ -50,7 +53,8 @@ int main(int argc, char *argv[])
     }
 
     // Load config.
-    config__t cfg = {0};
+    // The config structure is static since it may be too large for the stack (see MAX_CFG_FILTERS).
+    static config__t cfg = {0};
     
     if (cli.save || cli.mode == 0)
     {
@@ -97,7 +101,7 @@ int main(int argc, char *argv[])
         // Since each filter rule doesn't have any unique identifier other than the index, we need to use that.
         // However, rules that are not enabled are not inserted into the BPF map which can mismatch the indexes in the config and XDP program.
         // So we need to loop through each and ignore disabled rules.
-        for (int i = 0; i < MAX_FILTERS; i++)
+        for (int i = 0; i < MAX_CFG_FILTERS; i++)
         {
             filter_rule_cfg_t* filter = &cfg.filters[i];
 
@@ -133,6 +137,152 @@ int main(int argc, char *argv[])
         fprintf(stdout, "Updating filters...\n");
 
         update_filters(map_filters, &cfg);
+
+#ifdef ENABLE_FILTERS_BV
+        // Rebuild the bit-vector classifier maps.
+        int map_filters_bv = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv");
+        int map_filters_bv_idx = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv_idx");
+        int map_filters_bv_lpm = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_bv_lpm");
+
+        if (map_filters_bv < 0 || map_filters_bv_idx < 0 || map_filters_bv_lpm < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve bit-vector classifier BPF maps from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_bv(map_filters_bv, map_filters_bv_idx, map_filters_bv_lpm, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update bit-vector classifier maps (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+        // Rebuild the filter buckets.
+        int map_filter_buckets = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filter_buckets");
+
+        if (map_filter_buckets < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve BPF map 'map_filter_buckets' from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filter_buckets(map_filter_buckets, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update filter buckets (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+        // Rebuild the exact match table.
+        int map_filters_tss = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_tss");
+        int map_filters_tss_masks = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_tss_masks");
+
+        if (map_filters_tss < 0 || map_filters_tss_masks < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve exact match BPF maps from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_tss(map_filters_tss, map_filters_tss_masks, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update exact match filters (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+        // Invalidate the cached verdicts.
+        int map_filters_cache_meta = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_filters_cache_meta");
+
+        if (map_filters_cache_meta < 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to retrieve BPF map 'map_filters_cache_meta' from file system.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        if ((ret = update_filters_cache(map_filters_cache_meta, &cfg)) != 0)
+        {
+            fprintf(stderr, "[ERROR] Failed to update verdict cache generation (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+#endif
+    }
+    // Handle IPv6 range drop mode.
+    else if (cli.mode == 1 && cli.v6)
+    {
+        printf("Using IPv6 range drop mode (1)...\n");
+
+        // Make sure IP range is specified.
+        if (!cli.ip)
+        {
+            fprintf(stderr, "No IP address or range specified. Please set an IP range using -s, --ip arguments.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        // Get range map.
+        int map_range_drop6 = get_map_fd_pin(XDP_MAP_PIN_DIR, "map_range_drop6");
+
+        if (map_range_drop6 < 0)
+        {
+            fprintf(stderr, "Failed to retrieve 'map_range_drop6' BPF map FD.\n");
+
+            return EXIT_FAILURE;
+        }
+
+        printf("Using 'map_range_drop6' FD => %d.\n", map_range_drop6);
+
+        // Parse IP range.
+        ip6_range_t range = parse_ip6_range(cli.ip);
+
+        if (!range.success)
+        {
+            fprintf(stderr, "Failed to parse IPv6 range '%s'.\n", cli.ip);
+
+            return EXIT_FAILURE;
+        }
+
+        // Attempt to delete range.
+        if ((ret = delete_range_drop6(map_range_drop6, range.ip, range.cidr)) != 0)
+        {
+            fprintf(stderr, "Error deleting range from BPF map (%d).\n", ret);
+
+            return EXIT_FAILURE;
+        }
+
+        printf("Removed IP range '%s'...\n", cli.ip);
+
+        if (cli.save)
+        {
+            // Loop through IPv6 drop ranges and unset if found.
+            for (int i = 0; i < MAX_IP_RANGES; i++)
+            {
+                const char* cur_range = cfg.drop_ranges6[i];
+
+                if (!cur_range)
+                {
+                    continue;
+                }
+
+                if (strcmp(cur_range, cli.ip) != 0)
+                {
+                    continue;
+                }
+
+                free((void*)cfg.drop_ranges6[i]);
+                cfg.drop_ranges6[i] = NULL;
+            }
+        }
     }
     // Handle IPv4 range drop mode.
     else if (cli.mode == 1)
@@ -229,12 +379,9 @@ int main(int argc, char *argv[])
                 return EXIT_FAILURE;
             }
 
+            // The XDP program uses the raw address bytes as the key.
             u128 ip = 0;
-
-            for (int i = 0; i < 16; i++)
-            {
-                ip = (ip << 8) | addr.s6_addr[i];
-            }
+            memcpy(&ip, addr.s6_addr, sizeof(ip));
 
             if ((ret = delete_block6(map_block6, ip)) != 0)
             {
@@ -12,8 +12,21 @@
 
 #include <xdp/utils/rl.h>
 #include <xdp/utils/rule.h>
+#include <xdp/utils/bv.h>
+#include <xdp/utils/bucket.h>
+#include <xdp/utils/tss.h>
+#include <xdp/utils/codegen.h>
 #include <xdp/utils/stats.h>
 #include <xdp/utils/helpers.h>
+#include <xdp/utils/features.h>
+#include <xdp/utils/pipeline.h>
+#include <xdp/utils/police.h>
+#include <xdp/utils/bloom.h>
+#include <xdp/utils/cache.h>
+#include <xdp/utils/vlan.h>
+#include <xdp/utils/ipv6.h>
+#include <xdp/utils/frag.h>
+#include <xdp/utils/synproxy.h>
 
 #include <xdp/utils/maps.h>
 
@@ -23,247 +36,699 @@ struct
     __uint(XDP_PASS, 1);
 } XDP_RUN_CONFIG(xdp_prog_main);
 
-SEC("xdp_prog")
-int xdp_prog_main(struct xdp_md *ctx)
+/**
+ * Checks whether the source IP is inside of the block map and removes the entry if the block expired (unless expired entries are removed by the loader).
+ * 
+ * @param stats A pointer to the stats map value.
+ * @param src_ip The IPv4 source address.
+ * @param src_ip6 A pointer to the IPv6 source address.
+ * @param ipv6 Whether the packet is an IPv6 packet.
+ * 
+ * @return 1 if the packet should be dropped or 0 otherwise.
+ */
+static __always_inline int check_block(stats_t* stats, u32 src_ip, u128* src_ip6, int ipv6)
 {
-    // Initialize data.
-    void *data_end = (void *)(long)ctx->data_end;
-    void *data = (void *)(long)ctx->data;
+#ifdef ENABLE_BLOCK_BLOOM
+    // Most sources were never blocked, so skip the block map lookups if the source isn't inside of the bloom filter.
+    if (!check_block_bloom(ipv6 ? (u32*)src_ip6 : &src_ip, ipv6))
+    {
+        return 0;
+    }
 
-    // Retrieve stats map value.
-    u32 key = 0;
-    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+    inc_pkt_stats(stats, STATS_TYPE_BLOOM_HIT);
+#endif
 
-    // Scan ethernet header.
-    struct ethhdr *eth = data;
+    u64 *blocked = NULL;
 
-    // Check if the ethernet header is valid.
-    if (unlikely(eth + 1 > (struct ethhdr *)data_end))
+    if (!ipv6)
     {
-        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+        blocked = bpf_map_lookup_elem(&map_block, &src_ip);
+    }
+#ifdef ENABLE_IPV6
+    else
+    {
+        blocked = bpf_map_lookup_elem(&map_block6, src_ip6);
+    }
+#endif
 
-        return XDP_DROP;
+    if (blocked == NULL)
+    {
+#ifdef ENABLE_BLOCK_BLOOM
+        inc_pkt_stats(stats, STATS_TYPE_BLOOM_FALSE_HIT);
+#endif
+
+        return 0;
     }
 
-    // Check Ethernet protocol.
+    // The clock is only read for blocked sources with an expiry time.
+    if (*blocked > 0 && get_time_ns() > *blocked)
+    {
+#ifndef ENABLE_BLOCK_SWEEP
+        // Remove element from map.
+        if (!ipv6)
+        {
+            bpf_map_delete_elem(&map_block, &src_ip);
+        }
 #ifdef ENABLE_IPV6
-    if (unlikely(eth->h_proto != htons(ETH_P_IP) && eth->h_proto != htons(ETH_P_IPV6)))
-#else
-    if (unlikely(eth->h_proto != htons(ETH_P_IP)))
+        else
+        {
+            bpf_map_delete_elem(&map_block6, src_ip6);
+        }
+#endif
 #endif
+
+        return 0;
+    }
+
+#ifdef DO_STATS_ON_BLOCK_MAP
+    // Increase blocked stats entry.
+    if (features.stats_on_block_map)
     {
-        inc_pkt_stats(stats, STATS_TYPE_PASSED);
-        
-        return XDP_PASS;
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
     }
+#endif
 
-    // Initialize IP headers.
-    struct iphdr *iph = NULL;
-    struct ipv6hdr *iph6 = NULL;
-    u128 src_ip6 = 0;
+    // They're still blocked. Drop the packet.
+    return 1;
+}
 
-    // Set IPv4 and IPv6 common variables.
-    if (eth->h_proto == htons(ETH_P_IP))
+#ifdef ENABLE_IP_RANGE_DROP
+/**
+ * Checks whether the source IP is inside of the IP range drop maps.
+ * 
+ * @param stats A pointer to the stats map value.
+ * @param src_ip The IPv4 source address.
+ * @param src_ip6 A pointer to the IPv6 source address.
+ * @param ipv6 Whether the packet is an IPv6 packet.
+ * 
+ * @return 1 if the packet should be dropped or 0 otherwise.
+ */
+static __always_inline int check_range_drop(stats_t* stats, u32 src_ip, u128* src_ip6, int ipv6)
+{
+    if (!ipv6)
     {
-        iph = data + sizeof(struct ethhdr);
-
-        if (unlikely(iph + 1 > (struct iphdr *)data_end))
+        if (!check_ip_range_drop(src_ip))
         {
-            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
-
-            return XDP_DROP;
+            return 0;
         }
     }
 #ifdef ENABLE_IPV6
+    else if (!check_ip6_range_drop(src_ip6))
+    {
+        return 0;
+    }
+#else
     else
     {
-        iph6 = data + sizeof(struct ethhdr);
+        return 0;
+    }
+#endif
 
-        if (unlikely(iph6 + 1 > (struct ipv6hdr *)data_end))
+#ifdef DO_STATS_ON_IP_RANGE_DROP_MAP
+    if (features.stats_on_ip_range_drop_map)
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    }
+#endif
+
+    return 1;
+}
+#endif
+
+#ifdef ENABLE_FILTERS
+/**
+ * Finds the first filter rule matching the packet using the enabled filter engine.
+ * 
+ * @param rule A pointer to the rule context (rule->matched is set on match).
+ * 
+ * @return void
+ */
+static __always_inline void match_rules(rule_ctx_t* rule)
+{
+#ifdef ENABLE_FILTERS_TSS
+    // Exact match rules are looked up first so we only need to process the filter rules with a higher priority.
+    filter_tss_val_t* tss = lookup_tss(rule);
+
+    rule->max_idx = tss ? tss->filters_before : MAX_FILTERS;
+#endif
+
+#if defined(FILTERS_CODEGEN)
+    process_rules_gen(rule);
+#elif defined(ENABLE_FILTERS_BV)
+    classify_bv(rule);
+#elif defined(ENABLE_FILTERS_BUCKETS)
+    classify_buckets(rule);
+#elif defined(USE_NEW_LOOP)
+    bpf_loop(MAX_FILTERS, process_rule, rule, 0);
+#else
+#pragma unroll 30
+    for (int i = 0; i < MAX_FILTERS; i++)
+    {
+        if (process_rule(i, rule))
+        {
+            break;
+        }
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+    if (!rule->matched && tss)
+    {
+        set_tss_matched(tss, rule);
+    }
+#endif
+}
+
+/**
+ * Applies the action of the matched filter rule.
+ * 
+ * @param stats A pointer to the stats map value.
+ * @param rule A pointer to the rule context.
+ * @param src_ip The IPv4 source address.
+ * @param src_ip6 A pointer to the IPv6 source address.
+ * @param ipv6 Whether the packet is an IPv6 packet.
+ * @param now The current timestamp.
+ * 
+ * @return The XDP action.
+ */
+static __always_inline int do_rule_action(stats_t* stats, rule_ctx_t* rule, u32 src_ip, u128* src_ip6, int ipv6, u64 now)
+{
+#ifdef ENABLE_FILTER_POLICE
+    // Only packets exceeding the rule's rate and burst are dropped.
+    if (rule->action == FILTER_ACTION_POLICE)
+    {
+        if (!police_packet(rule, src_ip, src_ip6, ipv6, now))
         {
             inc_pkt_stats(stats, STATS_TYPE_DROPPED);
 
             return XDP_DROP;
         }
 
-        memcpy(&src_ip6, iph6->saddr.in6_u.u6_addr32, sizeof(src_ip6));
+        inc_pkt_stats(stats, STATS_TYPE_ALLOWED);
+
+        return XDP_PASS;
     }
 #endif
-    
-    // We only want to process TCP, UDP, and ICMP protocols.
-    if ((iph && iph->protocol != IPPROTO_UDP && iph->protocol != IPPROTO_TCP && iph->protocol != IPPROTO_ICMP) || (iph6 && iph6->nexthdr != IPPROTO_UDP && iph6->nexthdr != IPPROTO_TCP && iph6->nexthdr != IPPROTO_ICMP))
+
+#ifdef ENABLE_FILTER_INSPECT
+    // Packets are passed when the RX queue doesn't have an AF_XDP socket (e.g. the loader isn't running).
+    if (rule->action == FILTER_ACTION_INSPECT)
     {
-        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+        u32* base = bpf_map_lookup_elem(&map_xsks_ifaces, &rule->ifindex);
 
-        return XDP_PASS;
-    }
+        if (base && rule->rx_queue < MAX_CPUS && bpf_redirect_map(&map_xsks, *base + rule->rx_queue, XDP_PASS) == XDP_REDIRECT)
+        {
+            inc_pkt_stats(stats, STATS_TYPE_INSPECTED);
 
-    // Retrieve nanoseconds since system boot as timestamp.
-    u64 now = bpf_ktime_get_ns();
+            return XDP_REDIRECT;
+        }
 
-    // Check block map.
-    u64 *blocked = NULL;
+        inc_pkt_stats(stats, STATS_TYPE_ALLOWED);
 
-    if (iph)
-    {
-        blocked = bpf_map_lookup_elem(&map_block, &iph->saddr);
-    }
-#ifdef ENABLE_IPV6
-    else
-    {
-        blocked = bpf_map_lookup_elem(&map_block6, &src_ip6);
+        return XDP_PASS;
     }
 #endif
-    
-    if (blocked != NULL)
+
+    if (rule->action == 0)
     {
-        if (*blocked > 0 && now > *blocked)
+        // Before dropping, update the block map.
+        if (rule->block_time > 0)
         {
-            // Remove element from map.
-            if (iph)
+            u64 new_time = now + (rule->block_time * NANO_TO_SEC);
+            
+            if (!ipv6)
             {
-                bpf_map_delete_elem(&map_block, &iph->saddr);
+                bpf_map_update_elem(&map_block, &src_ip, &new_time, BPF_ANY);
             }
 #ifdef ENABLE_IPV6
             else
             {
-                bpf_map_delete_elem(&map_block6, &src_ip6);
+                bpf_map_update_elem(&map_block6, src_ip6, &new_time, BPF_ANY);
             }
+#endif      
+
+#ifdef ENABLE_BLOCK_BLOOM
+            add_block_bloom(ipv6 ? (u32*)src_ip6 : &src_ip, ipv6);
 #endif
         }
-        else
-        {
-#ifdef DO_STATS_ON_BLOCK_MAP
-            // Increase blocked stats entry.
-            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
-#endif
 
-            // They're still blocked. Drop the packet.
-            return XDP_DROP;
-        }
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+        return XDP_DROP;
     }
 
-#ifdef ENABLE_IP_RANGE_DROP
-    if (iph && check_ip_range_drop(iph->saddr))
+    inc_pkt_stats(stats, STATS_TYPE_ALLOWED);
+
+    return XDP_PASS;
+}
+
+#ifdef ENABLE_FRAG_CACHE
+/**
+ * Applies the first fragment's XDP action to a later fragment of the same datagram.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param stats A pointer to the stats map value.
+ * @param action The first fragment's XDP action.
+ * @param matched Whether the first fragment's XDP action came from a filter rule.
+ * 
+ * @return The XDP action.
+ */
+static __always_inline int do_frag_action(struct xdp_md* ctx, stats_t* stats, u8 action, u8 matched)
+{
+    if (action == XDP_DROP)
     {
-#ifdef DO_STATS_ON_IP_RANGE_DROP_MAP
         inc_pkt_stats(stats, STATS_TYPE_DROPPED);
-#endif
 
         return XDP_DROP;
     }
-#endif
-
-#ifdef ENABLE_FILTERS
-    // Retrieve total packet length.
-    u16 pkt_len = data_end - data;
 
-    // Parse layer-4 headers and determine source port and protocol.
-    struct tcphdr *tcph = NULL;
-    struct udphdr *udph = NULL;
-    struct icmphdr *icmph = NULL;
+#ifdef ENABLE_FILTER_INSPECT
+    // The first fragment was sent to the loader, so the rest of the datagram is sent to the socket of the fragment's RX queue as well.
+    if (action == XDP_REDIRECT)
+    {
+        rule_ctx_t rule = {0};
+        rule.action = FILTER_ACTION_INSPECT;
+        rule.ifindex = ctx->ingress_ifindex;
+        rule.rx_queue = ctx->rx_queue_index;
 
-    struct icmp6hdr *icmp6h = NULL;
+        return do_rule_action(stats, &rule, 0, NULL, 0, 0);
+    }
+#endif
 
-    u16 src_port = 0;
+    // Count the fragment the same way as its first fragment (allowed by a filter rule or passed without a match).
+    inc_pkt_stats(stats, matched ? STATS_TYPE_ALLOWED : STATS_TYPE_PASSED);
 
-#ifdef ENABLE_FILTER_LOGGING
-    u16 dst_port = 0;
+    return XDP_PASS;
+}
+#endif
 #endif
 
-    u8 protocol = 0;
-    
-    if (iph)
+#ifdef ENABLE_TAIL_CALLS
+/**
+ * Stores the packet's parsed headers inside of the pipeline context and tail calls the first XDP program stage.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param stats A pointer to the stats map value.
+ * @param iph A pointer to the IPv4 header (NULL for IPv6 packets).
+ * @param iph6 A pointer to the IPv6 header (NULL for IPv4 packets).
+ * @param src_ip6 A pointer to the IPv6 source address.
+ * @param l4_proto The layer-4 protocol.
+ * @param l4 A pointer to the layer-4 header (the fragment's payload for non-first fragments).
+ * @param frag The fragment type (IP_FRAG_*).
+ * @param frag_id The fragment identification (network byte order).
+ * @param vlan The outer VLAN ID (-1 if the packet isn't tagged).
+ * 
+ * @return The XDP action (only if no stage is set).
+ */
+static __always_inline int start_pipeline(struct xdp_md* ctx, stats_t* stats, struct iphdr* iph, struct ipv6hdr* iph6, u128* src_ip6, u8 l4_proto, void* l4, u8 frag, u32 frag_id, int vlan)
+{
+    void *data_end = (void *)(long)ctx->data_end;
+    void *data = (void *)(long)ctx->data;
+
+    pipeline_ctx_t* pctx = get_pipeline_ctx();
+
+    if (!pctx)
     {
-        protocol = iph->protocol;
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
 
-        switch (iph->protocol)
-        {
-            case IPPROTO_TCP:
-                // Scan TCP header.
-                tcph = data + sizeof(struct ethhdr) + (iph->ihl * 4);
+        return XDP_PASS;
+    }
 
-                // Check TCP header.
-                if (unlikely(tcph + 1 > (struct tcphdr *)data_end))
-                {
-                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    // The timestamp is retrieved by the first stage that needs it.
+    pctx->now = 0;
+    pctx->pkt_len = data_end - data;
 
-                    return XDP_DROP;
-                }
+    pctx->ip_pps = 0;
+    pctx->ip_bps = 0;
+    pctx->flow_pps = 0;
+    pctx->flow_bps = 0;
 
-                src_port = tcph->source;
+    pctx->l3_off = (iph ? (void*)iph : (void*)iph6) - data;
+    pctx->l4_off = l4 - data;
+    pctx->frag = frag;
 
-#ifdef ENABLE_FILTER_LOGGING
-                dst_port = tcph->dest;
-#endif
+#ifdef ENABLE_VLAN
+    pctx->vlan_id = (vlan > -1) ? vlan : 0;
 
-                break;
+#ifdef ENABLE_VLAN_STATS
+    pctx->vlan_tagged = vlan > -1;
+#endif
+#endif
 
-            case IPPROTO_UDP:
-                // Scan UDP header.
-                udph = data + sizeof(struct ethhdr) + (iph->ihl * 4);
+    if (iph)
+    {
+        pctx->ipv6 = 0;
+        pctx->src_ip = iph->saddr;
+        pctx->src_ip6 = 0;
+        pctx->protocol = l4_proto;
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        pctx->ipv6 = 1;
+        pctx->src_ip = 0;
+        pctx->src_ip6 = *src_ip6;
+        pctx->protocol = l4_proto;
+    }
+#endif
 
-                // Check UDP header.
-                if (unlikely(udph + 1 > (struct udphdr *)data_end))
-                {
-                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    // Make sure the layer-4 header is within bounds before any stage uses it.
+    pipeline_hdrs_t hdrs = {0};
 
-                    return XDP_DROP;
-                }
+    if (load_pipeline_hdrs(ctx, pctx, &hdrs))
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
 
-                src_port = udph->source;
+        return XDP_DROP;
+    }
 
-#ifdef ENABLE_FILTER_LOGGING
-                dst_port = udph->dest;
-#endif
+    pctx->src_port = 0;
+    pctx->dst_port = 0;
 
-                break;
+    if (hdrs.tcph)
+    {
+        pctx->src_port = hdrs.tcph->source;
+        pctx->dst_port = hdrs.tcph->dest;
+    }
+    else if (hdrs.udph)
+    {
+        pctx->src_port = hdrs.udph->source;
+        pctx->dst_port = hdrs.udph->dest;
+    }
 
-            case IPPROTO_ICMP:
-                // Scan ICMP header.
-                icmph = data + sizeof(struct ethhdr) + (iph->ihl * 4);
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FRAG_CACHE)
+    pctx->frag_id = frag_id;
+    pctx->frag_seen = 0;
 
-                // Check ICMP header.
-                if (unlikely(icmph + 1 > (struct icmphdr *)data_end))
-                {
-                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    // Non-first fragments use their first fragment's ports in the rate limit stage and its verdict in the filters stage.
+    if (frag == IP_FRAG_LATER)
+    {
+        frag_key_t frag_key;
+        init_frag_key(&frag_key, hdrs.iph, hdrs.iph6, l4_proto, frag_id);
 
-                    return XDP_DROP;
-                }
+        frag_val_t* frag_val = lookup_frag_cache(&frag_key, get_time_ns());
 
-                break;
+        if (frag_val)
+        {
+            pctx->src_port = frag_val->src_port;
+            pctx->dst_port = frag_val->dst_port;
+            pctx->frag_seen = 1;
+            pctx->frag_action = frag_val->action;
+            pctx->frag_matched = frag_val->matched;
         }
     }
-#ifdef ENABLE_IPV6
-    else if (iph6)
-    {
-        protocol = iph6->nexthdr;
+#endif
 
-        switch (iph6->nexthdr)
-        {
-            case IPPROTO_TCP:
-                // Scan TCP header.
-                tcph = data + sizeof(struct ethhdr) + sizeof(struct ipv6hdr);
+    pipeline_next(ctx, PIPELINE_STAGE_BLOCK);
 
-                // Check TCP header.
-                if (unlikely(tcph + 1 > (struct tcphdr *)data_end))
-                {
-                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    // No stage is set.
+    inc_pkt_stats(stats, STATS_TYPE_PASSED);
 
-                    return XDP_DROP;
-                }
+    return XDP_PASS;
+}
 
-                src_port = tcph->source;
+/**
+ * Finishes an XDP program stage and counts drops towards the packet's VLAN (the main XDP program doesn't see the actions of the stages).
+ * 
+ * @param pctx A pointer to the pipeline context.
+ * @param action The stage's XDP action.
+ * 
+ * @return The XDP action.
+ */
+static __always_inline int end_pipeline_stage(pipeline_ctx_t* pctx, int action)
+{
+#ifdef ENABLE_VLAN_STATS
+    if (pctx->vlan_tagged && action == XDP_DROP)
+    {
+        inc_vlan_stats(pctx->vlan_id, 0, 1);
+    }
+#endif
 
-#ifdef ENABLE_FILTER_LOGGING
-                dst_port = tcph->dest;
+    return action;
+}
 #endif
 
-                break;
+/**
+ * Parses a packet and processes it using the block map, IP range drop map, rate limits, and filter rules.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param vlan A pointer to store the packet's outer VLAN ID in (-1 if the packet isn't tagged).
+ * 
+ * @return The XDP action.
+ */
+static __always_inline int process_pkt(struct xdp_md *ctx, int* vlan)
+{
+    // Initialize data.
+    void *data_end = (void *)(long)ctx->data_end;
+    void *data = (void *)(long)ctx->data;
+
+    // Retrieve stats map value.
+    u32 key = 0;
+    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+
+    // Scan ethernet header.
+    struct ethhdr *eth = data;
+
+    // Check if the ethernet header is valid.
+    if (unlikely(eth + 1 > (struct ethhdr *)data_end))
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+        return XDP_DROP;
+    }
+
+    void* l3 = data + sizeof(struct ethhdr);
+    u16 h_proto = eth->h_proto;
+    u16 vlan_id = 0;
+
+#ifdef ENABLE_VLAN
+    // Skip VLAN tags.
+    int tags = parse_vlan(eth, data_end, &l3, &h_proto, &vlan_id);
+
+    if (unlikely(tags < 0))
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+        return XDP_DROP;
+    }
+
+    if (tags > 0)
+    {
+        *vlan = vlan_id;
+
+#ifdef ENABLE_VLAN_STATS
+        inc_vlan_stats(vlan_id, data_end - data, 0);
+#endif
+    }
+#endif
+
+    // Check Ethernet protocol.
+#ifdef ENABLE_IPV6
+    if (unlikely(h_proto != htons(ETH_P_IP) && (!features.ipv6 || h_proto != htons(ETH_P_IPV6))))
+#else
+    if (unlikely(h_proto != htons(ETH_P_IP)))
+#endif
+    {
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+        
+        return XDP_PASS;
+    }
+
+    // Initialize IP headers.
+    struct iphdr *iph = NULL;
+    struct ipv6hdr *iph6 = NULL;
+    u128 src_ip6 = 0;
+
+    // The layer-4 protocol and header (non-first fragments don't contain the layer-4 header).
+    u8 l4_proto = 0;
+    void* l4 = l3;
+
+    u8 frag = IP_FRAG_NONE;
+    u32 frag_id = 0;
+
+    // Set IPv4 and IPv6 common variables.
+    if (h_proto == htons(ETH_P_IP))
+    {
+        iph = l3;
+
+        if (unlikely(iph + 1 > (struct iphdr *)data_end))
+        {
+            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+            return XDP_DROP;
+        }
+
+        l4_proto = iph->protocol;
+        l4 = l3 + (iph->ihl * 4);
+
+        // Only the first fragment contains the layer-4 header.
+        if (iph->frag_off & htons(IPV4_FRAG_OFFSET))
+        {
+            frag = IP_FRAG_LATER;
+        }
+        else if (iph->frag_off & htons(IPV4_FRAG_MF))
+        {
+            frag = IP_FRAG_FIRST;
+        }
+
+        frag_id = iph->id;
+    }
+#ifdef ENABLE_IPV6
+    else
+    {
+        iph6 = l3;
+
+        if (unlikely(iph6 + 1 > (struct ipv6hdr *)data_end))
+        {
+            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+            return XDP_DROP;
+        }
+
+        memcpy(&src_ip6, iph6->saddr.in6_u.u6_addr32, sizeof(src_ip6));
+
+        // Skip extension headers.
+        if (unlikely(parse_ip6_exthdrs(iph6, data_end, &l4_proto, &l4, &frag, &frag_id) != 0))
+        {
+            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+            return XDP_DROP;
+        }
+    }
+#endif
+    
+    // We only want to process TCP, UDP, and ICMP protocols.
+    if ((iph && l4_proto != IPPROTO_UDP && l4_proto != IPPROTO_TCP && l4_proto != IPPROTO_ICMP) || (iph6 && l4_proto != IPPROTO_UDP && l4_proto != IPPROTO_TCP && l4_proto != IPPROTO_ICMPV6))
+    {
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+        return XDP_PASS;
+    }
+
+#ifdef ENABLE_TAIL_CALLS
+    // The remaining checks run inside of separate XDP programs (stages) that are chained with tail calls.
+    return start_pipeline(ctx, stats, iph, iph6, &src_ip6, l4_proto, l4, frag, frag_id, *vlan);
+#else
+    // Check block map.
+    if (check_block(stats, iph ? iph->saddr : 0, &src_ip6, iph6 != NULL))
+    {
+        return XDP_DROP;
+    }
+
+#ifdef ENABLE_IP_RANGE_DROP
+    if (check_range_drop(stats, iph ? iph->saddr : 0, &src_ip6, iph6 != NULL))
+    {
+        return XDP_DROP;
+    }
+#endif
+
+#ifdef ENABLE_FILTERS
+    // Retrieve total packet length.
+    u16 pkt_len = data_end - data;
+
+    // Parse layer-4 headers and determine source port and protocol.
+    struct tcphdr *tcph = NULL;
+    struct udphdr *udph = NULL;
+    struct icmphdr *icmph = NULL;
+
+    struct icmp6hdr *icmp6h = NULL;
+
+    u16 src_port = 0;
+
+#ifdef ENABLE_FILTER_LOGGING
+    u16 dst_port = 0;
+#endif
+
+    u8 protocol = l4_proto;
+    
+    // Non-first fragments don't contain the layer-4 header.
+    if (iph && frag != IP_FRAG_LATER)
+    {
+        switch (iph->protocol)
+        {
+            case IPPROTO_TCP:
+                // Scan TCP header.
+                tcph = l3 + (iph->ihl * 4);
+
+                // Check TCP header.
+                if (unlikely(tcph + 1 > (struct tcphdr *)data_end))
+                {
+                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+                    return XDP_DROP;
+                }
+
+                src_port = tcph->source;
+
+#ifdef ENABLE_FILTER_LOGGING
+                dst_port = tcph->dest;
+#endif
+
+                break;
 
             case IPPROTO_UDP:
                 // Scan UDP header.
-                udph = data + sizeof(struct ethhdr) + sizeof(struct ipv6hdr);
+                udph = l3 + (iph->ihl * 4);
+
+                // Check UDP header.
+                if (unlikely(udph + 1 > (struct udphdr *)data_end))
+                {
+                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+                    return XDP_DROP;
+                }
+
+                src_port = udph->source;
+
+#ifdef ENABLE_FILTER_LOGGING
+                dst_port = udph->dest;
+#endif
+
+                break;
+
+            case IPPROTO_ICMP:
+                // Scan ICMP header.
+                icmph = l3 + (iph->ihl * 4);
+
+                // Check ICMP header.
+                if (unlikely(icmph + 1 > (struct icmphdr *)data_end))
+                {
+                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+                    return XDP_DROP;
+                }
+
+                break;
+        }
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6 && frag != IP_FRAG_LATER)
+    {
+        switch (l4_proto)
+        {
+            case IPPROTO_TCP:
+                // Scan TCP header.
+                tcph = l4;
+
+                // Check TCP header.
+                if (unlikely(tcph + 1 > (struct tcphdr *)data_end))
+                {
+                    inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+                    return XDP_DROP;
+                }
+
+                src_port = tcph->source;
+
+#ifdef ENABLE_FILTER_LOGGING
+                dst_port = tcph->dest;
+#endif
+
+                break;
+
+            case IPPROTO_UDP:
+                // Scan UDP header.
+                udph = l4;
 
                 // Check TCP header.
                 if (unlikely(udph + 1 > (struct udphdr *)data_end))
@@ -283,7 +748,7 @@ int xdp_prog_main(struct xdp_md *ctx)
 
             case IPPROTO_ICMPV6:
                 // Scan ICMPv6 header.
-                icmp6h = data + sizeof(struct ethhdr) + sizeof(struct ipv6hdr);
+                icmp6h = l4;
 
                 // Check ICMPv6 header.
                 if (unlikely(icmp6h + 1 > (struct icmp6hdr *)data_end))
@@ -299,6 +764,29 @@ int xdp_prog_main(struct xdp_md *ctx)
 #endif
 
 #ifdef ENABLE_FILTERS
+    // Retrieve nanoseconds since system boot as timestamp (only needed by the filters).
+    u64 now = get_time_ns();
+
+#ifdef ENABLE_FRAG_CACHE
+    // Non-first fragments count towards their first fragment's flow and receive its verdict.
+    frag_key_t frag_key;
+    frag_val_t* frag_val = NULL;
+
+    if (frag != IP_FRAG_NONE)
+    {
+        init_frag_key(&frag_key, iph, iph6, l4_proto, frag_id);
+    }
+
+    if (frag == IP_FRAG_LATER && (frag_val = lookup_frag_cache(&frag_key, now)))
+    {
+        src_port = frag_val->src_port;
+
+#ifdef ENABLE_FILTER_LOGGING
+        dst_port = frag_val->dst_port;
+#endif
+    }
+#endif
+
     // Update client stats (PPS/BPS).
     u64 ip_pps = 0;
     u64 ip_bps = 0;
@@ -310,28 +798,102 @@ int xdp_prog_main(struct xdp_md *ctx)
     if (iph)
     {
 #ifdef ENABLE_RL_IP
-        update_ip_stats(&ip_pps, &ip_bps, iph->saddr, pkt_len, now);
+        if (features.rl_ip)
+        {
+            update_ip_stats(&ip_pps, &ip_bps, iph->saddr, pkt_len, now);
+        }
 #endif
 
 #ifdef ENABLE_RL_FLOW
-        update_flow_stats(&flow_pps, &flow_bps, iph->saddr, src_port, protocol, pkt_len, now);
+        if (features.rl_flow)
+        {
+            update_flow_stats(&flow_pps, &flow_bps, iph->saddr, src_port, protocol, pkt_len, now);
+        }
 #endif
     }
 #ifdef ENABLE_IPV6
     else if (iph6)
     {
 #ifdef ENABLE_RL_IP
-        update_ip6_stats(&ip_pps, &ip_bps, &src_ip6, pkt_len, now);
+        if (features.rl_ip)
+        {
+            update_ip6_stats(&ip_pps, &ip_bps, &src_ip6, pkt_len, now);
+        }
 #endif
 
 #ifdef ENABLE_RL_FLOW
-        update_flow6_stats(&flow_pps, &flow_bps, &src_ip6, src_port, protocol, pkt_len, now);
+        if (features.rl_flow)
+        {
+            update_flow6_stats(&flow_pps, &flow_bps, &src_ip6, src_port, protocol, pkt_len, now);
+        }
 #endif
     }
 #endif
 #endif
 #endif
 
+#ifdef ENABLE_SYN_PROXY
+    // The SYN proxy runs after the rate limit updates (like the filters stage of the tail call pipeline) so SYNs still count toward their source's rates.
+    int syn_proxy = do_syn_proxy(ctx, stats, iph, iph6, tcph);
+
+    if (syn_proxy > -1)
+    {
+        return syn_proxy;
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+    // Established flows reuse their cached verdict which skips the filter rules (the rate limit counters are still updated above so cached flows count toward their source's rates).
+    filter_cache_key_t cache_key;
+    filter_cache_meta_t cache_meta;
+
+    // First fragments aren't cached so their verdict is stored for the later fragments.
+    int cache = frag == IP_FRAG_NONE && init_filter_cache(&cache_key, &cache_meta, iph, iph6, tcph, udph);
+
+#ifdef ENABLE_VLAN
+    cache_key.vlan_id = vlan_id;
+#endif
+
+    if (cache)
+    {
+        filter_cache_val_t* cached = lookup_filter_cache(&cache_key, &cache_meta);
+
+        if (cached)
+        {
+            if (!cached->matched)
+            {
+                inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+                return XDP_PASS;
+            }
+
+            rule_ctx_t rule = {0};
+            rule.pkt_len = pkt_len;
+
+#ifdef ENABLE_FILTER_INSPECT
+            rule.ifindex = ctx->ingress_ifindex;
+            rule.rx_queue = ctx->rx_queue_index;
+#endif
+
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_POLICE)
+            rule.protocol = protocol;
+            rule.src_port = src_port;
+#endif
+
+            set_filter_cache_matched(cached, &rule, now);
+
+            return do_rule_action(stats, &rule, iph ? iph->saddr : 0, &src_ip6, iph6 != NULL, now);
+        }
+    }
+#endif
+
+#ifdef ENABLE_FRAG_CACHE
+    if (frag_val)
+    {
+        return do_frag_action(ctx, stats, frag_val->action, frag_val->matched);
+    }
+#endif
+
     // Create rule context.
     rule_ctx_t rule = {0};
     rule.flow_pps = flow_pps;
@@ -340,10 +902,27 @@ int xdp_prog_main(struct xdp_md *ctx)
     rule.ip_bps = ip_bps;
     rule.pkt_len = pkt_len;
 
-#ifdef ENABLE_FILTER_LOGGING
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_STATS)
     rule.now = now;
+#endif
+
+    rule.frag = frag;
+
+#ifdef ENABLE_VLAN
+    rule.vlan_id = vlan_id;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    rule.ifindex = ctx->ingress_ifindex;
+    rule.rx_queue = ctx->rx_queue_index;
+#endif
+
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_POLICE)
     rule.protocol = protocol;
     rule.src_port = src_port;
+#endif
+
+#ifdef ENABLE_FILTER_LOGGING
     rule.dst_port = dst_port;
 #endif
     
@@ -356,62 +935,357 @@ int xdp_prog_main(struct xdp_md *ctx)
     rule.iph6 = iph6;
     rule.icmph6 = icmp6h;
 
-#ifdef USE_NEW_LOOP
-    bpf_loop(MAX_FILTERS, process_rule, &rule, 0);
-#else
-#pragma unroll 30
-    for (int i = 0; i < MAX_FILTERS; i++)
+    match_rules(&rule);
+
+#ifdef ENABLE_FILTERS_CACHE
+    if (cache)
     {
-        if (process_rule(i, &rule))
-        {
-            break;
-        }
+        update_filter_cache(&cache_key, &cache_meta, &rule);
     }
 #endif
 
     if (rule.matched)
     {
-        goto matched;
+        int action = do_rule_action(stats, &rule, iph ? iph->saddr : 0, &src_ip6, iph6 != NULL, now);
+
+#ifdef ENABLE_FRAG_CACHE
+        if (frag == IP_FRAG_FIRST)
+        {
+            update_frag_cache(&frag_key, action, 1, tcph, udph, now);
+        }
+#endif
+
+        return action;
     }
+
+#ifdef ENABLE_FRAG_CACHE
+    if (frag == IP_FRAG_FIRST)
+    {
+        update_frag_cache(&frag_key, XDP_PASS, 0, tcph, udph, now);
+    }
+#endif
 #endif
 
     inc_pkt_stats(stats, STATS_TYPE_PASSED);
             
     return XDP_PASS;
+#endif
+}
+
+SEC("xdp_prog")
+int xdp_prog_main(struct xdp_md *ctx)
+{
+    int vlan = -1;
+
+    int action = process_pkt(ctx, &vlan);
+
+#ifdef ENABLE_VLAN_STATS
+    // Packets processed by the XDP program stages (ENABLE_TAIL_CALLS) don't return here, so the stages count their own drops.
+    if (vlan > -1 && action == XDP_DROP)
+    {
+        inc_vlan_stats(vlan, 0, 1);
+    }
+#endif
+
+    return action;
+}
+
+#ifdef ENABLE_TAIL_CALLS
+SEC("xdp")
+int xdp_prog_block(struct xdp_md *ctx)
+{
+    u32 key = 0;
+    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+
+    pipeline_ctx_t* pctx = get_pipeline_ctx();
+
+    if (!pctx)
+    {
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+        return XDP_PASS;
+    }
+
+    if (check_block(stats, pctx->src_ip, &pctx->src_ip6, pctx->ipv6))
+    {
+        return end_pipeline_stage(pctx, XDP_DROP);
+    }
+
+    pipeline_next(ctx, PIPELINE_STAGE_BLOCK + 1);
+
+    inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+    return XDP_PASS;
+}
+
+#ifdef ENABLE_IP_RANGE_DROP
+SEC("xdp")
+int xdp_prog_range_drop(struct xdp_md *ctx)
+{
+    u32 key = 0;
+    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+
+    pipeline_ctx_t* pctx = get_pipeline_ctx();
+
+    if (!pctx)
+    {
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+        return XDP_PASS;
+    }
+
+    if (check_range_drop(stats, pctx->src_ip, &pctx->src_ip6, pctx->ipv6))
+    {
+        return end_pipeline_stage(pctx, XDP_DROP);
+    }
+
+    pipeline_next(ctx, PIPELINE_STAGE_RANGE_DROP + 1);
+
+    inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+    return XDP_PASS;
+}
+#endif
 
 #ifdef ENABLE_FILTERS
-matched:
-    if (rule.action == 0)
+#if defined(ENABLE_RL_IP) || defined(ENABLE_RL_FLOW)
+SEC("xdp")
+int xdp_prog_rl(struct xdp_md *ctx)
+{
+    u32 key = 0;
+    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+
+    pipeline_ctx_t* pctx = get_pipeline_ctx();
+
+    if (!pctx)
     {
-        // Before dropping, update the block map.
-        if (rule.block_time > 0)
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+        return XDP_PASS;
+    }
+
+    pctx->now = get_time_ns();
+
+    // Update client stats (PPS/BPS).
+    if (!pctx->ipv6)
+    {
+#ifdef ENABLE_RL_IP
+        if (features.rl_ip)
         {
-            u64 new_time = now + (rule.block_time * NANO_TO_SEC);
-            
-            if (iph)
-            {
-                bpf_map_update_elem(&map_block, &iph->saddr, &new_time, BPF_ANY);
-            }
+            update_ip_stats(&pctx->ip_pps, &pctx->ip_bps, pctx->src_ip, pctx->pkt_len, pctx->now);
+        }
+#endif
+
+#ifdef ENABLE_RL_FLOW
+        if (features.rl_flow)
+        {
+            update_flow_stats(&pctx->flow_pps, &pctx->flow_bps, pctx->src_ip, pctx->src_port, pctx->protocol, pctx->pkt_len, pctx->now);
+        }
+#endif
+    }
 #ifdef ENABLE_IPV6
-            else
+    else
+    {
+#ifdef ENABLE_RL_IP
+        if (features.rl_ip)
+        {
+            update_ip6_stats(&pctx->ip_pps, &pctx->ip_bps, &pctx->src_ip6, pctx->pkt_len, pctx->now);
+        }
+#endif
+
+#ifdef ENABLE_RL_FLOW
+        if (features.rl_flow)
+        {
+            update_flow6_stats(&pctx->flow_pps, &pctx->flow_bps, &pctx->src_ip6, pctx->src_port, pctx->protocol, pctx->pkt_len, pctx->now);
+        }
+#endif
+    }
+#endif
+
+    pipeline_next(ctx, PIPELINE_STAGE_RL + 1);
+
+    inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+    return XDP_PASS;
+}
+#endif
+
+SEC("xdp")
+int xdp_prog_filters(struct xdp_md *ctx)
+{
+    u32 key = 0;
+    stats_t* stats = bpf_map_lookup_elem(&map_stats, &key);
+
+    pipeline_ctx_t* pctx = get_pipeline_ctx();
+
+    if (!pctx)
+    {
+        inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+        return XDP_PASS;
+    }
+
+    pipeline_hdrs_t hdrs = {0};
+
+    if (load_pipeline_hdrs(ctx, pctx, &hdrs))
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+        return end_pipeline_stage(pctx, XDP_DROP);
+    }
+
+    // The rate limit stage retrieves the timestamp unless it was skipped.
+    if (!pctx->now)
+    {
+        pctx->now = get_time_ns();
+    }
+
+#ifdef ENABLE_SYN_PROXY
+    int syn_proxy = do_syn_proxy(ctx, stats, hdrs.iph, hdrs.iph6, hdrs.tcph);
+
+    if (syn_proxy > -1)
+    {
+        return end_pipeline_stage(pctx, syn_proxy);
+    }
+#endif
+
+#ifdef ENABLE_FRAG_CACHE
+    // Non-first fragments receive their first fragment's verdict.
+    if (pctx->frag_seen)
+    {
+        return end_pipeline_stage(pctx, do_frag_action(ctx, stats, pctx->frag_action, pctx->frag_matched));
+    }
+
+    frag_key_t frag_key;
+
+    if (pctx->frag == IP_FRAG_FIRST)
+    {
+        init_frag_key(&frag_key, hdrs.iph, hdrs.iph6, pctx->protocol, pctx->frag_id);
+    }
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+    // Established flows reuse their cached verdict which skips the filter rules.
+    filter_cache_key_t cache_key;
+    filter_cache_meta_t cache_meta;
+
+    // First fragments aren't cached so their verdict is stored for the later fragments.
+    int cache = pctx->frag == IP_FRAG_NONE && init_filter_cache(&cache_key, &cache_meta, hdrs.iph, hdrs.iph6, hdrs.tcph, hdrs.udph);
+
+#ifdef ENABLE_VLAN
+    cache_key.vlan_id = pctx->vlan_id;
+#endif
+
+    if (cache)
+    {
+        filter_cache_val_t* cached = lookup_filter_cache(&cache_key, &cache_meta);
+
+        if (cached)
+        {
+            if (!cached->matched)
             {
-                bpf_map_update_elem(&map_block6, &src_ip6, &new_time, BPF_ANY);
+                inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+                return XDP_PASS;
             }
-#endif      
+
+            rule_ctx_t rule = {0};
+            rule.pkt_len = pctx->pkt_len;
+
+#ifdef ENABLE_FILTER_INSPECT
+            rule.ifindex = ctx->ingress_ifindex;
+            rule.rx_queue = ctx->rx_queue_index;
+#endif
+
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_POLICE)
+            rule.protocol = pctx->protocol;
+            rule.src_port = pctx->src_port;
+#endif
+
+            set_filter_cache_matched(cached, &rule, pctx->now);
+
+            return end_pipeline_stage(pctx, do_rule_action(stats, &rule, pctx->src_ip, &pctx->src_ip6, pctx->ipv6, pctx->now));
         }
+    }
+#endif
 
-        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+    // Create rule context.
+    rule_ctx_t rule = {0};
+    rule.flow_pps = pctx->flow_pps;
+    rule.flow_bps = pctx->flow_bps;
+    rule.ip_pps = pctx->ip_pps;
+    rule.ip_bps = pctx->ip_bps;
+    rule.pkt_len = pctx->pkt_len;
+
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_STATS)
+    rule.now = pctx->now;
+#endif
 
-        return XDP_DROP;
+    rule.frag = pctx->frag;
+
+#ifdef ENABLE_VLAN
+    rule.vlan_id = pctx->vlan_id;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    rule.ifindex = ctx->ingress_ifindex;
+    rule.rx_queue = ctx->rx_queue_index;
+#endif
+
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_POLICE)
+    rule.protocol = pctx->protocol;
+    rule.src_port = pctx->src_port;
+#endif
+
+#ifdef ENABLE_FILTER_LOGGING
+    rule.dst_port = pctx->dst_port;
+#endif
+
+    rule.iph = hdrs.iph;
+
+    rule.tcph = hdrs.tcph;
+    rule.udph = hdrs.udph;
+    rule.icmph = hdrs.icmph;
+
+    rule.iph6 = hdrs.iph6;
+    rule.icmph6 = hdrs.icmph6;
+
+    match_rules(&rule);
+
+#ifdef ENABLE_FILTERS_CACHE
+    if (cache)
+    {
+        update_filter_cache(&cache_key, &cache_meta, &rule);
     }
-    else
+#endif
+
+    if (rule.matched)
     {
-        inc_pkt_stats(stats, STATS_TYPE_ALLOWED);
+        int action = do_rule_action(stats, &rule, pctx->src_ip, &pctx->src_ip6, pctx->ipv6, pctx->now);
+
+#ifdef ENABLE_FRAG_CACHE
+        if (pctx->frag == IP_FRAG_FIRST)
+        {
+            update_frag_cache(&frag_key, action, 1, hdrs.tcph, hdrs.udph, pctx->now);
+        }
+#endif
+
+        return end_pipeline_stage(pctx, action);
     }
 
-    return XDP_PASS;
+#ifdef ENABLE_FRAG_CACHE
+    if (pctx->frag == IP_FRAG_FIRST)
+    {
+        update_frag_cache(&frag_key, XDP_PASS, 0, hdrs.tcph, hdrs.udph, pctx->now);
+    }
 #endif
+
+    inc_pkt_stats(stats, STATS_TYPE_PASSED);
+
+    return XDP_PASS;
 }
+#endif
+#endif
 
 char _license[] SEC("license") = "GPL";
 
@@ -0,0 +1,80 @@
+#include <xdp/utils/bloom.h>
+
+#ifdef ENABLE_BLOCK_BLOOM
+/**
+ * Checks whether a source IP may be inside of the block maps using the active bloom filter copy.
+ * 
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * 
+ * @return 1 if the source IP may be blocked or 0 if it definitely isn't blocked.
+ */
+static __always_inline int check_block_bloom(u32* key, int ipv6)
+{
+    u32 idx = BLOCK_BLOOM_ACTIVE_IDX;
+
+    u64* active = bpf_map_lookup_elem(&map_block_bloom, &idx);
+
+    if (!active)
+    {
+        return 1;
+    }
+
+    u32 off = (*active & 1) * BLOCK_BLOOM_WORDS;
+
+    u32 h1, h2;
+    get_block_bloom_hashes(key, ipv6, &h1, &h2);
+
+#pragma unroll
+    for (int i = 0; i < BLOCK_BLOOM_HASHES; i++)
+    {
+        u32 bit = (h1 + (i * h2)) & (BLOCK_BLOOM_BITS - 1);
+
+        idx = off + (bit >> 6);
+
+        u64* word = bpf_map_lookup_elem(&map_block_bloom, &idx);
+
+        if (word && !(*word & (1ULL << (bit & 63))))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Adds a source IP to both bloom filter copies.
+ * 
+ * Both copies are updated so a block isn't lost if the loader is rebuilding the inactive copy.
+ * 
+ * @param key A pointer to the block map key (u32 for IPv4 and u128 for IPv6).
+ * @param ipv6 Whether the key is an IPv6 address.
+ * 
+ * @return void
+ */
+static __always_inline void add_block_bloom(u32* key, int ipv6)
+{
+    u32 h1, h2;
+    get_block_bloom_hashes(key, ipv6, &h1, &h2);
+
+#pragma unroll
+    for (int i = 0; i < BLOCK_BLOOM_HASHES; i++)
+    {
+        u32 bit = (h1 + (i * h2)) & (BLOCK_BLOOM_BITS - 1);
+
+#pragma unroll
+        for (int j = 0; j < 2; j++)
+        {
+            u32 idx = (j * BLOCK_BLOOM_WORDS) + (bit >> 6);
+
+            u64* word = bpf_map_lookup_elem(&map_block_bloom, &idx);
+
+            if (word)
+            {
+                __sync_fetch_and_or(word, 1ULL << (bit & 63));
+            }
+        }
+    }
+}
+#endif
\ No newline at end of file
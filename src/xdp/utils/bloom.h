@@ -0,0 +1,18 @@
+#pragma once
+
+#include <common/all.h>
+#include <common/bloom.h>
+
+#include <xdp/utils/helpers.h>
+
+#include <xdp/utils/maps.h>
+
+#ifdef ENABLE_BLOCK_BLOOM
+static __always_inline int check_block_bloom(u32* key, int ipv6);
+static __always_inline void add_block_bloom(u32* key, int ipv6);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "bloom.c"
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include <xdp/utils/bucket.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+/**
+ * Processes the next filter rule inside of a bucket.
+ *
+ * @param i The position inside of the bucket.
+ * @param data A pointer to the bucket scan context.
+ *
+ * @return 1 to break the loop or 0 to continue.
+ */
+static __always_inline long process_bucket_rule(u32 i, void* data)
+{
+    bucket_scan_t* scan = data;
+
+    if (i >= MAX_FILTERS || i >= scan->bucket->cnt)
+    {
+        return 1;
+    }
+
+    return process_rule(scan->bucket->rules[i], scan->rule);
+}
+
+/**
+ * Processes the filter rules inside of the bucket matching the packet's protocol and destination port.
+ *
+ * @param ctx A pointer to the rule context.
+ *
+ * @return void
+ */
+static __always_inline void classify_buckets(rule_ctx_t* ctx)
+{
+    filter_bucket_key_t key = {0};
+    filter_bucket_t* bucket = NULL;
+
+    if (ctx->tcph)
+    {
+        key.protocol = IPPROTO_TCP;
+        key.dport = ntohs(ctx->tcph->dest);
+    }
+    else if (ctx->udph)
+    {
+        key.protocol = IPPROTO_UDP;
+        key.dport = ntohs(ctx->udph->dest);
+    }
+    else
+    {
+        // ICMP rules can't match on ports, so there is only a wildcard bucket.
+        key.protocol = IPPROTO_ICMP;
+        key.any_dport = 1;
+    }
+
+    if (!key.any_dport)
+    {
+        bucket = bpf_map_lookup_elem(&map_filter_buckets, &key);
+    }
+
+    // Fall back to the protocol's wildcard bucket if no rule uses this destination port.
+    if (!bucket)
+    {
+        key.dport = 0;
+        key.any_dport = 1;
+
+        bucket = bpf_map_lookup_elem(&map_filter_buckets, &key);
+    }
+
+    if (!bucket)
+    {
+        return;
+    }
+
+    bucket_scan_t scan = {0};
+    scan.bucket = bucket;
+    scan.rule = ctx;
+
+#ifdef USE_NEW_LOOP
+    bpf_loop(MAX_FILTERS, process_bucket_rule, &scan, 0);
+#else
+#pragma unroll 30
+    for (int i = 0; i < MAX_FILTERS; i++)
+    {
+        if (process_bucket_rule(i, &scan))
+        {
+            break;
+        }
+    }
+#endif
+}
+#endif
\ No newline at end of file
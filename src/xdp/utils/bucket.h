@@ -0,0 +1,24 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/rule.h>
+
+#include <xdp/utils/maps.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+struct bucket_scan
+{
+    filter_bucket_t* bucket;
+    rule_ctx_t* rule;
+} typedef bucket_scan_t;
+
+static __always_inline long process_bucket_rule(u32 i, void* data);
+static __always_inline void classify_buckets(rule_ctx_t* ctx);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "bucket.c"
\ No newline at end of file
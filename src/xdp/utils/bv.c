@@ -0,0 +1,327 @@
+#include <xdp/utils/bv.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_BV)
+/**
+ * ANDs a bitmap from the bit-vector map into the result bitmap.
+ *
+ * @param res A pointer to the result bitmap.
+ * @param idx The bitmap index inside of the bit-vector map.
+ *
+ * @return void
+ */
+static __always_inline void bv_and(u64* res, u32 idx)
+{
+    filter_bv_t* bv = bpf_map_lookup_elem(&map_filters_bv, &idx);
+
+    if (!bv)
+    {
+        // This should never happen, but make sure nothing matches if it does.
+#pragma unroll
+        for (int i = 0; i < FILTERS_BV_WORDS; i++)
+        {
+            res[i] = 0;
+        }
+
+        return;
+    }
+
+#pragma unroll
+    for (int i = 0; i < FILTERS_BV_WORDS; i++)
+    {
+        res[i] &= bv->words[i];
+    }
+}
+
+/**
+ * ANDs a bitmap into the result bitmap using the interval index map (ports and packet length).
+ *
+ * @param res A pointer to the result bitmap.
+ * @param key The key inside of the index map (segment start + value).
+ * @param off The segment's offset inside of the bit-vector map.
+ *
+ * @return void
+ */
+static __always_inline void bv_and_idx(u64* res, u32 key, u32 off)
+{
+    u16* idx = bpf_map_lookup_elem(&map_filters_bv_idx, &key);
+
+    if (!idx)
+    {
+        // An out of range index clears the result bitmap.
+        bv_and(res, FILTERS_BV_MAX_ENTRIES);
+
+        return;
+    }
+
+    bv_and(res, off + *idx);
+}
+
+/**
+ * ANDs a bitmap into the result bitmap using the longest matching prefix of an IP address.
+ *
+ * @param res A pointer to the result bitmap.
+ * @param field The LPM field (FILTERS_BV_LPM_*).
+ * @param ip A pointer to the IP address (network byte order).
+ * @param v6 Whether the IP address is an IPv6 address.
+ *
+ * @return void
+ */
+static __always_inline void bv_and_lpm(u64* res, u32 field, u32* ip, int v6)
+{
+    filter_bv_lpm_key_t key = {0};
+    key.field = field;
+
+    if (v6)
+    {
+        key.prefix_len = 32 + 128;
+
+        memcpy(key.ip, ip, sizeof(key.ip));
+    }
+    else
+    {
+        key.prefix_len = 32 + 32;
+
+        key.ip[0] = *ip;
+    }
+
+    u32* slot = bpf_map_lookup_elem(&map_filters_bv_lpm, &key);
+
+    if (!slot)
+    {
+        bv_and(res, FILTERS_BV_MAX_ENTRIES);
+
+        return;
+    }
+
+    bv_and(res, *slot);
+}
+
+/**
+ * Retrieves the index of the lowest set bit in a non-zero word.
+ *
+ * @param word The word.
+ *
+ * @return The bit index (0 - 63).
+ */
+static __always_inline u32 bv_ffs(u64 word)
+{
+    u32 bit = 0;
+
+    if (!(word & 0xFFFFFFFFULL))
+    {
+        bit += 32;
+        word >>= 32;
+    }
+
+    if (!(word & 0xFFFFULL))
+    {
+        bit += 16;
+        word >>= 16;
+    }
+
+    if (!(word & 0xFFULL))
+    {
+        bit += 8;
+        word >>= 8;
+    }
+
+    if (!(word & 0xFULL))
+    {
+        bit += 4;
+        word >>= 4;
+    }
+
+    if (!(word & 0x3ULL))
+    {
+        bit += 2;
+        word >>= 2;
+    }
+
+    if (!(word & 0x1ULL))
+    {
+        bit += 1;
+    }
+
+    return bit;
+}
+
+/**
+ * Pops the lowest candidate rule from the result bitmap and checks its rate limits.
+ *
+ * @param i The current iteration.
+ * @param data A pointer to the bit-vector scan context.
+ *
+ * @return 1 to break the loop or 0 to continue.
+ */
+static __always_inline long bv_next_rule(u32 i, void* data)
+{
+    bv_scan_t* scan = data;
+
+    u32 idx = 0;
+    int found = 0;
+
+#pragma unroll
+    for (int w = 0; w < FILTERS_BV_WORDS; w++)
+    {
+        u64 word = scan->res[w];
+
+        if (word)
+        {
+            idx = (w * 64) + bv_ffs(word);
+
+            // Clear the lowest set bit so the next iteration moves onto the next candidate.
+            scan->res[w] = word & (word - 1);
+
+            found = 1;
+
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        return 1;
+    }
+
+#ifdef ENABLE_FILTERS_TSS
+    if (idx >= scan->rule->max_idx)
+    {
+        return 1;
+    }
+#endif
+
+    filter_t* filter = bpf_map_lookup_elem(&map_filters, &idx);
+
+    if (!filter || !filter->set)
+    {
+        return 1;
+    }
+
+    // Rate limits depend on the client's current rates and can't be precomputed by the loader.
+    if (!check_rule_rl(filter, scan->rule))
+    {
+        return 0;
+    }
+
+    // VLAN IDs and fragments aren't part of the bitmaps.
+    if (!check_rule_pkt(filter, scan->rule))
+    {
+        return 0;
+    }
+
+    // Non-first fragments use the ICMP protocol bitmap since they don't contain a layer-4 header, so make sure protocol rules don't match.
+    if (scan->rule->frag == IP_FRAG_LATER && (filter->tcp.enabled || filter->udp.enabled || filter->icmp.enabled))
+    {
+        return 0;
+    }
+
+    set_rule_matched(filter, scan->rule, idx);
+
+    return 1;
+}
+
+/**
+ * Classifies a packet using the bit-vector maps and stores the first matching rule inside of the rule context.
+ *
+ * @param ctx A pointer to the rule context.
+ *
+ * @return void
+ */
+static __always_inline void classify_bv(rule_ctx_t* ctx)
+{
+    bv_scan_t scan = {0};
+    scan.rule = ctx;
+
+    // Start with the protocol bitmap since every packet has one.
+    u32 idx = FILTERS_BV_OFF_PROTO + FILTERS_BV_PROTO_ICMP;
+
+    if (ctx->tcph)
+    {
+        idx = FILTERS_BV_OFF_PROTO + FILTERS_BV_PROTO_TCP;
+    }
+    else if (ctx->udph)
+    {
+        idx = FILTERS_BV_OFF_PROTO + FILTERS_BV_PROTO_UDP;
+    }
+
+    if (ctx->iph6)
+    {
+        idx += FILTERS_BV_PROTO_TCP6;
+    }
+
+    filter_bv_t* bv = bpf_map_lookup_elem(&map_filters_bv, &idx);
+
+    if (!bv)
+    {
+        return;
+    }
+
+#pragma unroll
+    for (int i = 0; i < FILTERS_BV_WORDS; i++)
+    {
+        scan.res[i] = bv->words[i];
+    }
+
+    // Packet length.
+    bv_and_idx(scan.res, FILTERS_BV_IDX_LEN + (u16)ctx->pkt_len, FILTERS_BV_OFF_LEN);
+
+    // IP header.
+    if (ctx->iph)
+    {
+        bv_and_lpm(scan.res, FILTERS_BV_LPM_SRC_IP, &ctx->iph->saddr, 0);
+        bv_and_lpm(scan.res, FILTERS_BV_LPM_DST_IP, &ctx->iph->daddr, 0);
+
+        bv_and(scan.res, FILTERS_BV_OFF_TTL + ctx->iph->ttl);
+        bv_and(scan.res, FILTERS_BV_OFF_TOS + ctx->iph->tos);
+    }
+#ifdef ENABLE_IPV6
+    else if (ctx->iph6)
+    {
+        bv_and_lpm(scan.res, FILTERS_BV_LPM_SRC_IP6, ctx->iph6->saddr.in6_u.u6_addr32, 1);
+        bv_and_lpm(scan.res, FILTERS_BV_LPM_DST_IP6, ctx->iph6->daddr.in6_u.u6_addr32, 1);
+
+        bv_and(scan.res, FILTERS_BV_OFF_TTL + ctx->iph6->hop_limit);
+    }
+#endif
+
+    // Layer-4 header.
+    if (ctx->tcph)
+    {
+        bv_and_idx(scan.res, FILTERS_BV_IDX_SPORT + ntohs(ctx->tcph->source), FILTERS_BV_OFF_SPORT);
+        bv_and_idx(scan.res, FILTERS_BV_IDX_DPORT + ntohs(ctx->tcph->dest), FILTERS_BV_OFF_DPORT);
+
+        // The TCP flags are stored in the 14th byte of the TCP header (CWR, ECE, URG, ACK, PSH, RST, SYN, FIN).
+        bv_and(scan.res, FILTERS_BV_OFF_TCP_FLAGS + ((u8*)ctx->tcph)[13]);
+    }
+    else if (ctx->udph)
+    {
+        bv_and_idx(scan.res, FILTERS_BV_IDX_SPORT + ntohs(ctx->udph->source), FILTERS_BV_OFF_SPORT);
+        bv_and_idx(scan.res, FILTERS_BV_IDX_DPORT + ntohs(ctx->udph->dest), FILTERS_BV_OFF_DPORT);
+    }
+    else if (ctx->icmph)
+    {
+        bv_and(scan.res, FILTERS_BV_OFF_ICMP_TYPE + ctx->icmph->type);
+        bv_and(scan.res, FILTERS_BV_OFF_ICMP_CODE + ctx->icmph->code);
+    }
+#ifdef ENABLE_IPV6
+    else if (ctx->icmph6)
+    {
+        bv_and(scan.res, FILTERS_BV_OFF_ICMP_TYPE + ctx->icmph6->icmp6_type);
+        bv_and(scan.res, FILTERS_BV_OFF_ICMP_CODE + ctx->icmph6->icmp6_code);
+    }
+#endif
+
+    // The lowest set bit is the first matching rule unless the rule has rate limits that aren't exceeded.
+#ifdef USE_NEW_LOOP
+    bpf_loop(MAX_FILTERS, bv_next_rule, &scan, 0);
+#else
+    for (int i = 0; i < MAX_FILTERS; i++)
+    {
+        if (bv_next_rule(i, &scan))
+        {
+            break;
+        }
+    }
+#endif
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/rule.h>
+
+#include <xdp/utils/maps.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_BV)
+struct bv_scan
+{
+    u64 res[FILTERS_BV_WORDS];
+    rule_ctx_t* rule;
+} typedef bv_scan_t;
+
+static __always_inline void bv_and(u64* res, u32 idx);
+static __always_inline void bv_and_idx(u64* res, u32 key, u32 off);
+static __always_inline void bv_and_lpm(u64* res, u32 field, u32* ip, int v6);
+static __always_inline u32 bv_ffs(u64 word);
+static __always_inline long bv_next_rule(u32 i, void* data);
+static __always_inline void classify_bv(rule_ctx_t* ctx);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "bv.c"
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include <xdp/utils/cache.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_CACHE)
+/**
+ * Builds a packet's verdict cache key and retrieves the current verdict cache generation.
+ * 
+ * @param key A pointer to store the verdict cache key in.
+ * @param meta A pointer to store the verdict cache meta data in.
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param tcph A pointer to the TCP header (NULL if not TCP).
+ * @param udph A pointer to the UDP header (NULL if not UDP).
+ * 
+ * @return 1 if the packet's verdict can be cached or 0 otherwise (only TCP and UDP flows are cached).
+ */
+static __always_inline int init_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, struct udphdr* udph)
+{
+    __builtin_memset(key, 0, sizeof(*key));
+
+    if (tcph)
+    {
+        key->src_port = tcph->source;
+        key->dst_port = tcph->dest;
+        key->protocol = IPPROTO_TCP;
+    }
+    else if (udph)
+    {
+        key->src_port = udph->source;
+        key->dst_port = udph->dest;
+        key->protocol = IPPROTO_UDP;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (iph)
+    {
+        key->src_ip[0] = iph->saddr;
+        key->dst_ip[0] = iph->daddr;
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        key->ipv6 = 1;
+
+        memcpy(key->src_ip, iph6->saddr.in6_u.u6_addr32, sizeof(key->src_ip));
+        memcpy(key->dst_ip, iph6->daddr.in6_u.u6_addr32, sizeof(key->dst_ip));
+    }
+#endif
+    else
+    {
+        return 0;
+    }
+
+    u32 idx = 0;
+
+    filter_cache_meta_t* cur = bpf_map_lookup_elem(&map_filters_cache_meta, &idx);
+
+    if (!cur)
+    {
+        return 0;
+    }
+
+    // Copy the meta data so a generation bump while processing the packet doesn't mark its verdict as current.
+    *meta = *cur;
+
+    return 1;
+}
+
+/**
+ * Retrieves a flow's cached verdict if it was cached with the current filter rules.
+ * 
+ * @param key A pointer to the verdict cache key.
+ * @param meta A pointer to the verdict cache meta data.
+ * 
+ * @return A pointer to the cached verdict or NULL if there is no current cached verdict.
+ */
+static __always_inline filter_cache_val_t* lookup_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta)
+{
+    filter_cache_val_t* val = bpf_map_lookup_elem(&map_filters_cache, key);
+
+    if (!val || val->gen != meta->gen)
+    {
+        return NULL;
+    }
+
+    return val;
+}
+
+/**
+ * Stores a cached verdict inside of the rule context as if the filter rule matched.
+ * 
+ * @param val A pointer to the cached verdict.
+ * @param ctx A pointer to the rule context.
+ * @param now The current timestamp.
+ * 
+ * @return void
+ */
+static __always_inline void set_filter_cache_matched(filter_cache_val_t* val, rule_ctx_t* ctx, u64 now)
+{
+#ifdef ENABLE_FILTER_STATS
+    inc_filter_stats(val->id, ctx->pkt_len, now);
+#endif
+
+    ctx->matched = 1;
+    ctx->action = val->action;
+    ctx->block_time = val->block_time;
+
+#ifdef ENABLE_FILTER_POLICE
+    ctx->police_idx = val->police_idx;
+    ctx->police_flow = val->police_flow;
+    ctx->police_rate = val->police_rate;
+    ctx->police_burst = val->police_burst;
+#endif
+}
+
+/**
+ * Caches a flow's verdict if it doesn't depend on filter rules that can't be cached.
+ * 
+ * @param key A pointer to the verdict cache key.
+ * @param meta A pointer to the verdict cache meta data.
+ * @param ctx A pointer to the rule context after the filter rules were processed.
+ * 
+ * @return void
+ */
+static __always_inline void update_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta, rule_ctx_t* ctx)
+{
+    // Packets that didn't match were checked against every filter rule.
+    u32 deps = ctx->matched ? ctx->cache_deps : MAX_FILTERS;
+
+    if (deps > meta->cacheable)
+    {
+        return;
+    }
+
+    filter_cache_val_t val = {0};
+    val.gen = meta->gen;
+    val.matched = ctx->matched;
+    val.action = ctx->action;
+    val.block_time = ctx->block_time;
+
+#ifdef ENABLE_FILTER_STATS
+    val.id = ctx->id;
+#endif
+
+#ifdef ENABLE_FILTER_POLICE
+    val.police_idx = ctx->police_idx;
+    val.police_flow = ctx->police_flow;
+    val.police_rate = ctx->police_rate;
+    val.police_burst = ctx->police_burst;
+#endif
+
+    bpf_map_update_elem(&map_filters_cache, key, &val, BPF_ANY);
+}
+#endif
\ No newline at end of file
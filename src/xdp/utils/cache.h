@@ -0,0 +1,26 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/rule.h>
+#include <xdp/utils/stats.h>
+
+#include <xdp/utils/maps.h>
+
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/udp.h>
+#include <linux/tcp.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_CACHE)
+static __always_inline int init_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, struct udphdr* udph);
+static __always_inline filter_cache_val_t* lookup_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta);
+static __always_inline void set_filter_cache_matched(filter_cache_val_t* val, rule_ctx_t* ctx, u64 now);
+static __always_inline void update_filter_cache(filter_cache_key_t* key, filter_cache_meta_t* meta, rule_ctx_t* ctx);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "cache.c"
\ No newline at end of file
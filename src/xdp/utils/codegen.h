@@ -0,0 +1,12 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/rule.h>
+
+#if defined(ENABLE_FILTERS) && defined(FILTERS_CODEGEN)
+static __always_inline void process_rules_gen(rule_ctx_t* ctx);
+
+// The source file below is generated from the current filter rules by the loader (see loader/utils/codegen.c) and found through the include path passed to clang.
+#include <rules_gen.c>
+#endif
\ No newline at end of file
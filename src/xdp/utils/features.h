@@ -0,0 +1,20 @@
+#pragma once
+
+#include <common/all.h>
+
+// The loader overwrites these values from the config before loading the XDP program.
+// Since the values are read-only after loading, the verifier removes the code paths of disabled features.
+const volatile features_t features =
+{
+    .ipv6 = 1,
+    .rl_ip = 1,
+    .rl_flow = 1,
+    .filter_logging = 1,
+    .filter_stats = 1,
+    .stats_on_block_map = 1,
+    .stats_on_ip_range_drop_map = 1,
+    .rl_percpu_scale = 1,
+#ifdef ENABLE_SYN_PROXY
+    .syn_proxy_allow_time = 300
+#endif
+};
\ No newline at end of file
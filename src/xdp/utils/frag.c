@@ -0,0 +1,92 @@
+#include <xdp/utils/frag.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FRAG_CACHE)
+/**
+ * Builds the fragment cache key of a fragmented datagram.
+ * 
+ * @param key A pointer to store the fragment cache key in.
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param protocol The layer-4 protocol.
+ * @param id The datagram's fragment identification (network byte order).
+ * 
+ * @return void
+ */
+static __always_inline void init_frag_key(frag_key_t* key, struct iphdr* iph, struct ipv6hdr* iph6, u8 protocol, u32 id)
+{
+    __builtin_memset(key, 0, sizeof(*key));
+
+    key->id = id;
+    key->protocol = protocol;
+
+    if (iph)
+    {
+        key->src_ip[0] = iph->saddr;
+        key->dst_ip[0] = iph->daddr;
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        key->ipv6 = 1;
+
+        memcpy(key->src_ip, iph6->saddr.in6_u.u6_addr32, sizeof(key->src_ip));
+        memcpy(key->dst_ip, iph6->daddr.in6_u.u6_addr32, sizeof(key->dst_ip));
+    }
+#endif
+}
+
+/**
+ * Retrieves the ports and verdict of a datagram's first fragment.
+ * 
+ * @param key A pointer to the fragment cache key.
+ * @param now The current timestamp in nanoseconds.
+ * 
+ * @return A pointer to the first fragment's entry or NULL if the first fragment wasn't seen (or expired).
+ */
+static __always_inline frag_val_t* lookup_frag_cache(frag_key_t* key, u64 now)
+{
+    frag_val_t* val = bpf_map_lookup_elem(&map_frag_cache, key);
+
+    if (!val || now > val->expires)
+    {
+        return NULL;
+    }
+
+    return val;
+}
+
+/**
+ * Stores the ports and verdict of a datagram's first fragment for the datagram's later fragments.
+ * 
+ * @param key A pointer to the fragment cache key.
+ * @param action The first fragment's XDP action.
+ * @param matched Whether the first fragment's XDP action came from a filter rule.
+ * @param tcph A pointer to the TCP header (NULL if not TCP).
+ * @param udph A pointer to the UDP header (NULL if not UDP).
+ * @param now The current timestamp in nanoseconds.
+ * 
+ * @return void
+ */
+static __always_inline void update_frag_cache(frag_key_t* key, int action, u8 matched, struct tcphdr* tcph, struct udphdr* udph, u64 now)
+{
+    frag_val_t val = {0};
+
+    // The datagram is discarded by the receiver once the reassembly timeout passes.
+    val.expires = now + ((u64)FRAG_CACHE_TIMEOUT * NANO_TO_SEC);
+    val.action = action;
+    val.matched = matched;
+
+    if (tcph)
+    {
+        val.src_port = tcph->source;
+        val.dst_port = tcph->dest;
+    }
+    else if (udph)
+    {
+        val.src_port = udph->source;
+        val.dst_port = udph->dest;
+    }
+
+    bpf_map_update_elem(&map_frag_cache, key, &val, BPF_ANY);
+}
+#endif
\ No newline at end of file
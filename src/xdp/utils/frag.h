@@ -0,0 +1,23 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+
+#include <xdp/utils/maps.h>
+
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/udp.h>
+#include <linux/tcp.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FRAG_CACHE)
+static __always_inline void init_frag_key(frag_key_t* key, struct iphdr* iph, struct ipv6hdr* iph6, u8 protocol, u32 id);
+static __always_inline frag_val_t* lookup_frag_cache(frag_key_t* key, u64 now);
+static __always_inline void update_frag_cache(frag_key_t* key, int action, u8 matched, struct tcphdr* tcph, struct udphdr* udph, u64 now);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "frag.c"
\ No newline at end of file
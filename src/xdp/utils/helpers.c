@@ -1,5 +1,19 @@
 #include <xdp/utils/helpers.h>
 
+/**
+ * Retrieves the current time since system boot.
+ * 
+ * @return The current time in nanoseconds.
+ */
+static __always_inline u64 get_time_ns()
+{
+#ifdef USE_COARSE_TIME
+    return bpf_ktime_get_coarse_ns();
+#else
+    return bpf_ktime_get_ns();
+#endif
+}
+
 /**
  * Checks if an IP is within a specific CIDR range.
  * 
@@ -14,6 +28,40 @@ static __always_inline int is_ip_in_range(u32 src_ip, u32 net_ip, u8 cidr)
     return !((src_ip ^ net_ip) & htonl(0xFFFFFFFFu << (32 - cidr)));
 }
 
+#ifdef ENABLE_IPV6
+/**
+ * Checks if an IPv6 address is within a specific prefix.
+ * 
+ * @param src_ip A pointer to the source/main IPv6 address to check against.
+ * @param net_ip A pointer to the network IPv6 address (host bits cleared).
+ * @param cidr The prefix length.
+ * 
+ * @return 1 on yes, 0 on no.
+ */
+static __always_inline int is_ip6_in_range(u32* src_ip, u32* net_ip, u8 cidr)
+{
+#pragma unroll
+    for (int i = 0; i < 4; i++)
+    {
+        int bits = cidr - (i * 32);
+
+        if (bits <= 0)
+        {
+            break;
+        }
+
+        u32 mask = (bits >= 32) ? 0xFFFFFFFFu : htonl(0xFFFFFFFFu << (32 - bits));
+
+        if ((src_ip[i] & mask) != net_ip[i])
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
 /**
  * Checks if the IP is in the IP range drop map.
@@ -44,4 +92,23 @@ static __always_inline int check_ip_range_drop(u32 ip)
 
     return 0;
 }
+
+#ifdef ENABLE_IPV6
+/**
+ * Checks if the IPv6 address is in the IPv6 range drop map.
+ * 
+ * @param ip A pointer to the IPv6 address (network byte order).
+ * 
+ * @return 1 on yes or 0 on no.
+ */
+static __always_inline int check_ip6_range_drop(u128* ip)
+{
+    lpm_trie_key6_t key = {0};
+    key.prefix_len = 128;
+    memcpy(key.data, ip, sizeof(key.data));
+
+    // The LPM trie only returns an entry if the address is inside of the stored prefix.
+    return bpf_map_lookup_elem(&map_range_drop6, &key) != NULL;
+}
+#endif
 #endif
\ No newline at end of file
@@ -34,10 +34,19 @@
 #define memcpy(dest, src, n) __builtin_memcpy((dest), (src), (n))
 #endif
 
+static __always_inline u64 get_time_ns();
 static __always_inline int is_ip_in_range(u32 src_ip, u32 net_ip, u8 cidr);
 
+#ifdef ENABLE_IPV6
+static __always_inline int is_ip6_in_range(u32* src_ip, u32* net_ip, u8 cidr);
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
 static __always_inline int check_ip_range_drop(u32 ip);
+
+#ifdef ENABLE_IPV6
+static __always_inline int check_ip6_range_drop(u128* ip);
+#endif
 #endif
 
 // The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
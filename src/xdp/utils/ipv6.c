@@ -0,0 +1,106 @@
+#include <xdp/utils/ipv6.h>
+
+#ifdef ENABLE_IPV6
+/**
+ * Skips the IPv6 extension headers (up to IPV6_MAX_EXT_HDRS) and retrieves the upper-layer protocol and header.
+ * 
+ * @param iph6 A pointer to the IPv6 header.
+ * @param data_end The end of the packet.
+ * @param proto A pointer to store the upper-layer protocol in.
+ * @param l4 A pointer to store the start of the upper-layer header in (the fragment's payload for non-first fragments).
+ * @param frag A pointer to store the fragment type in (IP_FRAG_*).
+ * @param frag_id A pointer to store the fragment identification in (network byte order).
+ * 
+ * @return 0 on success or -1 if an extension header is out of bounds or the extension headers are too long.
+ */
+static __always_inline int parse_ip6_exthdrs(struct ipv6hdr* iph6, void* data_end, u8* proto, void** l4, u8* frag, u32* frag_id)
+{
+    void* cur = iph6 + 1;
+    u8 next = iph6->nexthdr;
+
+    *frag = IP_FRAG_NONE;
+
+#pragma unroll
+    for (int i = 0; i < IPV6_MAX_EXT_HDRS; i++)
+    {
+        if (next == IPPROTO_HOPOPTS || next == IPPROTO_ROUTING || next == IPPROTO_DSTOPTS)
+        {
+            struct ipv6_opt_hdr* hdr = cur;
+
+            if (unlikely(hdr + 1 > (struct ipv6_opt_hdr*)data_end))
+            {
+                return -1;
+            }
+
+            next = hdr->nexthdr;
+
+            // The length is in 8 byte units and doesn't include the first 8 bytes.
+            cur += (hdr->hdrlen + 1) * 8;
+        }
+        else if (next == IPPROTO_AH)
+        {
+            struct ipv6_opt_hdr* hdr = cur;
+
+            if (unlikely(hdr + 1 > (struct ipv6_opt_hdr*)data_end))
+            {
+                return -1;
+            }
+
+            next = hdr->nexthdr;
+
+            // The length is in 4 byte units and doesn't include the first 8 bytes.
+            cur += (hdr->hdrlen + 2) * 4;
+        }
+        else if (next == IPPROTO_FRAGMENT)
+        {
+            ip6_frag_hdr_t* hdr = cur;
+
+            if (unlikely(hdr + 1 > (ip6_frag_hdr_t*)data_end))
+            {
+                return -1;
+            }
+
+            next = hdr->nexthdr;
+            cur = hdr + 1;
+
+            *frag_id = hdr->identification;
+
+            // Only the first fragment contains the upper-layer header.
+            if (hdr->frag_off & htons(IPV6_FRAG_OFFSET))
+            {
+                *frag = IP_FRAG_LATER;
+                *proto = next;
+                *l4 = cur;
+
+                return 0;
+            }
+
+            // Atomic fragments (no offset and no more fragments) aren't fragmented.
+            if (hdr->frag_off & htons(IPV6_FRAG_MF))
+            {
+                *frag = IP_FRAG_FIRST;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // Don't let packets skip the filters by using more extension headers than we walk.
+    if (next == IPPROTO_HOPOPTS || next == IPPROTO_ROUTING || next == IPPROTO_DSTOPTS || next == IPPROTO_AH || next == IPPROTO_FRAGMENT)
+    {
+        return -1;
+    }
+
+    if (cur - (void*)(iph6 + 1) > IPV6_MAX_EXT_LEN)
+    {
+        return -1;
+    }
+
+    *proto = next;
+    *l4 = cur;
+
+    return 0;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+
+#include <linux/in.h>
+#include <linux/ipv6.h>
+
+struct ip6_frag_hdr
+{
+    u8 nexthdr;
+    u8 reserved;
+    u16 frag_off;
+    u32 identification;
+} typedef ip6_frag_hdr_t;
+
+#ifdef ENABLE_IPV6
+static __always_inline int parse_ip6_exthdrs(struct ipv6hdr* iph6, void* data_end, u8* proto, void** l4, u8* frag, u32* frag_id);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "ipv6.c"
\ No newline at end of file
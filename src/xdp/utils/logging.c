@@ -5,6 +5,98 @@
 #include <xdp/utils/maps.h>
 
 #if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
+/**
+ * Checks whether a filter rule's match should be logged using the rule's sample rate and per-second cap (per-CPU).
+ * 
+ * @param filter_id The matched rule's config index (stays the same when rules are reordered or stored inside of the exact match table).
+ * @param sample_rate Only every Nth match is logged (0 or 1 logs every match).
+ * @param sample_pps The maximum amount of matches logged per second (0 = no limit).
+ * @param now The timestamp.
+ * 
+ * @return 1 if the match should be logged or 0 otherwise.
+ */
+static __always_inline int sample_filter_log(u32 filter_id, u32 sample_rate, u32 sample_pps, u64 now)
+{
+    if (sample_rate <= 1 && !sample_pps)
+    {
+        return 1;
+    }
+
+    filter_log_sample_t* sample = bpf_map_lookup_elem(&map_filter_log_sample, &filter_id);
+
+    if (!sample)
+    {
+        return 1;
+    }
+
+    if (sample_rate > 1 && (sample->matches++ % sample_rate) != 0)
+    {
+        return 0;
+    }
+
+    if (sample_pps)
+    {
+        if (now - sample->window >= NANO_TO_SEC)
+        {
+            sample->window = now;
+            sample->logged = 0;
+        }
+
+        if (sample->logged >= sample_pps)
+        {
+            return 0;
+        }
+
+        sample->logged++;
+    }
+
+    return 1;
+}
+
+/**
+ * Counts a filter rule's match that wasn't logged for the packet's source IP.
+ * 
+ * @param iph The IPv4 header.
+ * @param iph6 The IPv6 header.
+ * @param pkt_len The full packet length.
+ * @param filter_id The matched rule's config index.
+ * 
+ * @return void
+ */
+static __always_inline void add_filter_log_suppressed(struct iphdr* iph, struct ipv6hdr* iph6, int pkt_len, u32 filter_id)
+{
+    filter_log_suppressed_key_t key = {0};
+    key.filter_id = filter_id;
+
+    if (iph)
+    {
+        key.src_ip = iph->saddr;
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        memcpy(key.src_ip6, iph6->saddr.in6_u.u6_addr32, sizeof(key.src_ip6));
+    }
+#endif
+
+    // The map is per-CPU, so the counters don't need atomic operations.
+    filter_log_suppressed_t* val = bpf_map_lookup_elem(&map_filter_log_suppressed, &key);
+
+    if (val)
+    {
+        val->packets++;
+        val->bytes += pkt_len;
+
+        return;
+    }
+
+    filter_log_suppressed_t new_val = {0};
+    new_val.packets = 1;
+    new_val.bytes = pkt_len;
+
+    bpf_map_update_elem(&map_filter_log_suppressed, &key, &new_val, BPF_ANY);
+}
+
 /**
  * Logs a message to the filter ringbuffer map.
  * 
@@ -19,15 +111,29 @@
  * @param flow_pps The current flow PPS rate.
  * @param flow_bps The current flow BPS rate.
  * @param pkt_len The full packet length.
- * @param filter_id The filter ID that matched.
+ * @param filter_id The matched rule's config index.
+ * @param sample_rate The rule's sample rate.
+ * @param sample_pps The rule's maximum amount of logged matches per second.
  * 
  * @return always 0
  */
-static __always_inline int log_filter_msg(struct iphdr* iph, struct ipv6hdr* iph6, u16 src_port, u16 dst_port, u8 protocol, u64 now, u64 ip_pps, u64 ip_bps, u64 flow_pps, u64 flow_bps, int pkt_len, int filter_id)
+static __always_inline int log_filter_msg(struct iphdr* iph, struct ipv6hdr* iph6, u16 src_port, u16 dst_port, u8 protocol, u64 now, u64 ip_pps, u64 ip_bps, u64 flow_pps, u64 flow_bps, int pkt_len, u32 filter_id, u32 sample_rate, u32 sample_pps)
 {
+    if (!sample_filter_log(filter_id, sample_rate, sample_pps, now))
+    {
+        add_filter_log_suppressed(iph, iph6, pkt_len, filter_id);
+
+        return 0;
+    }
+
     filter_log_event_t* e = bpf_ringbuf_reserve(&map_filter_log, sizeof(*e), 0);
 
-    if (e)
+    // Matches are also counted when the ring buffer is full.
+    if (!e)
+    {
+        add_filter_log_suppressed(iph, iph6, pkt_len, filter_id);
+    }
+    else
     {
         e->ts = now;
         e->filter_id = filter_id;
@@ -40,8 +146,8 @@ static __always_inline int log_filter_msg(struct iphdr* iph, struct ipv6hdr* iph
 #ifdef ENABLE_IPV6
         else if (iph6)
         {
-            memcpy(&e->src_ip6, iph6->saddr.in6_u.u6_addr32, 4);
-            memcpy(&e->dst_ip6, iph6->daddr.in6_u.u6_addr32, 4);
+            memcpy(&e->src_ip6, iph6->saddr.in6_u.u6_addr32, sizeof(e->src_ip6));
+            memcpy(&e->dst_ip6, iph6->daddr.in6_u.u6_addr32, sizeof(e->dst_ip6));
         }
 #endif
 
@@ -6,7 +6,9 @@
 #include <xdp/prog_dispatcher.h>
 
 #if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_LOGGING)
-static __always_inline int log_filter_msg(struct iphdr* iph, struct ipv6hdr* iph6, u16 src_port, u16 dst_port, u8 protocol, u64 now, u64 ip_pps, u64 ip_bps, u64 flow_pps, u64 flow_bps, int pkt_len, int filter_id);
+static __always_inline int sample_filter_log(u32 filter_id, u32 sample_rate, u32 sample_pps, u64 now);
+static __always_inline void add_filter_log_suppressed(struct iphdr* iph, struct ipv6hdr* iph6, int pkt_len, u32 filter_id);
+static __always_inline int log_filter_msg(struct iphdr* iph, struct ipv6hdr* iph6, u16 src_port, u16 dst_port, u8 protocol, u64 now, u64 ip_pps, u64 ip_bps, u64 flow_pps, u64 flow_bps, int pkt_len, u32 filter_id, u32 sample_rate, u32 sample_pps);
 #endif
 
 // The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
@@ -31,6 +31,17 @@ struct
 } map_block6 SEC(".maps");
 #endif
 
+#ifdef ENABLE_BLOCK_BLOOM
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, BLOCK_BLOOM_MAX_ENTRIES);
+    __uint(map_flags, BPF_F_MMAPABLE);
+    __type(key, u32);
+    __type(value, u64);
+} map_block_bloom SEC(".maps");
+#endif
+
 #ifdef ENABLE_IP_RANGE_DROP
 struct
 {
@@ -40,13 +51,68 @@ struct
     __type(key, lpm_trie_key_t);
     __type(value, u64);
 } map_range_drop SEC(".maps");
+
+#ifdef ENABLE_IPV6
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LPM_TRIE);
+    __uint(max_entries, MAX_IP_RANGES);
+    __uint(map_flags, BPF_F_NO_PREALLOC);
+    __type(key, lpm_trie_key6_t);
+    __type(value, u64);
+} map_range_drop6 SEC(".maps");
+#endif
+#endif
+
+#ifdef ENABLE_VLAN_STATS
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, MAX_VLANS);
+    __type(key, u32);
+    __type(value, vlan_stats_t);
+} map_vlan_stats SEC(".maps");
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+struct
+{
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_SYN_PROXY_PORTS);
+    __type(key, u16);
+    __type(value, u8);
+} map_syn_proxy_ports SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_SYN_PROXY_ALLOW);
+    __type(key, u32);
+    __type(value, u64);
+} map_syn_proxy_allow SEC(".maps");
+
+#ifdef ENABLE_IPV6
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_SYN_PROXY_ALLOW);
+    __type(key, u128);
+    __type(value, u64);
+} map_syn_proxy_allow6 SEC(".maps");
+#endif
 #endif
 
 #ifdef ENABLE_FILTERS
+#ifdef ENABLE_RL_PERCPU
+#define RL_MAP_TYPE BPF_MAP_TYPE_LRU_PERCPU_HASH
+#else
+#define RL_MAP_TYPE BPF_MAP_TYPE_LRU_HASH
+#endif
+
 #ifdef ENABLE_RL_IP
 struct 
 {
-    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(type, RL_MAP_TYPE);
     __uint(max_entries, MAX_RL_IP);
     __type(key, u32);
     __type(value, cl_stats_t);
@@ -55,18 +121,28 @@ struct
 #ifdef ENABLE_IPV6
 struct 
 {
-    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(type, RL_MAP_TYPE);
     __uint(max_entries, MAX_RL_IP);
     __type(key, u128);
     __type(value, cl_stats_t);
 } map_ip6_stats SEC(".maps");
 #endif
+
+#ifdef ENABLE_RL_SKETCH
+struct 
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, RL_SKETCH_ROWS);
+    __type(key, u32);
+    __type(value, rl_sketch_row_t);
+} map_ip_sketch SEC(".maps");
+#endif
 #endif
 
 #ifdef ENABLE_RL_FLOW
 struct 
 {
-    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(type, RL_MAP_TYPE);
     __uint(max_entries, MAX_RL_FLOW);
     __type(key, flow_t);
     __type(value, cl_stats_t);
@@ -75,7 +151,7 @@ struct
 #ifdef ENABLE_IPV6
 struct 
 {
-    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(type, RL_MAP_TYPE);
     __uint(max_entries, MAX_RL_FLOW);
     __type(key, flow6_t);
     __type(value, cl_stats_t);
@@ -83,19 +159,179 @@ struct
 #endif
 #endif
 
+#ifdef ENABLE_FILTER_POLICE
 struct 
 {
-    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_POLICE);
+    __type(key, police_key_t);
+    __type(value, police_bucket_t);
+} map_police SEC(".maps");
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+// The AF_XDP sockets of the loader's inspection threads (the interface's first index + RX queue).
+struct
+{
+    __uint(type, BPF_MAP_TYPE_XSKMAP);
+    __uint(max_entries, MAX_INTERFACES * MAX_CPUS);
+    __type(key, u32);
+    __type(value, u32);
+} map_xsks SEC(".maps");
+
+// The first index inside of the AF_XDP socket map for each interface index.
+struct
+{
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_INTERFACES);
+    __type(key, u32);
+    __type(value, u32);
+} map_xsks_ifaces SEC(".maps");
+#endif
+
+// The filter rules are only written by the loader, so a single copy is shared by all CPUs.
+struct 
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
     __uint(max_entries, MAX_FILTERS);
     __type(key, u32);
     __type(value, filter_t);
 } map_filters SEC(".maps");
 
+#ifdef ENABLE_FILTERS_BV
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, FILTERS_BV_MAX_ENTRIES);
+    __type(key, u32);
+    __type(value, filter_bv_t);
+} map_filters_bv SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, FILTERS_BV_IDX_MAX_ENTRIES);
+    __type(key, u32);
+    __type(value, u16);
+} map_filters_bv_idx SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LPM_TRIE);
+    __uint(max_entries, FILTERS_BV_MAX_PREFIXES * FILTERS_BV_LPM_MAX);
+    __uint(map_flags, BPF_F_NO_PREALLOC);
+    __type(key, filter_bv_lpm_key_t);
+    __type(value, u32);
+} map_filters_bv_lpm SEC(".maps");
+#endif
+
+#if defined(ENABLE_FILTERS_BUCKETS) && !defined(ENABLE_FILTERS_BV)
+struct
+{
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, FILTERS_BUCKETS_MAX_ENTRIES);
+    __type(key, filter_bucket_key_t);
+    __type(value, filter_bucket_t);
+} map_filter_buckets SEC(".maps");
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+struct
+{
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_FILTERS_TSS);
+    __type(key, filter_tss_key_t);
+    __type(value, filter_tss_val_t);
+} map_filters_tss SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, filter_tss_masks_t);
+} map_filters_tss_masks SEC(".maps");
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_FILTERS_CACHE);
+    __type(key, filter_cache_key_t);
+    __type(value, filter_cache_val_t);
+} map_filters_cache SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, filter_cache_meta_t);
+} map_filters_cache_meta SEC(".maps");
+#endif
+
+#ifdef ENABLE_FRAG_CACHE
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_FRAG_CACHE);
+    __type(key, frag_key_t);
+    __type(value, frag_val_t);
+} map_frag_cache SEC(".maps");
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, MAX_CFG_FILTERS);
+    __type(key, u32);
+    __type(value, filter_stats_t);
+} map_filter_stats SEC(".maps");
+#endif
+
 #ifdef ENABLE_FILTER_LOGGING
 struct
 {
     __uint(type, BPF_MAP_TYPE_RINGBUF);
     __uint(max_entries, 1 << 16);
 } map_filter_log SEC(".maps");
+
+// The sampling state of each filter rule keyed by the rule's config index (the same ID for every filter engine).
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, MAX_CFG_FILTERS);
+    __type(key, u32);
+    __type(value, filter_log_sample_t);
+} map_filter_log_sample SEC(".maps");
+
+// Matches that weren't logged are counted per rule and source IP and flushed by the loader (every `log_flush_time` seconds).
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+    __uint(max_entries, MAX_FILTER_LOG_SUPPRESSED);
+    __type(key, filter_log_suppressed_key_t);
+    __type(value, filter_log_suppressed_t);
+} map_filter_log_suppressed SEC(".maps");
+#endif
 #endif
+
+#ifdef ENABLE_TAIL_CALLS
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PROG_ARRAY);
+    __uint(max_entries, PIPELINE_STAGE_MAX);
+    __type(key, u32);
+    __type(value, u32);
+} map_pipeline SEC(".maps");
+
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, u32);
+    __type(value, pipeline_ctx_t);
+} map_pipeline_ctx SEC(".maps");
 #endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <xdp/utils/pipeline.h>
+
+#ifdef ENABLE_TAIL_CALLS
+/**
+ * Retrieves the per-CPU state shared between the XDP program stages.
+ * 
+ * @return A pointer to the pipeline context or NULL.
+ */
+static __always_inline pipeline_ctx_t* get_pipeline_ctx()
+{
+    u32 key = 0;
+
+    return bpf_map_lookup_elem(&map_pipeline_ctx, &key);
+}
+
+/**
+ * Retrieves the packet's IP and layer-4 headers using the offsets stored by the first stage.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param pctx A pointer to the pipeline context.
+ * @param hdrs A pointer to store the headers in (headers that don't exist are set to NULL).
+ * 
+ * @return 0 on success or 1 if a header is out of bounds.
+ */
+static __always_inline int load_pipeline_hdrs(struct xdp_md* ctx, pipeline_ctx_t* pctx, pipeline_hdrs_t* hdrs)
+{
+    void *data_end = (void *)(long)ctx->data_end;
+    void *data = (void *)(long)ctx->data;
+
+    // The verifier requires the offsets to be bounded before they're added to the packet pointer.
+    u16 l3_off = pctx->l3_off & 0xFF;
+    u16 l4_off = pctx->l4_off & 0x3FF;
+
+    if (pctx->ipv6)
+    {
+        hdrs->iph6 = data + l3_off;
+
+        if (hdrs->iph6 + 1 > (struct ipv6hdr *)data_end)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        hdrs->iph = data + l3_off;
+
+        if (hdrs->iph + 1 > (struct iphdr *)data_end)
+        {
+            return 1;
+        }
+    }
+
+    // Non-first fragments don't contain the layer-4 header.
+    if (pctx->frag == IP_FRAG_LATER)
+    {
+        return 0;
+    }
+
+    switch (pctx->protocol)
+    {
+        case IPPROTO_TCP:
+            hdrs->tcph = data + l4_off;
+
+            if (hdrs->tcph + 1 > (struct tcphdr *)data_end)
+            {
+                return 1;
+            }
+
+            break;
+
+        case IPPROTO_UDP:
+            hdrs->udph = data + l4_off;
+
+            if (hdrs->udph + 1 > (struct udphdr *)data_end)
+            {
+                return 1;
+            }
+
+            break;
+
+        case IPPROTO_ICMP:
+            hdrs->icmph = data + l4_off;
+
+            if (hdrs->icmph + 1 > (struct icmphdr *)data_end)
+            {
+                return 1;
+            }
+
+            break;
+
+        case IPPROTO_ICMPV6:
+            hdrs->icmph6 = data + l4_off;
+
+            if (hdrs->icmph6 + 1 > (struct icmp6hdr *)data_end)
+            {
+                return 1;
+            }
+
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * Tail calls the next XDP program stage starting at the given stage (stages that aren't set by the loader are skipped).
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param stage The first stage to try.
+ * 
+ * @return void (only returns if no stage is left)
+ */
+static __always_inline void pipeline_next(struct xdp_md* ctx, u32 stage)
+{
+#pragma unroll
+    for (u32 i = stage; i < PIPELINE_STAGE_MAX; i++)
+    {
+        bpf_tail_call(ctx, &map_pipeline, i);
+    }
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+
+#include <xdp/utils/maps.h>
+
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/udp.h>
+#include <linux/tcp.h>
+#include <linux/icmp.h>
+#include <linux/icmpv6.h>
+
+struct pipeline_hdrs
+{
+    struct iphdr* iph;
+    struct ipv6hdr* iph6;
+
+    struct tcphdr* tcph;
+    struct udphdr* udph;
+    struct icmphdr* icmph;
+
+    struct icmp6hdr* icmph6;
+} typedef pipeline_hdrs_t;
+
+#ifdef ENABLE_TAIL_CALLS
+static __always_inline pipeline_ctx_t* get_pipeline_ctx();
+static __always_inline int load_pipeline_hdrs(struct xdp_md* ctx, pipeline_ctx_t* pctx, pipeline_hdrs_t* hdrs);
+static __always_inline void pipeline_next(struct xdp_md* ctx, u32 stage);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "pipeline.c"
\ No newline at end of file
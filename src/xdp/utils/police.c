@@ -0,0 +1,96 @@
+#include <xdp/utils/police.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_POLICE)
+/**
+ * Takes a packet's length out of the matched police rule's token bucket for the packet's source.
+ * 
+ * @param rule A pointer to the rule context.
+ * @param src_ip The IPv4 source address.
+ * @param src_ip6 A pointer to the IPv6 source address.
+ * @param ipv6 Whether the packet is an IPv6 packet.
+ * @param now The current timestamp.
+ * 
+ * @return 1 if the packet is within the rule's rate and burst or 0 if the packet should be dropped.
+ */
+static __always_inline int police_packet(rule_ctx_t* rule, u32 src_ip, u128* src_ip6, int ipv6, u64 now)
+{
+    police_key_t key;
+    __builtin_memset(&key, 0, sizeof(key));
+
+    key.rule = rule->police_idx;
+
+    if (ipv6)
+    {
+        key.ip = *src_ip6;
+    }
+    else
+    {
+        key.ip = src_ip;
+    }
+
+    if (rule->police_flow)
+    {
+        key.port = rule->src_port;
+        key.protocol = rule->protocol;
+    }
+
+    police_bucket_t* bucket = bpf_map_lookup_elem(&map_police, &key);
+
+    if (!bucket)
+    {
+        // New sources start with a full bucket.
+        if (rule->pkt_len > rule->police_burst)
+        {
+            return 0;
+        }
+
+        police_bucket_t new = {0};
+        new.tokens = rule->police_burst - rule->pkt_len;
+        new.last_update = now;
+
+        bpf_map_update_elem(&map_police, &key, &new, BPF_ANY);
+
+        return 1;
+    }
+
+    // The bucket isn't locked, so concurrent updates from other CPUs may let slightly more than the burst through.
+    u64 elapsed = now - bucket->last_update;
+    u64 refill;
+
+    // Whole seconds are refilled separately so the multiplication can't overflow.
+    if (elapsed >= NANO_TO_SEC)
+    {
+        refill = (elapsed / NANO_TO_SEC) * rule->police_rate;
+    }
+    else
+    {
+        refill = (elapsed * rule->police_rate) / NANO_TO_SEC;
+    }
+
+    u64 tokens = bucket->tokens;
+
+    // The last update is only moved forward once tokens are refilled so low rates still refill with high packet rates.
+    if (refill > 0)
+    {
+        tokens += refill;
+
+        if (tokens > rule->police_burst)
+        {
+            tokens = rule->police_burst;
+        }
+
+        bucket->last_update = now;
+    }
+
+    if (tokens < rule->pkt_len)
+    {
+        bucket->tokens = tokens;
+
+        return 0;
+    }
+
+    bucket->tokens = tokens - rule->pkt_len;
+
+    return 1;
+}
+#endif
\ No newline at end of file
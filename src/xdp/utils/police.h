@@ -0,0 +1,17 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/rule.h>
+
+#include <xdp/utils/maps.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_POLICE)
+static __always_inline int police_packet(rule_ctx_t* rule, u32 src_ip, u128* src_ip6, int ipv6, u64 now);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "police.c"
\ No newline at end of file
@@ -2,7 +2,195 @@
 
 #ifdef ENABLE_FILTERS
 
+/**
+ * Counts a packet inside of the client's current window.
+ * 
+ * @param stats A pointer to the client stats.
+ * @param pkt_len The total packet length.
+ * 
+ * @return void
+ */
+static __always_inline void inc_cl_stats(cl_stats_t* stats, u16 pkt_len)
+{
+#ifdef ENABLE_RL_PERCPU
+    // Each CPU has its own entry, so atomic operations aren't needed.
+    stats->pps++;
+    stats->bps += pkt_len;
+#else
+    // Increment PPS and BPS using built-in functions.
+    __sync_fetch_and_add(&stats->pps, 1);
+    __sync_fetch_and_add(&stats->bps, pkt_len);
+#endif
+}
+
+#if !defined(RL_IP_SLIDING_WINDOW) || !defined(RL_FLOW_SLIDING_WINDOW)
+/**
+ * Updates client stats using a fixed one second window and retrieves the client's rates.
+ * 
+ * @param stats A pointer to the client stats.
+ * @param pps A pointer to the PPS integer.
+ * @param bps A pointer to the BPS integer.
+ * @param pkt_len The total packet length.
+ * @param now The current time since boot in nanoseconds.
+ * 
+ * @return void
+ */
+static __always_inline void update_cl_stats_fixed(cl_stats_t* stats, u64 *pps, u64 *bps, u16 pkt_len, u64 now)
+{
+    // Check for next update.
+    if (now > stats->next_update)
+    {
+        stats->pps = 1;
+        stats->bps = pkt_len;
+        stats->next_update = now + NANO_TO_SEC;
+    }
+    else
+    {
+        inc_cl_stats(stats, pkt_len);
+    }
+
+    *pps = stats->pps;
+    *bps = stats->bps;
+}
+#endif
+
+#if defined(RL_IP_SLIDING_WINDOW) || defined(RL_FLOW_SLIDING_WINDOW)
+/**
+ * Updates client stats using a sliding window and retrieves the client's estimated rates.
+ * The previous one second window's counters are weighted by how much of it still overlaps the last second.
+ * 
+ * @param stats A pointer to the client stats.
+ * @param pps A pointer to the PPS integer.
+ * @param bps A pointer to the BPS integer.
+ * @param pkt_len The total packet length.
+ * @param now The current time since boot in nanoseconds.
+ * 
+ * @return void
+ */
+static __always_inline void update_cl_stats_sliding(cl_stats_t* stats, u64 *pps, u64 *bps, u16 pkt_len, u64 now)
+{
+    if (now > stats->next_update)
+    {
+        // The current window only becomes the previous window if it ended less than a window ago.
+        if (now - stats->next_update < NANO_TO_SEC)
+        {
+            stats->prev_pps = stats->pps;
+            stats->prev_bps = stats->bps;
+            stats->next_update += NANO_TO_SEC;
+        }
+        else
+        {
+            stats->prev_pps = 0;
+            stats->prev_bps = 0;
+            stats->next_update = now + NANO_TO_SEC;
+        }
+
+        stats->pps = 1;
+        stats->bps = pkt_len;
+    }
+    else
+    {
+        inc_cl_stats(stats, pkt_len);
+    }
+
+    // The remaining time is shifted to microsecond precision (1024 ns) so the fixed-point multiplication can't overflow.
+    u64 remaining = (stats->next_update - now) >> 10;
+
+    *pps = stats->pps + ((stats->prev_pps * remaining) / (NANO_TO_SEC >> 10));
+    *bps = stats->bps + ((stats->prev_bps * remaining) / (NANO_TO_SEC >> 10));
+}
+#endif
+
 #ifdef ENABLE_RL_IP
+#ifdef ENABLE_RL_SKETCH
+/**
+ * Clears a single counter of a count-min sketch row.
+ * 
+ * @param i The counter's index.
+ * @param data A pointer to the sketch row.
+ * 
+ * @return always 0
+ */
+static __always_inline long clear_sketch_col(u32 i, void* data)
+{
+    rl_sketch_row_t* row = data;
+
+    u32 col = i & (RL_SKETCH_COLS - 1);
+
+    row->pps[col] = 0;
+    row->bps[col] = 0;
+
+    return 0;
+}
+
+/**
+ * Adds a packet to the source IP count-min sketch and retrieves the source's estimated rates.
+ * 
+ * @param pps A pointer to the PPS integer.
+ * @param bps A pointer to the BPS integer.
+ * @param hash The client's source IP hash.
+ * @param pkt_len The total packet length.
+ * @param now The current time since boot in nanoseconds.
+ * 
+ * @return 1 if the estimated rates crossed the promotion thresholds or 0 otherwise.
+ */
+static __always_inline int update_ip_sketch(u64 *pps, u64 *bps, u32 hash, u16 pkt_len, u64 now)
+{
+    u32 min_pps = 0xFFFFFFFF;
+    u32 min_bps = 0xFFFFFFFF;
+
+#pragma unroll
+    for (u32 i = 0; i < RL_SKETCH_ROWS; i++)
+    {
+        u32 key = i;
+
+        rl_sketch_row_t* row = bpf_map_lookup_elem(&map_ip_sketch, &key);
+
+        if (!row)
+        {
+            return 0;
+        }
+
+        // The counters are reset every second instead of inserting and evicting entries.
+        if (now > row->next_update)
+        {
+#ifdef USE_NEW_LOOP
+            bpf_loop(RL_SKETCH_COLS, clear_sketch_col, row, 0);
+#else
+            for (u32 j = 0; j < RL_SKETCH_COLS; j++)
+            {
+                clear_sketch_col(j, row);
+            }
+#endif
+
+            row->next_update = now + NANO_TO_SEC;
+        }
+
+        u32 col = hash_mix32(hash + (i * RL_SKETCH_HASH_SEED)) & (RL_SKETCH_COLS - 1);
+
+        row->pps[col]++;
+        row->bps[col] += pkt_len;
+
+        // The smallest counter is the closest to the source's real rates.
+        if (row->pps[col] < min_pps)
+        {
+            min_pps = row->pps[col];
+        }
+
+        if (row->bps[col] < min_bps)
+        {
+            min_bps = row->bps[col];
+        }
+    }
+
+    // Each CPU has its own sketch, so estimate the source's total rates.
+    *pps = (u64)min_pps * features.rl_percpu_scale;
+    *bps = (u64)min_bps * features.rl_percpu_scale;
+
+    return *pps >= RL_SKETCH_PROMOTE_PPS || *bps >= RL_SKETCH_PROMOTE_BPS;
+}
+#endif
+
 /**
  * Updates source IPv4 address stats.
  * 
@@ -18,32 +206,44 @@ static __always_inline int update_ip_stats(u64 *pps, u64 *bps, u32 ip, u16 pkt_l
 {
     cl_stats_t* stats = bpf_map_lookup_elem(&map_ip_stats, &ip);
 
-    if (stats)
+#ifdef ENABLE_RL_SKETCH
+    // Sources are only inserted into the rate limit map once their estimated rates cross the promotion thresholds.
+    if (!stats && !update_ip_sketch(pps, bps, ip, pkt_len, now))
     {
-        // Check for next update.
-        if (now > stats->next_update)
-        {
-            stats->pps = 1;
-            stats->bps = pkt_len;
-            stats->next_update = now + NANO_TO_SEC;
-        }
-        else
-        {
-            // Increment PPS and BPS using built-in functions.
-            __sync_fetch_and_add(&stats->pps, 1);
-            __sync_fetch_and_add(&stats->bps, pkt_len);
-        }
+        return 0;
+    }
+#endif
 
-        *pps = stats->pps;
-        *bps = stats->bps;
+    if (stats)
+    {
+#ifdef RL_IP_SLIDING_WINDOW
+        update_cl_stats_sliding(stats, pps, bps, pkt_len, now);
+#else
+        update_cl_stats_fixed(stats, pps, bps, pkt_len, now);
+#endif
     }
     else
     {
         // Create new entry.
         cl_stats_t new = {0};
 
+#ifdef ENABLE_RL_SKETCH
+        // Start from the estimate that promoted the source, otherwise its rates would drop to a single packet right after the promotion.
+        new.pps = *pps;
+        new.bps = *bps;
+
+#ifdef ENABLE_RL_PERCPU
+        // The estimate covers all CPUs while the entry only counts this CPU's share.
+        if (features.rl_percpu_scale > 0)
+        {
+            new.pps /= features.rl_percpu_scale;
+            new.bps /= features.rl_percpu_scale;
+        }
+#endif
+#else
         new.pps = 1;
         new.bps = pkt_len;
+#endif
         new.next_update = now + NANO_TO_SEC;
 
         *pps = new.pps;
@@ -52,6 +252,12 @@ static __always_inline int update_ip_stats(u64 *pps, u64 *bps, u32 ip, u16 pkt_l
         bpf_map_update_elem(&map_ip_stats, &ip, &new, BPF_ANY);
     }
 
+#ifdef ENABLE_RL_PERCPU
+    // Only this CPU's share of the source's packets is counted, so estimate the source's total rates.
+    *pps *= features.rl_percpu_scale;
+    *bps *= features.rl_percpu_scale;
+#endif
+
     return 0;
 }
 
@@ -71,32 +277,45 @@ static __always_inline int update_ip6_stats(u64 *pps, u64 *bps, u128 *ip, u16 pk
 {
     cl_stats_t* stats = bpf_map_lookup_elem(&map_ip6_stats, ip);
 
-    if (stats)
+#ifdef ENABLE_RL_SKETCH
+    u32* ip32 = (u32*)ip;
+
+    if (!stats && !update_ip_sketch(pps, bps, ip32[0] ^ hash_mix32(ip32[1] ^ hash_mix32(ip32[2] ^ hash_mix32(ip32[3]))), pkt_len, now))
     {
-        // Check for next update.
-        if (now > stats->next_update)
-        {
-            stats->pps = 1;
-            stats->bps = pkt_len;
-            stats->next_update = now + NANO_TO_SEC;
-        }
-        else
-        {
-            // Increment PPS and BPS using built-in functions.
-            __sync_fetch_and_add(&stats->pps, 1);
-            __sync_fetch_and_add(&stats->bps, pkt_len);
-        }
+        return 0;
+    }
+#endif
 
-        *pps = stats->pps;
-        *bps = stats->bps;
+    if (stats)
+    {
+#ifdef RL_IP_SLIDING_WINDOW
+        update_cl_stats_sliding(stats, pps, bps, pkt_len, now);
+#else
+        update_cl_stats_fixed(stats, pps, bps, pkt_len, now);
+#endif
     }
     else
     {
         // Create new entry.
         cl_stats_t new = {0};
 
+#ifdef ENABLE_RL_SKETCH
+        // Start from the estimate that promoted the source, otherwise its rates would drop to a single packet right after the promotion.
+        new.pps = *pps;
+        new.bps = *bps;
+
+#ifdef ENABLE_RL_PERCPU
+        // The estimate covers all CPUs while the entry only counts this CPU's share.
+        if (features.rl_percpu_scale > 0)
+        {
+            new.pps /= features.rl_percpu_scale;
+            new.bps /= features.rl_percpu_scale;
+        }
+#endif
+#else
         new.pps = 1;
         new.bps = pkt_len;
+#endif
         new.next_update = now + NANO_TO_SEC;
 
         *pps = new.pps;
@@ -105,6 +324,12 @@ static __always_inline int update_ip6_stats(u64 *pps, u64 *bps, u128 *ip, u16 pk
         bpf_map_update_elem(&map_ip6_stats, ip, &new, BPF_ANY);
     }
 
+#ifdef ENABLE_RL_PERCPU
+    // Only this CPU's share of the source's packets is counted, so estimate the source's total rates.
+    *pps *= features.rl_percpu_scale;
+    *bps *= features.rl_percpu_scale;
+#endif
+
     return 0;
 }
 #endif
@@ -135,22 +360,11 @@ static __always_inline int update_flow_stats(u64 *pps, u64 *bps, u32 ip, u16 por
 
     if (stats)
     {
-        // Check for next update.
-        if (now > stats->next_update)
-        {
-            stats->pps = 1;
-            stats->bps = pkt_len;
-            stats->next_update = now + NANO_TO_SEC;
-        }
-        else
-        {
-            // Increment PPS and BPS using built-in functions.
-            __sync_fetch_and_add(&stats->pps, 1);
-            __sync_fetch_and_add(&stats->bps, pkt_len);
-        }
-
-        *pps = stats->pps;
-        *bps = stats->bps;
+#ifdef RL_FLOW_SLIDING_WINDOW
+        update_cl_stats_sliding(stats, pps, bps, pkt_len, now);
+#else
+        update_cl_stats_fixed(stats, pps, bps, pkt_len, now);
+#endif
     }
     else
     {
@@ -195,22 +409,11 @@ static __always_inline int update_flow6_stats(u64 *pps, u64 *bps, u128 *ip, u16
 
     if (stats)
     {
-        // Check for next update.
-        if (now > stats->next_update)
-        {
-            stats->pps = 1;
-            stats->bps = pkt_len;
-            stats->next_update = now + NANO_TO_SEC;
-        }
-        else
-        {
-            // Increment PPS and BPS using built-in functions.
-            __sync_fetch_and_add(&stats->pps, 1);
-            __sync_fetch_and_add(&stats->bps, pkt_len);
-        }
-
-        *pps = stats->pps;
-        *bps = stats->bps;
+#ifdef RL_FLOW_SLIDING_WINDOW
+        update_cl_stats_sliding(stats, pps, bps, pkt_len, now);
+#else
+        update_cl_stats_fixed(stats, pps, bps, pkt_len, now);
+#endif
     }
     else
     {
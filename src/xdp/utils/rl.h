@@ -1,10 +1,12 @@
 #pragma once
 
 #include <common/all.h>
+#include <common/hash.h>
 
 #include <xdp/utils/helpers.h>
 
 #include <xdp/utils/maps.h>
+#include <xdp/utils/features.h>
 
 #ifdef ENABLE_FILTERS
 static __always_inline int update_ip_stats(u64 *pps, u64 *bps, u32 ip, u16 pkt_len, u64 now);
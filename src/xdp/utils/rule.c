@@ -2,24 +2,15 @@
 
 #ifdef ENABLE_FILTERS
 /**
- * Processes a filter rule.
+ * Checks a filter rule's rate limit thresholds against the client's current rates.
  * 
- * @param idx The rule index.
- * @param data A pointer to the rule context.
+ * @param filter A pointer to the filter rule.
+ * @param ctx A pointer to the rule context.
  * 
- * @return 1 to break the loop or 0 to continue.
+ * @return 1 if every threshold set on the rule is exceeded or 0 otherwise.
  */
-static __always_inline long process_rule(u32 idx, void* data)
+static __always_inline int check_rule_rl(filter_t* filter, rule_ctx_t* ctx)
 {
-    rule_ctx_t* ctx = data;
-
-    filter_t *filter = bpf_map_lookup_elem(&map_filters, &idx);
-
-    if (!filter || !filter->set)
-    {
-        return 1;
-    }
-
 #ifdef ENABLE_RL_IP
     // Check source IP rate limits.
     if (filter->do_ip_pps && ctx->ip_pps < filter->ip_pps)
@@ -46,6 +37,100 @@ static __always_inline long process_rule(u32 idx, void* data)
     }
 #endif
 
+    return 1;
+}
+
+/**
+ * Checks a filter rule's VLAN ID and fragment settings against the packet.
+ * 
+ * @param filter A pointer to the filter rule.
+ * @param ctx A pointer to the rule context.
+ * 
+ * @return 1 if the packet matches or 0 otherwise.
+ */
+static __always_inline int check_rule_pkt(filter_t* filter, rule_ctx_t* ctx)
+{
+#ifdef ENABLE_VLAN
+    // Outer VLAN ID.
+    if (filter->do_vlan_id && filter->vlan_id != ctx->vlan_id)
+    {
+        return 0;
+    }
+#endif
+
+    // Fragment type (IP_FRAG_ANY matches first and non-first fragments).
+    if (filter->ip.do_frag && (filter->ip.frag == IP_FRAG_ANY ? ctx->frag == IP_FRAG_NONE : filter->ip.frag != ctx->frag))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Stores a matched filter rule inside of the rule context and logs the match if enabled.
+ * 
+ * @param filter A pointer to the filter rule that matched.
+ * @param ctx A pointer to the rule context.
+ * @param idx The rule index.
+ * 
+ * @return void
+ */
+static __always_inline void set_rule_matched(filter_t* filter, rule_ctx_t* ctx, u32 idx)
+{
+#ifdef ENABLE_FILTER_LOGGING
+    if (filter->log > 0 && features.filter_logging)
+    {
+        log_filter_msg(ctx->iph, ctx->iph6, ctx->src_port, ctx->dst_port, ctx->protocol, ctx->now, ctx->ip_pps, ctx->ip_bps, ctx->flow_pps, ctx->flow_bps, ctx->pkt_len, filter->id, filter->sample_rate, filter->sample_pps);
+    }
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+    inc_filter_stats(filter->id, ctx->pkt_len, ctx->now);
+#endif
+    
+    ctx->matched = 1;
+    ctx->action = filter->action;
+    ctx->block_time = filter->block_time;
+
+#ifdef ENABLE_FILTERS_CACHE
+    ctx->cache_deps = idx + 1;
+
+#ifdef ENABLE_FILTER_STATS
+    ctx->id = filter->id;
+#endif
+#endif
+
+#ifdef ENABLE_FILTER_POLICE
+    ctx->police_idx = idx;
+    ctx->police_flow = filter->police_flow;
+    ctx->police_rate = filter->police_rate;
+    ctx->police_burst = filter->police_burst;
+#endif
+}
+
+/**
+ * Checks whether a packet matches a filter rule.
+ * 
+ * @param filter A pointer to the filter rule.
+ * @param ctx A pointer to the rule context.
+ * 
+ * @return 1 if the packet matches or 0 otherwise.
+ */
+static __always_inline int match_rule(filter_t* filter, rule_ctx_t* ctx)
+{
+    // Check rate limits.
+    if (!check_rule_rl(filter, ctx))
+    {
+        return 0;
+    }
+
+    // Check VLAN ID and fragments.
+    if (!check_rule_pkt(filter, ctx))
+    {
+        return 0;
+    }
+
     // Max packet length.
     if (filter->ip.do_max_len && filter->ip.max_len < ctx->pkt_len)
     {
@@ -90,7 +175,7 @@ static __always_inline long process_rule(u32 idx, void* data)
         }
 
 #if defined(ENABLE_IPV6) && defined(ALLOW_SINGLE_IP_V4_V6)
-        if ((filter->ip.src_ip6[0] != 0 || filter->ip.src_ip6[1] != 0 || filter->ip.src_ip6[2] != 0 || filter->ip.src_ip6[3] != 0) || (filter->ip.dst_ip6[0] != 0 || filter->ip.dst_ip6[1] != 0 || filter->ip.dst_ip6[2] != 0 || filter->ip.dst_ip6[3] != 0))
+        if (filter->ip.src_cidr6 || filter->ip.dst_cidr6)
         {
             return 0;
         }
@@ -118,13 +203,13 @@ static __always_inline long process_rule(u32 idx, void* data)
     else if (ctx->iph6)
     {
         // Source address.
-        if (filter->ip.src_ip6[0] != 0 && (ctx->iph6->saddr.in6_u.u6_addr32[0] != filter->ip.src_ip6[0] || ctx->iph6->saddr.in6_u.u6_addr32[1] != filter->ip.src_ip6[1] || ctx->iph6->saddr.in6_u.u6_addr32[2] != filter->ip.src_ip6[2] || ctx->iph6->saddr.in6_u.u6_addr32[3] != filter->ip.src_ip6[3]))
+        if (filter->ip.src_cidr6 && !is_ip6_in_range(ctx->iph6->saddr.in6_u.u6_addr32, filter->ip.src_ip6, filter->ip.src_cidr6))
         {
             return 0;
         }
 
         // Destination address.
-        if (filter->ip.dst_ip6[0] != 0 && (ctx->iph6->daddr.in6_u.u6_addr32[0] != filter->ip.dst_ip6[0] || ctx->iph6->daddr.in6_u.u6_addr32[1] != filter->ip.dst_ip6[1] || ctx->iph6->daddr.in6_u.u6_addr32[2] != filter->ip.dst_ip6[2] || ctx->iph6->daddr.in6_u.u6_addr32[3] != filter->ip.dst_ip6[3]))
+        if (filter->ip.dst_cidr6 && !is_ip6_in_range(ctx->iph6->daddr.in6_u.u6_addr32, filter->ip.dst_ip6, filter->ip.dst_cidr6))
         {
             return 0;
         }
@@ -296,17 +381,42 @@ static __always_inline long process_rule(u32 idx, void* data)
         }
     }
 
-#ifdef ENABLE_FILTER_LOGGING
-    if (filter->log > 0)
+    return 1;
+}
+
+/**
+ * Processes a filter rule.
+ * 
+ * @param idx The rule index.
+ * @param data A pointer to the rule context.
+ * 
+ * @return 1 to break the loop or 0 to continue.
+ */
+static __always_inline long process_rule(u32 idx, void* data)
+{
+    rule_ctx_t* ctx = data;
+
+#ifdef ENABLE_FILTERS_TSS
+    if (idx >= ctx->max_idx)
     {
-        log_filter_msg(ctx->iph, ctx->iph6, ctx->src_port, ctx->dst_port, ctx->protocol, ctx->now, ctx->ip_pps, ctx->ip_bps, ctx->flow_pps, ctx->flow_bps, ctx->pkt_len, idx);
+        return 1;
     }
 #endif
-    
+
+    filter_t *filter = bpf_map_lookup_elem(&map_filters, &idx);
+
+    if (!filter || !filter->set)
+    {
+        return 1;
+    }
+
+    if (!match_rule(filter, ctx))
+    {
+        return 0;
+    }
+
     // Matched.
-    ctx->matched = 1;
-    ctx->action = filter->action;
-    ctx->block_time = filter->block_time;
+    set_rule_matched(filter, ctx, idx);
 
     return 1;
 }
@@ -3,8 +3,10 @@
 #include <common/all.h>
 
 #include <xdp/utils/logging.h>
+#include <xdp/utils/stats.h>
 
 #include <xdp/utils/maps.h>
+#include <xdp/utils/features.h>
 
 #include <linux/ip.h>
 #include <linux/ipv6.h>
@@ -27,14 +29,26 @@ struct rule_ctx
     u64 flow_pps;
     u64 flow_bps;
 
-#ifdef ENABLE_FILTER_LOGGING
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_STATS)
     u64 now;
+#endif
 
+#if defined(ENABLE_FILTER_LOGGING) || defined(ENABLE_FILTER_POLICE)
     u8 protocol;
     u16 src_port;
+#endif
+
+#ifdef ENABLE_FILTER_LOGGING
     u16 dst_port;
 #endif
 
+    // The fragment type (IP_FRAG_*).
+    u8 frag;
+
+#ifdef ENABLE_VLAN
+    u16 vlan_id;
+#endif
+
     struct iphdr* iph;
     struct ipv6hdr* iph6;
 
@@ -43,9 +57,41 @@ struct rule_ctx
     struct icmphdr* icmph;
 
     struct icmp6hdr* icmph6;
+
+#ifdef ENABLE_FILTER_POLICE
+    // The matched rule's index and token bucket settings (police action).
+    u32 police_idx;
+    unsigned int police_flow : 1;
+    u64 police_rate;
+    u64 police_burst;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+    // The packet's interface index and RX queue (inspect action).
+    u32 ifindex;
+    u32 rx_queue;
+#endif
+
+#ifdef ENABLE_FILTERS_TSS
+    // Only filter rules below this index are processed (they have a higher priority than the matched exact match rule).
+    u32 max_idx;
+#endif
+
+#ifdef ENABLE_FILTERS_CACHE
+    // The amount of rules at the start of the filters map the matched rule depends on (compared against the cacheable rules by the verdict cache).
+    u32 cache_deps;
+
+#ifdef ENABLE_FILTER_STATS
+    u32 id;
+#endif
+#endif
 } typedef rule_ctx_t;
 
 #ifdef ENABLE_FILTERS
+static __always_inline int check_rule_rl(filter_t* filter, rule_ctx_t* ctx);
+static __always_inline int check_rule_pkt(filter_t* filter, rule_ctx_t* ctx);
+static __always_inline void set_rule_matched(filter_t* filter, rule_ctx_t* ctx, u32 idx);
+static __always_inline int match_rule(filter_t* filter, rule_ctx_t* ctx);
 static __always_inline long process_rule(u32 idx, void* data);
 #endif
 
@@ -23,7 +23,64 @@ static __always_inline int inc_pkt_stats(stats_t* stats, STATS_TYPE_T type)
             stats->dropped++;
 
             break;
+
+#ifdef ENABLE_BLOCK_BLOOM
+        case STATS_TYPE_BLOOM_HIT:
+            stats->bloom_hits++;
+
+            break;
+
+        case STATS_TYPE_BLOOM_FALSE_HIT:
+            stats->bloom_false_hits++;
+
+            break;
+#endif
+
+#ifdef ENABLE_FILTER_INSPECT
+        case STATS_TYPE_INSPECTED:
+            stats->inspected++;
+
+            break;
+#endif
+
+#ifdef ENABLE_SYN_PROXY
+        case STATS_TYPE_SYN_PROXY:
+            stats->syn_proxy++;
+
+            break;
+#endif
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_STATS)
+/**
+ * Increments a filter rule's hit and byte counters.
+ *
+ * @param id The filter rule's ID.
+ * @param pkt_len The packet length.
+ * @param now The current timestamp.
+ *
+ * @return void
+ */
+static __always_inline void inc_filter_stats(u32 id, int pkt_len, u64 now)
+{
+    if (!features.filter_stats)
+    {
+        return;
+    }
+
+    filter_stats_t* stats = bpf_map_lookup_elem(&map_filter_stats, &id);
+
+    if (!stats)
+    {
+        return;
+    }
+
+    // The map is per-CPU, so we don't need atomic operations.
+    stats->hits++;
+    stats->bytes += pkt_len;
+    stats->last_hit = now;
+}
+#endif
\ No newline at end of file
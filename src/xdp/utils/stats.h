@@ -7,15 +7,32 @@
 #include <xdp/xdp_helpers.h>
 #include <xdp/prog_dispatcher.h>
 
+#include <xdp/utils/maps.h>
+#include <xdp/utils/features.h>
+
 enum STATS_TYPE
 {
     STATS_TYPE_ALLOWED = 0,
     STATS_TYPE_PASSED,
-    STATS_TYPE_DROPPED
+    STATS_TYPE_DROPPED,
+#ifdef ENABLE_BLOCK_BLOOM
+    STATS_TYPE_BLOOM_HIT,
+    STATS_TYPE_BLOOM_FALSE_HIT,
+#endif
+#ifdef ENABLE_FILTER_INSPECT
+    STATS_TYPE_INSPECTED,
+#endif
+#ifdef ENABLE_SYN_PROXY
+    STATS_TYPE_SYN_PROXY,
+#endif
 } typedef STATS_TYPE_T;
 
 static __always_inline int inc_pkt_stats(stats_t* stats, STATS_TYPE_T type);
 
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTER_STATS)
+static __always_inline void inc_filter_stats(u32 id, int pkt_len, u64 now);
+#endif
+
 // The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
 // I'd prefer not to include the function logic inside of the header file.
 // More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
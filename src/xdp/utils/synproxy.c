@@ -0,0 +1,407 @@
+#include <xdp/utils/synproxy.h>
+
+#ifdef ENABLE_SYN_PROXY
+/**
+ * Folds a 32-bit one's complement sum into a 16-bit checksum.
+ * 
+ * @param csum The 32-bit sum.
+ * 
+ * @return The checksum.
+ */
+static __always_inline u16 syn_proxy_csum_fold(u32 csum)
+{
+    csum = (csum & 0xFFFF) + (csum >> 16);
+    csum = (csum & 0xFFFF) + (csum >> 16);
+
+    return ~csum;
+}
+
+/**
+ * Calculates the IPv4 header and TCP checksums of a reply (the TCP header doesn't contain options or a payload).
+ * 
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param tcph A pointer to the TCP header.
+ * 
+ * @return void
+ */
+static __always_inline void syn_proxy_set_csums(struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph)
+{
+    u32 csum = 0;
+
+    if (iph)
+    {
+        iph->check = 0;
+
+        u16* words = (u16*)iph;
+
+#pragma unroll
+        for (int i = 0; i < sizeof(struct iphdr) / 2; i++)
+        {
+            csum += words[i];
+        }
+
+        iph->check = syn_proxy_csum_fold(csum);
+
+        // TCP pseudo header.
+        csum = (iph->saddr >> 16) + (iph->saddr & 0xFFFF) + (iph->daddr >> 16) + (iph->daddr & 0xFFFF);
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+#pragma unroll
+        for (int i = 0; i < 8; i++)
+        {
+            csum += iph6->saddr.in6_u.u6_addr16[i] + iph6->daddr.in6_u.u6_addr16[i];
+        }
+    }
+#endif
+
+    csum += htons(IPPROTO_TCP) + htons(sizeof(struct tcphdr));
+
+    tcph->check = 0;
+
+    u16* words = (u16*)tcph;
+
+#pragma unroll
+    for (int i = 0; i < sizeof(struct tcphdr) / 2; i++)
+    {
+        csum += words[i];
+    }
+
+    tcph->check = syn_proxy_csum_fold(csum);
+}
+
+/**
+ * Turns the received packet into a TCP reply to its source (without TCP options or payload).
+ * 
+ * The frame is trimmed to the reply's headers, so the SYN's options and any payload aren't sent back.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param eth A pointer to the ethernet header.
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param tcph A pointer to the TCP header.
+ * @param seq The reply's sequence number (host byte order).
+ * @param ack_seq The reply's acknowledgement number (host byte order).
+ * @param flags The reply's TCP flags (TCP_FLAGS_*).
+ * 
+ * @return 0 on success or error value of bpf_xdp_adjust_tail().
+ */
+static __always_inline int syn_proxy_reply(struct xdp_md* ctx, struct ethhdr* eth, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, u32 seq, u32 ack_seq, u8 flags)
+{
+    u8 mac[ETH_ALEN];
+
+    memcpy(mac, eth->h_source, ETH_ALEN);
+    memcpy(eth->h_source, eth->h_dest, ETH_ALEN);
+    memcpy(eth->h_dest, mac, ETH_ALEN);
+
+    if (iph)
+    {
+        u32 addr = iph->saddr;
+
+        iph->saddr = iph->daddr;
+        iph->daddr = addr;
+
+        iph->tos = 0;
+        iph->tot_len = htons(sizeof(struct iphdr) + sizeof(struct tcphdr));
+        iph->id = 0;
+        iph->frag_off = htons(IPV4_FRAG_DF);
+        iph->ttl = SYN_PROXY_TTL;
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        struct in6_addr addr = iph6->saddr;
+
+        iph6->saddr = iph6->daddr;
+        iph6->daddr = addr;
+
+        iph6->payload_len = htons(sizeof(struct tcphdr));
+        iph6->hop_limit = SYN_PROXY_TTL;
+    }
+#endif
+
+    u16 port = tcph->source;
+
+    tcph->source = tcph->dest;
+    tcph->dest = port;
+
+    tcph->seq = htonl(seq);
+    tcph->ack_seq = htonl(ack_seq);
+
+    // The data offset is stored in the upper four bits of the 13th byte and the flags are stored in the 14th byte.
+    ((u8*)tcph)[12] = (sizeof(struct tcphdr) / 4) << 4;
+    ((u8*)tcph)[13] = flags;
+
+    tcph->window = 0;
+    tcph->urg_ptr = 0;
+
+    syn_proxy_set_csums(iph, iph6, tcph);
+
+    // The reply ends with the TCP header.
+    int excess = (void *)(long)ctx->data_end - (void*)(tcph + 1);
+
+    if (excess > 0)
+    {
+        return bpf_xdp_adjust_tail(ctx, -excess);
+    }
+
+    return 0;
+}
+
+#ifndef USE_RAW_SYNCOOKIE
+/**
+ * Generates the SYN cookie of a connection using the secret set by the loader.
+ * 
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param tcph A pointer to the TCP header.
+ * @param slot The time slot (SYN_COOKIE_SLOT_TIME seconds) the cookie is valid for.
+ * 
+ * @return The SYN cookie.
+ */
+static __always_inline u32 gen_syn_cookie(struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, u64 slot)
+{
+    u32 h = hash_mix32(features.syn_cookie_secret[0] ^ (u32)slot);
+
+    if (iph)
+    {
+        h = hash_mix32(h ^ iph->saddr);
+        h = hash_mix32(h ^ iph->daddr);
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+#pragma unroll
+        for (int i = 0; i < 4; i++)
+        {
+            h = hash_mix32(h ^ iph6->saddr.in6_u.u6_addr32[i]);
+            h = hash_mix32(h ^ iph6->daddr.in6_u.u6_addr32[i]);
+        }
+    }
+#endif
+
+    h = hash_mix32(h ^ (((u32)tcph->source << 16) | tcph->dest));
+
+    return hash_mix32(h ^ features.syn_cookie_secret[1]);
+}
+#endif
+
+/**
+ * Checks whether a source completed a SYN cookie handshake.
+ * 
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param now The current timestamp in nanoseconds.
+ * @param refresh Whether to extend the source's allow time.
+ * 
+ * @return 1 if the source is allowed or 0 otherwise.
+ */
+static __always_inline int check_syn_proxy_allowed(struct iphdr* iph, struct ipv6hdr* iph6, u64 now, int refresh)
+{
+    u64* expires = NULL;
+
+    if (iph)
+    {
+        u32 ip = iph->saddr;
+
+        expires = bpf_map_lookup_elem(&map_syn_proxy_allow, &ip);
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        u128 ip;
+        memcpy(&ip, iph6->saddr.in6_u.u6_addr32, sizeof(ip));
+
+        expires = bpf_map_lookup_elem(&map_syn_proxy_allow6, &ip);
+    }
+#endif
+
+    if (!expires || now > *expires)
+    {
+        return 0;
+    }
+
+    if (refresh)
+    {
+        *expires = now + ((u64)features.syn_proxy_allow_time * NANO_TO_SEC);
+    }
+
+    return 1;
+}
+
+/**
+ * Allows a source that completed a SYN cookie handshake.
+ * 
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param now The current timestamp in nanoseconds.
+ * 
+ * @return void
+ */
+static __always_inline void add_syn_proxy_allowed(struct iphdr* iph, struct ipv6hdr* iph6, u64 now)
+{
+    u64 expires = now + ((u64)features.syn_proxy_allow_time * NANO_TO_SEC);
+
+    if (iph)
+    {
+        u32 ip = iph->saddr;
+
+        bpf_map_update_elem(&map_syn_proxy_allow, &ip, &expires, BPF_ANY);
+    }
+#ifdef ENABLE_IPV6
+    else if (iph6)
+    {
+        u128 ip;
+        memcpy(&ip, iph6->saddr.in6_u.u6_addr32, sizeof(ip));
+
+        bpf_map_update_elem(&map_syn_proxy_allow6, &ip, &expires, BPF_ANY);
+    }
+#endif
+}
+
+/**
+ * Answers SYNs to protected destination ports with SYN cookies and allows sources that return a valid cookie.
+ * 
+ * Since the network stack never saw the handshake, the validated ACK is answered with a RST and the client's next SYN is passed.
+ * 
+ * @param ctx A pointer to the XDP context.
+ * @param stats A pointer to the stats map value.
+ * @param iph A pointer to the IPv4 header (NULL if IPv6).
+ * @param iph6 A pointer to the IPv6 header (NULL if IPv4).
+ * @param tcph A pointer to the TCP header (NULL if not TCP).
+ * 
+ * @return The XDP action or -1 to continue processing the packet.
+ */
+static __always_inline int do_syn_proxy(struct xdp_md* ctx, stats_t* stats, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph)
+{
+    void *data_end = (void *)(long)ctx->data_end;
+    void *data = (void *)(long)ctx->data;
+
+    if (!tcph)
+    {
+        return -1;
+    }
+
+    u16 port = tcph->dest;
+
+    if (!bpf_map_lookup_elem(&map_syn_proxy_ports, &port))
+    {
+        return -1;
+    }
+
+    u8 flags = ((u8*)tcph)[13] & (TCP_FLAGS_FIN | TCP_FLAGS_SYN | TCP_FLAGS_RST | TCP_FLAGS_ACK);
+
+    int syn = flags == TCP_FLAGS_SYN;
+    int ack = flags == TCP_FLAGS_ACK;
+
+    if (!syn && !ack)
+    {
+        return -1;
+    }
+
+    u64 now = get_time_ns();
+
+    // New connections refresh the allow time of allowed sources.
+    if (check_syn_proxy_allowed(iph, iph6, now, syn))
+    {
+        return -1;
+    }
+
+    // The reply is built inside of the received packet, so IP options, extension headers, and fragments aren't supported.
+    if (iph)
+    {
+        if (iph->ihl != 5 || (iph->frag_off & htons(IPV4_FRAG_OFFSET | IPV4_FRAG_MF)))
+        {
+            return -1;
+        }
+    }
+#ifdef ENABLE_IPV6
+    else if (!iph6 || (void*)tcph != (void*)(iph6 + 1))
+    {
+        return -1;
+    }
+#else
+    else
+    {
+        return -1;
+    }
+#endif
+
+    struct ethhdr* eth = data;
+
+    if (eth + 1 > (struct ethhdr*)data_end)
+    {
+        return -1;
+    }
+
+    u32 cookie;
+
+    if (syn)
+    {
+#ifdef USE_RAW_SYNCOOKIE
+        u32 th_len = tcph->doff * 4;
+
+        if (th_len < sizeof(struct tcphdr) || th_len > 60 || (void*)tcph + th_len > data_end)
+        {
+            return -1;
+        }
+
+        s64 val = iph ? bpf_tcp_raw_gen_syncookie_ipv4(iph, tcph, th_len) : bpf_tcp_raw_gen_syncookie_ipv6(iph6, tcph, th_len);
+
+        if (val < 0)
+        {
+            return -1;
+        }
+
+        // The upper 32 bits contain the MSS encoded inside of the cookie.
+        cookie = (u32)val;
+#else
+        cookie = gen_syn_cookie(iph, iph6, tcph, now / ((u64)SYN_COOKIE_SLOT_TIME * NANO_TO_SEC));
+#endif
+
+        // The packet was already rewritten, so it can't be processed any further.
+        if (syn_proxy_reply(ctx, eth, iph, iph6, tcph, cookie, ntohl(tcph->seq) + 1, TCP_FLAGS_SYN | TCP_FLAGS_ACK) != 0)
+        {
+            inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+            return XDP_DROP;
+        }
+
+        inc_pkt_stats(stats, STATS_TYPE_SYN_PROXY);
+
+        return XDP_TX;
+    }
+
+    cookie = ntohl(tcph->ack_seq) - 1;
+
+#ifdef USE_RAW_SYNCOOKIE
+    int valid = (iph ? bpf_tcp_raw_check_syncookie_ipv4(iph, tcph) : bpf_tcp_raw_check_syncookie_ipv6(iph6, tcph)) == 0;
+#else
+    // Cookies from the previous time slot are still accepted so handshakes started right before a new slot don't fail.
+    u64 slot = now / ((u64)SYN_COOKIE_SLOT_TIME * NANO_TO_SEC);
+
+    int valid = cookie == gen_syn_cookie(iph, iph6, tcph, slot) || cookie == gen_syn_cookie(iph, iph6, tcph, slot - 1);
+#endif
+
+    // ACKs without a valid cookie may belong to connections established before the source's allow time expired.
+    if (!valid)
+    {
+        return -1;
+    }
+
+    add_syn_proxy_allowed(iph, iph6, now);
+
+    if (syn_proxy_reply(ctx, eth, iph, iph6, tcph, cookie + 1, 0, TCP_FLAGS_RST) != 0)
+    {
+        inc_pkt_stats(stats, STATS_TYPE_DROPPED);
+
+        return XDP_DROP;
+    }
+
+    inc_pkt_stats(stats, STATS_TYPE_SYN_PROXY);
+
+    return XDP_TX;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <common/all.h>
+#include <common/hash.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/features.h>
+#include <xdp/utils/stats.h>
+
+#include <xdp/utils/maps.h>
+
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/tcp.h>
+#include <linux/in.h>
+
+#ifdef ENABLE_SYN_PROXY
+static __always_inline u16 syn_proxy_csum_fold(u32 csum);
+static __always_inline void syn_proxy_set_csums(struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph);
+static __always_inline int syn_proxy_reply(struct xdp_md* ctx, struct ethhdr* eth, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, u32 seq, u32 ack_seq, u8 flags);
+
+#ifndef USE_RAW_SYNCOOKIE
+static __always_inline u32 gen_syn_cookie(struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph, u64 slot);
+#endif
+
+static __always_inline int check_syn_proxy_allowed(struct iphdr* iph, struct ipv6hdr* iph6, u64 now, int refresh);
+static __always_inline void add_syn_proxy_allowed(struct iphdr* iph, struct ipv6hdr* iph6, u64 now);
+static __always_inline int do_syn_proxy(struct xdp_md* ctx, stats_t* stats, struct iphdr* iph, struct ipv6hdr* iph6, struct tcphdr* tcph);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "synproxy.c"
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <xdp/utils/tss.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_TSS)
+/**
+ * Probes the exact match table once for each field mask and retrieves the highest priority exact match rule.
+ *
+ * @param ctx A pointer to the rule context.
+ *
+ * @return A pointer to the matched exact match rule or NULL if no rule matched.
+ */
+static __always_inline filter_tss_val_t* lookup_tss(rule_ctx_t* ctx)
+{
+    u32 idx = 0;
+    filter_tss_masks_t* masks = bpf_map_lookup_elem(&map_filters_tss_masks, &idx);
+
+    if (!masks)
+    {
+        return NULL;
+    }
+
+    u8 protocol = 0;
+    u16 sport = 0;
+    u16 dport = 0;
+
+    if (ctx->tcph)
+    {
+        protocol = IPPROTO_TCP;
+        sport = ntohs(ctx->tcph->source);
+        dport = ntohs(ctx->tcph->dest);
+    }
+    else if (ctx->udph)
+    {
+        protocol = IPPROTO_UDP;
+        sport = ntohs(ctx->udph->source);
+        dport = ntohs(ctx->udph->dest);
+    }
+    else if (ctx->icmph || ctx->icmph6)
+    {
+        // ICMP rules match both ICMP and ICMPv6 packets.
+        protocol = IPPROTO_ICMP;
+    }
+
+    filter_tss_val_t* best = NULL;
+
+    for (int i = 0; i < FILTERS_TSS_MAX_MASKS; i++)
+    {
+        if (i >= masks->cnt)
+        {
+            break;
+        }
+
+        u32 mask = masks->masks[i];
+
+        filter_tss_key_t key = {0};
+        key.mask = mask;
+
+        if (mask & (FILTERS_TSS_SRC_IP | FILTERS_TSS_DST_IP))
+        {
+            if (!ctx->iph)
+            {
+                continue;
+            }
+
+            if (mask & FILTERS_TSS_SRC_IP)
+            {
+                key.src_ip[0] = ctx->iph->saddr;
+            }
+
+            if (mask & FILTERS_TSS_DST_IP)
+            {
+                key.dst_ip[0] = ctx->iph->daddr;
+            }
+        }
+
+        if (mask & (FILTERS_TSS_SRC_IP6 | FILTERS_TSS_DST_IP6))
+        {
+#ifdef ENABLE_IPV6
+            if (!ctx->iph6)
+            {
+                continue;
+            }
+
+            if (mask & FILTERS_TSS_SRC_IP6)
+            {
+                memcpy(key.src_ip, ctx->iph6->saddr.in6_u.u6_addr32, sizeof(key.src_ip));
+            }
+
+            if (mask & FILTERS_TSS_DST_IP6)
+            {
+                memcpy(key.dst_ip, ctx->iph6->daddr.in6_u.u6_addr32, sizeof(key.dst_ip));
+            }
+#else
+            continue;
+#endif
+        }
+
+        if (mask & FILTERS_TSS_PROTO)
+        {
+            if (!protocol)
+            {
+                continue;
+            }
+
+            key.protocol = protocol;
+        }
+
+        if (mask & FILTERS_TSS_SPORT)
+        {
+            key.sport = sport;
+        }
+
+        if (mask & FILTERS_TSS_DPORT)
+        {
+            key.dport = dport;
+        }
+
+        filter_tss_val_t* val = bpf_map_lookup_elem(&map_filters_tss, &key);
+
+        if (val && (!best || val->priority < best->priority))
+        {
+            best = val;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Stores a matched exact match rule inside of the rule context and logs the match if enabled.
+ *
+ * @param val A pointer to the exact match rule.
+ * @param ctx A pointer to the rule context.
+ *
+ * @return void
+ */
+static __always_inline void set_tss_matched(filter_tss_val_t* val, rule_ctx_t* ctx)
+{
+#ifdef ENABLE_FILTER_LOGGING
+    if (val->log > 0 && features.filter_logging)
+    {
+        log_filter_msg(ctx->iph, ctx->iph6, ctx->src_port, ctx->dst_port, ctx->protocol, ctx->now, ctx->ip_pps, ctx->ip_bps, ctx->flow_pps, ctx->flow_bps, ctx->pkt_len, val->id, val->sample_rate, val->sample_pps);
+    }
+#endif
+
+#ifdef ENABLE_FILTER_STATS
+    inc_filter_stats(val->id, ctx->pkt_len, ctx->now);
+#endif
+
+    ctx->matched = 1;
+    ctx->action = val->action;
+    ctx->block_time = val->block_time;
+
+#ifdef ENABLE_FILTERS_CACHE
+    // Rules with logging enabled can't be cached since every match is logged.
+    ctx->cache_deps = val->log ? MAX_FILTERS + 1 : val->filters_before;
+
+#ifdef ENABLE_FILTER_STATS
+    ctx->id = val->id;
+#endif
+#endif
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+#include <xdp/utils/rule.h>
+
+#include <xdp/utils/maps.h>
+
+#if defined(ENABLE_FILTERS) && defined(ENABLE_FILTERS_TSS)
+static __always_inline filter_tss_val_t* lookup_tss(rule_ctx_t* ctx);
+static __always_inline void set_tss_matched(filter_tss_val_t* val, rule_ctx_t* ctx);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "tss.c"
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include <xdp/utils/vlan.h>
+
+#ifdef ENABLE_VLAN
+/**
+ * Skips the packet's 802.1Q/802.1ad VLAN tags (up to VLAN_MAX_TAGS) and retrieves the outer VLAN ID.
+ * 
+ * @param eth A pointer to the ethernet header.
+ * @param data_end The end of the packet.
+ * @param l3 A pointer to store the start of the layer-3 header in.
+ * @param proto A pointer to store the layer-3 protocol in (network byte order).
+ * @param vlan_id A pointer to store the outer VLAN ID in (0 if the packet isn't tagged).
+ * 
+ * @return The amount of VLAN tags or -1 if a VLAN tag is out of bounds.
+ */
+static __always_inline int parse_vlan(struct ethhdr* eth, void* data_end, void** l3, u16* proto, u16* vlan_id)
+{
+    void* cur = eth + 1;
+
+    *proto = eth->h_proto;
+    *vlan_id = 0;
+
+    int tags = 0;
+
+#pragma unroll
+    for (int i = 0; i < VLAN_MAX_TAGS; i++)
+    {
+        if (*proto != htons(ETH_P_8021Q) && *proto != htons(ETH_P_8021AD))
+        {
+            break;
+        }
+
+        vlan_tag_t* tag = cur;
+
+        if (unlikely(tag + 1 > (vlan_tag_t*)data_end))
+        {
+            return -1;
+        }
+
+        if (i == 0)
+        {
+            *vlan_id = ntohs(tag->tci) & VLAN_VID_MASK;
+        }
+
+        *proto = tag->proto;
+
+        cur = tag + 1;
+        tags++;
+    }
+
+    *l3 = cur;
+
+    return tags;
+}
+#endif
+
+#ifdef ENABLE_VLAN_STATS
+/**
+ * Increments a VLAN's packet and byte counters or its drop counter.
+ * 
+ * @param vlan_id The VLAN ID.
+ * @param pkt_len The packet length.
+ * @param dropped Whether to increment the drop counter instead of the packet and byte counters.
+ * 
+ * @return void
+ */
+static __always_inline void inc_vlan_stats(u16 vlan_id, u16 pkt_len, int dropped)
+{
+    u32 key = vlan_id & VLAN_VID_MASK;
+
+    vlan_stats_t* stats = bpf_map_lookup_elem(&map_vlan_stats, &key);
+
+    if (!stats)
+    {
+        return;
+    }
+
+    // The map is per-CPU, so we don't need atomic operations.
+    if (dropped)
+    {
+        stats->dropped++;
+
+        return;
+    }
+
+    stats->packets++;
+    stats->bytes += pkt_len;
+}
+#endif
\ No newline at end of file
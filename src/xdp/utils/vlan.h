@@ -0,0 +1,28 @@
+#pragma once
+
+#include <common/all.h>
+
+#include <xdp/utils/helpers.h>
+
+#include <xdp/utils/maps.h>
+
+#include <linux/if_ether.h>
+
+struct vlan_tag
+{
+    u16 tci;
+    u16 proto;
+} typedef vlan_tag_t;
+
+#ifdef ENABLE_VLAN
+static __always_inline int parse_vlan(struct ethhdr* eth, void* data_end, void** l3, u16* proto, u16* vlan_id);
+#endif
+
+#ifdef ENABLE_VLAN_STATS
+static __always_inline void inc_vlan_stats(u16 vlan_id, u16 pkt_len, int dropped);
+#endif
+
+// The source file is included directly below instead of compiled and linked as an object because when linking, there is no guarantee the compiler will inline the function (which is crucial for performance).
+// I'd prefer not to include the function logic inside of the header file.
+// More Info: https://stackoverflow.com/questions/24289599/always-inline-does-not-work-when-function-is-implemented-in-different-file
+#include "vlan.c"
\ No newline at end of file